@@ -27,6 +27,7 @@ public:
     void ReinitializeAddons(ADDON_PROCESS);
     void PreprocessAddons(ADDON_PROCESS);
     void ProcessAddons(ADDON_PROCESS);
+    bool NeedsContinuousLoop(ADDON_PROCESS);
     GPAddon * GetAddon(std::string); // hack for NeoPicoLED
 private:
     std::vector<AddonBlock*> addons;    // addons currently loaded
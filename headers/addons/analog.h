@@ -70,6 +70,7 @@ public:
 	virtual void setup();       // Analog Setup
 	virtual void process();     // Analog Process
 	virtual void preprocess() {}
+	virtual bool needsContinuousLoop() { return true; } // ADC sampling
     virtual std::string name() { return AnalogName; }
 private:
 	uint16_t adc_1_x_center = 0;
@@ -4,6 +4,9 @@
 #include "gpaddon.h"
 #include "gamepad.h"
 
+#include <atomic>
+#include "pico/time.h"
+
 #ifndef BOOTSEL_BUTTON_ENABLED
 #define BOOTSEL_BUTTON_ENABLED 0
 #endif
@@ -12,6 +15,16 @@
 #define BOOTSEL_BUTTON_MASK 0 // 0 means none, get other mask from GamepadState.h
 #endif
 
+// How often BOOTSEL is sampled, every sample stalls flash access for both cores
+#ifndef BOOTSEL_SAMPLE_INTERVAL_US
+#define BOOTSEL_SAMPLE_INTERVAL_US 1000
+#endif
+
+// Longest wait for core1 to park itself in RAM before a sample is skipped
+#ifndef BOOTSEL_LOCKOUT_TIMEOUT_US
+#define BOOTSEL_LOCKOUT_TIMEOUT_US 100
+#endif
+
 // BootselButton Module Name
 #define BootselButtonName "BootselButton"
 
@@ -23,8 +36,10 @@ public:
 	virtual void preprocess();
 	virtual std::string name() { return BootselButtonName; }
 private:	
+	static int64_t sampleAlarm(alarm_id_t id, void * user);
 	bool isBootselPressed();
 	uint32_t bootselButtonMap;
+	std::atomic<bool> bootselPressed;   // last sample, written by the sample alarm
 };
 
-#endif  // _BootselButton_H_
\ No newline at end of file
+#endif  // _BootselButton_H_
@@ -0,0 +1,33 @@
+#ifndef _GamepadUSBHost_H
+#define _GamepadUSBHost_H
+
+#include "gpaddon.h"
+
+#ifndef GAMEPAD_USB_HOST_ENABLED
+#define GAMEPAD_USB_HOST_ENABLED 0
+#endif
+
+// How controllers on a hub are combined, see USBHostSlots::merge()
+#ifndef GAMEPAD_USB_HOST_MERGE_MODE
+#define GAMEPAD_USB_HOST_MERGE_MODE HOST_MERGE_OR
+#endif
+
+// Slot passed through in HOST_MERGE_PLAYER, devices take the lowest free slot when they mount
+#ifndef GAMEPAD_USB_HOST_PLAYER_SLOT
+#define GAMEPAD_USB_HOST_PLAYER_SLOT 0
+#endif
+
+// GamepadUSBHost Module Name
+#define GamepadUSBHostName "GamepadUSBHost"
+
+class GamepadUSBHostAddon : public GPAddon {
+public:
+	virtual bool available();
+	virtual void setup();       // GamepadUSBHost Setup
+	virtual void process() {}   // GamepadUSBHost Process
+	virtual void preprocess();
+	virtual std::string name() { return GamepadUSBHostName; }
+private:
+};
+
+#endif  // _GamepadUSBHost_H_
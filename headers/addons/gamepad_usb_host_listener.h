@@ -0,0 +1,33 @@
+#ifndef _GamepadUSBHostListener_H
+#define _GamepadUSBHostListener_H
+
+#include "usblistener.h"
+#include "gamepad.h"
+#include "usbhostslots.h"
+#include "drivers/shared/reportdecoder.h"
+
+//
+// Generic HID controllers on the host port, up to USB_HOST_MAX_DEVICES through
+// a hub. The report descriptor is compiled into a ReportDecoder plan per slot
+// at mount, every report after that is decoded along its plan and the slots
+// are merged into the gamepad state on core0.
+//
+class GamepadUSBHostListener : public USBListener {
+public:// USB Listener Features
+	virtual void setup();
+	virtual void mount(uint8_t dev_addr, uint8_t instance, uint8_t const* desc_report, uint16_t desc_len);
+	virtual void xmount(uint8_t dev_addr, uint8_t instance, uint8_t controllerType, uint8_t subtype) {}
+	virtual void unmount(uint8_t dev_addr);
+	virtual void report_received(uint8_t dev_addr, uint8_t instance, uint8_t const* report, uint16_t len);
+	virtual void report_sent(uint8_t dev_addr, uint8_t instance, uint8_t const* report, uint16_t len) {}
+	virtual void set_report_complete(uint8_t dev_addr, uint8_t instance, uint8_t report_id, uint8_t report_type, uint16_t len) {}
+	virtual void get_report_complete(uint8_t dev_addr, uint8_t instance, uint8_t report_id, uint8_t report_type, uint16_t len) {}
+	void process();
+private:
+	ReportDecoder _gamepad_host_decoders[USB_HOST_MAX_DEVICES];
+	USBHostSlots _gamepad_host_slots; // last decoded report per device for process(), which can be on the other core
+	HostMergeMode _gamepad_host_merge_mode;
+	uint8_t _gamepad_host_player_slot;
+};
+
+#endif  // _GamepadUSBHostListener_H_
@@ -5,6 +5,9 @@
 
 #include "GamepadEnums.h"
 
+#include <atomic>
+#include "pico/time.h"
+
 #ifndef INPUT_MACRO_ENABLED
 #define INPUT_MACRO_ENABLED 0
 #endif
@@ -32,6 +35,26 @@
 // Input Macro Module Name
 #define InputMacroName "Input Macro"
 
+// One compiled macro input: hold output for holdUs, then nothing for waitUs
+struct MacroStep {
+	uint32_t output;            // buttons in the low 16 bits, dpad (GAMEPAD_MASK_UP...) from bit 16
+	uint32_t holdUs;            // 0 = output is pressed for one pass only, then the wait
+	uint32_t waitUs;
+};
+
+// A macro the way the step interpreter runs it, built from MacroOptions by compileMacros()
+struct CompiledMacro {
+	MacroType type;
+	uint32_t triggerPins;       // GPIO that start it, the shared macro pin for button triggers, 0 = disabled
+	uint16_t triggerButtons;    // with useTriggerButton: buttons that pick this macro
+	uint8_t triggerDpad;        // with useTriggerButton: dpad directions that pick this macro
+	bool useTriggerButton;
+	bool exclusive;             // clears all other input while running (exclusive and not interruptible)
+	bool interruptible;
+	uint8_t firstStep;          // into InputMacro::macroSteps
+	uint8_t stepCount;
+};
+
 class InputMacro : public GPAddon {
 public:
 	virtual bool available();   // GPAddon available
@@ -41,21 +64,28 @@ public:
     virtual void reinit();
     virtual std::string name() { return InputMacroName; }
 private:
+	static int64_t stepAlarm(alarm_id_t id, void * user);
+	void compileMacros();
 	void checkMacroPress();
 	void checkMacroAction();
 	void runCurrentMacro();
 	void reset();
-	void restart(Macro& macro);
+	void start();
+	uint32_t startInput();
+	uint32_t nextStep();
 	bool isMacroRunning;
 	bool isMacroTriggerHeld;
 	int macroPosition;
-	uint32_t macroButtonMask;
-	uint32_t macroPinMasks[6];
-	uint64_t macroStartTime;
-	uint64_t currentMicros;
 	int pressedMacro;
-	int macroInputPosition;
-	uint32_t macroInputHoldTime;
+	CompiledMacro macros[MAX_MACRO_LIMIT];
+	MacroStep macroSteps[MAX_MACRO_LIMIT * MAX_MACRO_INPUT_LIMIT];
+	uint32_t triggerPinMask;            // every pin that can start a macro
+	uint8_t macroStep;                  // running input, into macroSteps
+	bool isInputWaiting;                // past the hold of the running input
+	std::atomic<uint32_t> macroOverlay; // output of the running input, set by the step alarm
+	std::atomic<uint32_t> macroTap;     // output of inputs without a duration, taken by the next preprocess()
+	std::atomic<bool> isMacroFinished;  // ON_PRESS macro ran its last input
+	alarm_id_t stepAlarmId;
 	bool prevMacroInputPressed;
 	bool boardLedEnabled;
 	MacroOptions * inputMacroOptions;
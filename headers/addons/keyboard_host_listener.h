@@ -3,6 +3,7 @@
 
 #include "usblistener.h"
 #include "gamepad.h"
+#include "usbhostslots.h"
 #include "class/hid/hid.h"
 
 struct KeyboardButtonMapping
@@ -35,10 +36,9 @@ public:// USB Listener Features
 	virtual void get_report_complete(uint8_t dev_addr, uint8_t instance, uint8_t report_id, uint8_t report_type, uint16_t len) {}
 	void process();
 private:
-	GamepadState _keyboard_host_state;
-	bool _keyboard_host_enabled;
+	USBHostSlots _keyboard_host_slots; // state per keyboard for process(), which can be on the other core
 	uint8_t getKeycodeFromModifier(uint8_t modifier);
-	void process_kbd_report(uint8_t dev_addr, hid_keyboard_report_t const *report);
+	void process_kbd_report(int8_t slot, hid_keyboard_report_t const *report);
 	
 	KeyboardButtonMapping _keyboard_host_mapDpadUp;
 	KeyboardButtonMapping _keyboard_host_mapDpadDown;
@@ -177,6 +177,7 @@ public:
 	virtual void setup();
 	virtual void preprocess() {}
 	virtual void process();
+	virtual bool needsContinuousLoop() { return true; } // animations
 	virtual std::string name() { return NeoPicoLEDName; }
 	void configureLEDs();
 	uint32_t frame[100];
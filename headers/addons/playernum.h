@@ -7,6 +7,8 @@
 
 #include "BoardConfig.h"
 
+#include "pico/time.h"
+
 #ifndef PLAYERNUM_ADDON_ENABLED
 #define PLAYERNUM_ADDON_ENABLED 0
 #endif
@@ -15,9 +17,30 @@
 #define PLAYER_NUMBER 1
 #endif
 
+// Time off the bus before reconnecting to ask for another slot
+#ifndef PLAYERNUM_DISCONNECT_MS
+#define PLAYERNUM_DISCONNECT_MS 100
+#endif
+
+// Reconnects are staggered by this per player number, longer than the host takes to hand out a slot
+#ifndef PLAYERNUM_RECONNECT_MS
+#define PLAYERNUM_RECONNECT_MS 1000
+#endif
+
+// Keep whatever slot the host gives after this many reconnects (e.g. no lower player is plugged in)
+#ifndef PLAYERNUM_MAX_ATTEMPTS
+#define PLAYERNUM_MAX_ATTEMPTS 8
+#endif
+
 // Analog Module Name
 #define PlayerNumName "PlayerNum"
 
+typedef enum {
+	PLAYERNUM_WAITING,          // connected, waiting for the host to set the player LEDs
+	PLAYERNUM_DISCONNECTED,     // off the bus until reconnectTime
+	PLAYERNUM_ASSIGNED,
+} PlayerNumState;
+
 class PlayerNumAddon : public GPAddon {
 public:
 	virtual bool available();
@@ -27,7 +50,9 @@ public:
     virtual std::string name() { return PlayerNumName; }
 private:
 	void handleLED(int);
-	uint8_t assigned;
+	PlayerNumState state;
+	uint8_t attempts;           // reconnects so far
+	absolute_time_t reconnectTime;
 	uint8_t playerNum;
 	uint8_t xinputIDs[4];
 };
@@ -87,6 +87,7 @@ public:
 	virtual void setup();       // Rotary Setup
     virtual void preprocess() {}
 	virtual void process();     // Rotary process
+    virtual bool needsContinuousLoop() { return true; } // quadrature is polled
     virtual std::string name() { return RotaryEncoderName; }
 
     typedef struct {
@@ -5,6 +5,9 @@
 #include "storagemanager.h"
 #include "enums.pb.h"
 
+#include <atomic>
+#include "pico/time.h"
+
 #ifndef TURBO_ENABLED
 #define TURBO_ENABLED 0
 #endif
@@ -95,6 +98,7 @@ public:
     virtual void process();     // TURBO Setting of buttons (Enable/Disable)
     virtual std::string name() { return TurboName; }
 private:
+    static int64_t flickerAlarm(alarm_id_t id, void * user);
     void updateInterval(uint8_t shotCount);
     void updateTurboShotCount(uint8_t turboShotCount);
     Mask_t turboPinMask;        // Pin mask for Turbo pin
@@ -106,10 +110,10 @@ private:
     uint8_t lastDpad;           // Last d-pad pressed (for Turbo Change)
     uint16_t turboButtonsMask;  // Turbo Buttons Enabled
     uint16_t alwaysEnabled;     // Turbo SHMUP Always Enabled
-    uint32_t uIntervalUS;       // Turbo Interval in microseconds
+    std::atomic<uint32_t> uIntervalUS;  // Turbo Interval in microseconds
     uint32_t chargeState;       // Turbo Charge Button States
-    bool bTurboFlicker;         // Turbo Enable Buttons Toggle OFF Flag ??
-    uint64_t nextTimer;         // Turbo Timer
+    std::atomic<bool> bTurboFlicker;    // Turbo buttons released, toggled by the flicker alarm
+    alarm_id_t flickerAlarmId;  // Turbo Timer
     uint8_t adcShmupDial;       // Turbo ADC Dial Input
     uint64_t nextAdcRead;       // ADC read timer
     bool hasShmupDial;          // Flag for shmup dial presence
@@ -10,8 +10,14 @@ namespace ConfigUtils {
     
     void initUnsetPropertiesWithDefaults(Config& config);
 
-    std::string toJSON(const Config& config);
+    // Streams the JSON export: fills `buffer` with up to `bufferSize` bytes starting at `offset` of the
+    // document and returns how many were written. Without a buffer the total document length is returned.
+    size_t toJSON(const Config& config, char* buffer, size_t bufferSize, size_t offset);
     bool fromJSON(Config& config, const char* data, size_t dataLen);
+
+    // Binary backup: the protobuf encoding followed by the footer used in flash, streamed the same way as toJSON
+    size_t toBinary(const Config& config, uint8_t* buffer, size_t bufferSize, size_t offset);
+    bool fromBinary(Config& config, const uint8_t* data, size_t dataLen);
     bool fromLegacyStorage(Config& config);
 }
 
@@ -20,7 +20,7 @@ private:
     ConfigManager() {}
     void setupConfig(GPConfig*);
     ConfigType cType;
-    GPConfig * config;
+    GPConfig * config = nullptr;
 };
 
 #endif
\ No newline at end of file
@@ -30,19 +30,66 @@
 
 class Base64 {
  public:
+  static constexpr char sEncodingTable[] = {
+    'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H',
+    'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P',
+    'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X',
+    'Y', 'Z', 'a', 'b', 'c', 'd', 'e', 'f',
+    'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n',
+    'o', 'p', 'q', 'r', 's', 't', 'u', 'v',
+    'w', 'x', 'y', 'z', '0', '1', '2', '3',
+    '4', '5', '6', '7', '8', '9', '+', '/'
+  };
+
+  static constexpr unsigned char kDecodingTable[] = {
+    64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
+    64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
+    64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 62, 64, 64, 64, 63,
+    52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 64, 64, 64, 64, 64, 64,
+    64,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 64, 64, 64, 64, 64,
+    64, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 64, 64, 64, 64, 64,
+    64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
+    64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
+    64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
+    64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
+    64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
+    64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
+    64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
+    64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64
+  };
+
+  // Encodes one group of up to 3 bytes into 4 characters (padded), same output as Encode() group by group
+  static void EncodeBlock(const char* dataPtr, size_t dataLen, char* out) {
+    out[0] = sEncodingTable[(dataPtr[0] >> 2) & 0x3F];
+    if (dataLen >= 3) {
+      out[1] = sEncodingTable[((dataPtr[0] & 0x3) << 4) | ((int) (dataPtr[1] & 0xF0) >> 4)];
+      out[2] = sEncodingTable[((dataPtr[1] & 0xF) << 2) | ((int) (dataPtr[2] & 0xC0) >> 6)];
+      out[3] = sEncodingTable[dataPtr[2] & 0x3F];
+    } else if (dataLen == 2) {
+      out[1] = sEncodingTable[((dataPtr[0] & 0x3) << 4) | ((int) (dataPtr[1] & 0xF0) >> 4)];
+      out[2] = sEncodingTable[((dataPtr[1] & 0xF) << 2)];
+      out[3] = '=';
+    } else {
+      out[1] = sEncodingTable[((dataPtr[0] & 0x3) << 4)];
+      out[2] = '=';
+      out[3] = '=';
+    }
+  }
 
-  static std::string Encode(const char* dataPtr, size_t dataLen) {
-    static constexpr char sEncodingTable[] = {
-      'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H',
-      'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P',
-      'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X',
-      'Y', 'Z', 'a', 'b', 'c', 'd', 'e', 'f',
-      'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n',
-      'o', 'p', 'q', 'r', 's', 't', 'u', 'v',
-      'w', 'x', 'y', 'z', '0', '1', '2', '3',
-      '4', '5', '6', '7', '8', '9', '+', '/'
-    };
+  // Decodes one group of 4 characters into 3 bytes, padding decodes as zero like Decode()
+  static void DecodeBlock(const char* dataPtr, uint8_t* out) {
+    uint32_t triple = 0;
+    for (size_t i = 0; i < 4; i++) {
+      triple = (triple << 6) + (dataPtr[i] == '=' ? 0 : kDecodingTable[static_cast<unsigned char>(dataPtr[i])]);
+    }
+    out[0] = (triple >> 2 * 8) & 0xFF;
+    out[1] = (triple >> 1 * 8) & 0xFF;
+    out[2] = (triple >> 0 * 8) & 0xFF;
+  }
 
+  static std::string Encode(const char* dataPtr, size_t dataLen) {
     size_t out_len = 4 * ((dataLen + 2) / 3);
     std::string ret;
     ret.resize(out_len);
@@ -80,25 +127,6 @@ class Base64 {
   }
 
   static bool Decode(const char* dataPtr, size_t dataLen, std::string& out) {
-    static constexpr unsigned char kDecodingTable[] = {
-      64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
-      64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
-      64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 62, 64, 64, 64, 63,
-      52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 64, 64, 64, 64, 64, 64,
-      64,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
-      15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 64, 64, 64, 64, 64,
-      64, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
-      41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 64, 64, 64, 64, 64,
-      64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
-      64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
-      64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
-      64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
-      64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
-      64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
-      64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
-      64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64
-    };
-
     if (dataLen % 4 != 0)
     {
       out.clear();
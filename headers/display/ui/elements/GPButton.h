@@ -6,8 +6,24 @@
 
 #define GP_BUTTON_TURBO_SCALE 0.70
 
+// Screen geometry of a button, resolved from the viewport once by prepare()
+typedef struct {
+    uint16_t x;
+    uint16_t y;
+    uint16_t radius;        // ellipse, polygon and arc
+    uint16_t turboRadius;
+    uint16_t right;         // square: far corner
+    uint16_t bottom;
+    uint16_t turboX;        // square: turbo indicator
+    uint16_t turboY;
+    uint16_t turboRight;
+    uint16_t turboBottom;
+} GPButtonGeometry;
+
 class GPButton : public GPWidget {
     public:
+        // Resolve scale, position and pin mapping, call once the button is fully set up
+        void prepare();
         void draw();
         GPButton* setSize(uint16_t sizeX, uint16_t sizeY) { this->_sizeX = sizeX; this->_sizeY = sizeY; return this; }
         GPButton* setInputMask(int16_t inputMask) { this->_inputMask = inputMask; return this; }
@@ -27,6 +43,9 @@ class GPButton : public GPWidget {
         bool _inputDirection = false;
         GPElement _inputType = GP_ELEMENT_BTN_BUTTON;
         GPShape_Type _shape = GP_SHAPE_ELLIPSE;
+
+        GPButtonGeometry _geometry = {};
+        GamepadButtonMapping* Gamepad::* _mapping = nullptr; // member, the mappings are reallocated on reinit
 };
 
 #endif
\ No newline at end of file
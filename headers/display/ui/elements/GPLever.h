@@ -3,8 +3,34 @@
 
 #include "GPWidget.h"
 
+// Analog positions the lever can show, map() of a stick axis gives 0 to 100
+#define GP_LEVER_ANALOG_STEPS 101
+
+typedef struct {
+    uint16_t x1;
+    uint16_t y1;
+    uint16_t x2;
+    uint16_t y2;
+} GPLeverTick;
+
+// Screen geometry of a lever, resolved from the viewport once by prepare()
+typedef struct {
+    uint16_t x;
+    uint16_t y;
+    uint16_t radius;
+    uint16_t leverRadius;
+    uint16_t minX;                      // analog travel box
+    uint16_t minY;
+    uint8_t travelX[GP_LEVER_ANALOG_STEPS];  // lever offset from minX/minY for each analog step
+    uint8_t travelY[GP_LEVER_ANALOG_STEPS];
+    GPLeverTick cardinal[4];
+    GPLeverTick ordinal[4];
+} GPLeverGeometry;
+
 class GPLever : public GPWidget {
     public:
+        // Resolve scale, position and the direction ticks, call once the lever is fully set up
+        void prepare();
         void draw();
         void setRadius(uint16_t radius) { this->_radius = radius; }
         void setInputType(uint16_t inputType) { this->_inputType = inputType; }
@@ -21,6 +47,8 @@ class GPLever : public GPWidget {
         int32_t _downMask = -1;
         int32_t _leftMask = -1;
         int32_t _rightMask = -1;
+
+        GPLeverGeometry _geometry = {};
 };
 
 #endif
\ No newline at end of file
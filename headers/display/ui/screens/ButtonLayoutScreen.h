@@ -39,6 +39,9 @@
 
 #define INPUT_HISTORY_MAX_INPUTS 22
 #define INPUT_HISTORY_MAX_MODES 11
+#define INPUT_HISTORY_MAX_CHARS 32
+
+#define HEADER_MAX_CHARS 32
 
 // Static to ensure memory is never doubled
 static const char * displayNames[INPUT_HISTORY_MAX_MODES][INPUT_HISTORY_MAX_INPUTS] = {
@@ -138,6 +141,8 @@ class ButtonLayoutScreen : public GPScreen {
         GPShape* addShape(uint16_t startX, uint16_t startY, uint16_t sizeX, uint16_t sizeY, uint16_t strokeColor, uint16_t fillColor);
         GPWidget* pushElement(GPButtonLayout element);
         void generateHeader();
+        void appendHeader(char* header, size_t& length, const char* text);
+        void appendHeader(char* header, size_t& length, uint32_t number, uint8_t minDigits = 1);
 
         const std::map<uint16_t, uint16_t> displayModeLookup = {
             {INPUT_MODE_HID, 0},
@@ -165,8 +170,9 @@ class ButtonLayoutScreen : public GPScreen {
         uint16_t inputHistoryX = 0;
         uint16_t inputHistoryY = 0;
         size_t inputHistoryLength = 0;
-        std::string historyString;
-        std::deque<std::string> inputHistory;
+        char inputHistory[INPUT_HISTORY_MAX_CHARS];
+        size_t inputHistoryHead = 0;
+        size_t inputHistoryCount = 0;
         std::array<bool, INPUT_HISTORY_MAX_INPUTS> lastInput;
 
         bool profileModeDisplay;
@@ -183,6 +189,7 @@ class ButtonLayoutScreen : public GPScreen {
 
         uint16_t map(uint16_t x, uint16_t in_min, uint16_t in_max, uint16_t out_min, uint16_t out_max);
         void processInputHistory();
+        void pushInputHistory(const char* text);
         bool compareCustomLayouts();
         bool pressedUp();
         bool pressedDown();
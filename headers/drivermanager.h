@@ -1,6 +1,8 @@
 #ifndef _DRIVERMANAGER_H
 #define _DRIVERMANAGER_H
 
+#include <atomic>
+
 #include "enums.pb.h"
 #include "gpdriver.h"
 
@@ -16,11 +18,25 @@ public:
     }
     GPDriver * getDriver() { return driver; }
     void setup(InputMode);
+    bool switchMode(InputMode);         // replace the running driver and re-enumerate, no reboot
     InputMode getInputMode(){ return inputMode; }
+    uint32_t getGeneration() { return generation.load(); } // bumped by every switchMode
+
+    // core1 brackets its driver work with these so switchMode never replaces the driver under it, and reports
+    // the generation it has run initializeAux() for
+    bool enterAux();
+    void exitAux() { auxBusy.store(false); }
+    void ackAux(uint32_t gen) { auxGeneration.store(gen); }
 private:
     DriverManager() {}
-    GPDriver * driver;
+    bool createDriver(InputMode);
+    void destroyDriver();
+    GPDriver * driver = nullptr;
     InputMode inputMode;
+    std::atomic<bool> swapping {false};
+    std::atomic<bool> auxBusy {false};
+    std::atomic<uint32_t> generation {1};
+    std::atomic<uint32_t> auxGeneration {0};
 };
 
 #endif
\ No newline at end of file
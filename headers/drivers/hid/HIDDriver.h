@@ -28,6 +28,7 @@ public:
 private:
     uint8_t last_report[CFG_TUD_ENDPOINT0_SIZE] = { };
     HIDReport hidReport;
+    GamepadState lastState;
 };
 
 #endif // _HID_DRIVER_H_
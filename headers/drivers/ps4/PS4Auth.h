@@ -3,12 +3,19 @@
 
 #include "drivers/shared/gpauthdriver.h"
 #include "drivers/ps4/PS4Driver.h"
+#include "drivers/ps4/PS4AuthSigner.h"
 #include "usblistener.h"
 #include "mbedtls/rsa.h"
 
+// Time budget for each slice of the key signature on core1
+#ifndef PS4_KEYS_SLICE_US
+#define PS4_KEYS_SLICE_US 500
+#endif
+
 class PS4Auth : public GPAuthDriver {
 public:
-    PS4Auth(InputModeAuthType inType) { authType = inType; }
+    PS4Auth(InputModeAuthType inType) { authType = inType; mbedtls_rsa_init(&rsa_context, MBEDTLS_RSA_PKCS_V21, MBEDTLS_MD_SHA256); }
+    virtual ~PS4Auth() { mbedtls_rsa_free(&rsa_context); }
     virtual void initialize();
     virtual bool available();
     void process(PS4State, uint8_t, uint8_t*);
@@ -16,8 +23,14 @@ public:
     bool getAuthReady();
     void resetAuth();
 private:
+    bool setupSigner();
+    void finishAuthBuffer();
+
     struct mbedtls_rsa_context rsa_context;
     bool valid_rsa;
+    PS4AuthSigner signer;
+    bool valid_signer;
+    volatile bool signer_reset; // set on core0, consumed on core1
 
     // buffer = 256 + 16 + 256 + 256 + 256 + 24
     // == 1064 bytes (almost 1 kb)
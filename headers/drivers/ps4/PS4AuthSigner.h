@@ -0,0 +1,93 @@
+#ifndef _PS4AUTHSIGNER_H_
+#define _PS4AUTHSIGNER_H_
+
+#include <stdint.h>
+
+// PS4 keys are RSA-2048, so each CRT prime is 1024 bits (32 x 32-bit limbs)
+#define PS4_RSA_SIGNATURE_SIZE 256
+#define PS4_RSA_PRIME_SIZE 128
+#define PS4_RSA_PRIME_LIMBS (PS4_RSA_PRIME_SIZE / sizeof(uint32_t))
+
+typedef enum {
+    signer_idle,
+    signer_exp_p,
+    signer_exp_q,
+    signer_combine,
+    signer_done
+} PS4SignerState;
+
+typedef enum {
+    phase_reduce,       // high half of the message times R^2
+    phase_base,         // message mod p into Montgomery form
+    phase_one,          // accumulator starts at R mod p
+    phase_square,
+    phase_multiply,
+    phase_result,       // accumulator out of Montgomery form
+    phase_prime_done,
+    phase_diff,         // h = qInv * (m1 - m2) mod p
+    phase_product,      // h * q, one limb row per step
+    phase_add           // s = m2 + h * q
+} PS4SignerPhase;
+
+typedef struct {
+    uint32_t mod[PS4_RSA_PRIME_LIMBS];  // p or q
+    uint32_t rr[PS4_RSA_PRIME_LIMBS];   // R^2 mod p, converts into Montgomery form
+    uint32_t exp[PS4_RSA_PRIME_LIMBS];  // dP or dQ
+    uint32_t n0inv;                     // -p^-1 mod 2^32
+    uint16_t expBits;
+} ps4_rsa_prime_t;
+
+//
+// Resumable RSASSA-PSS (SHA-256) signer for the PS4 key auth.
+// The private key operation is split into single limb passes of the
+// Montgomery multiplications so core1 can sign the nonce across many
+// processAux() calls instead of blocking for the whole exponentiation.
+//
+class PS4AuthSigner {
+public:
+    // Big-endian 128-byte CRT parameters, precomputes the Montgomery constants
+    bool setKey(const uint8_t * p, const uint8_t * q, const uint8_t * dp, const uint8_t * dq, const uint8_t * qp);
+    bool start(const uint8_t * hash);   // 32-byte SHA-256 of the message
+    bool startRaw(const uint8_t * message); // 256-byte message below N, private key operation only
+    bool step();                        // one limb pass, returns true once the signature is ready
+    void reset() { state = PS4SignerState::signer_idle; mulPending = false; }
+    void getSignature(uint8_t * signature);
+    PS4SignerState getState() { return state; }
+private:
+    void encodePSS(const uint8_t * hash, uint8_t * em);
+    bool stepPrime(ps4_rsa_prime_t * prime, uint32_t * result);
+    bool stepCombine();
+    void startMul(uint32_t * r, const uint32_t * a, const uint32_t * b, const ps4_rsa_prime_t * prime);
+    void stepMul();
+
+    ps4_rsa_prime_t primeP;
+    ps4_rsa_prime_t primeQ;
+    uint32_t qInvR[PS4_RSA_PRIME_LIMBS]; // qInv in Montgomery form mod p
+    uint32_t em[PS4_RSA_PRIME_LIMBS * 2];
+    uint8_t emTopMask;                   // clears the encoded message bits above N
+    uint32_t high[PS4_RSA_PRIME_LIMBS];
+    uint32_t low[PS4_RSA_PRIME_LIMBS];
+    uint32_t base[PS4_RSA_PRIME_LIMBS];
+    uint32_t acc[PS4_RSA_PRIME_LIMBS];
+    uint32_t m1[PS4_RSA_PRIME_LIMBS];
+    uint32_t m2[PS4_RSA_PRIME_LIMBS];
+    uint32_t diff[PS4_RSA_PRIME_LIMBS];
+    uint32_t signature[PS4_RSA_PRIME_LIMBS * 2];
+    int16_t bitIndex;
+    uint8_t productRow;
+    PS4SignerPhase phase;
+
+    // Montgomery multiplication in progress, r is only written once every row is done
+    uint32_t mulT[PS4_RSA_PRIME_LIMBS + 2];
+    uint32_t * mulR;
+    const uint32_t * mulA;
+    const uint32_t * mulB;
+    const ps4_rsa_prime_t * mulPrime;
+    uint8_t mulRow;
+    bool mulPending = false;
+
+    bool keyValid = false;
+    PS4SignerState state = PS4SignerState::signer_idle;
+};
+
+#endif
@@ -42,6 +42,7 @@ typedef enum
 class PS4Driver : public GPDriver {
 public:
     PS4Driver(uint32_t type): controllerType(type) {}
+    virtual ~PS4Driver();
     virtual void initialize();
     virtual void process(Gamepad * gamepad, uint8_t * outBuffer);
     virtual void initializeAux();
@@ -66,11 +67,12 @@ private:
     uint16_t last_axis_counter;
     uint8_t cur_nonce_id;
     PS4Report ps4Report;
+    GamepadState lastState;
     TouchpadData touchpadData;
     uint32_t last_report_timer;
     uint8_t send_nonce_part;
     uint32_t controllerType;
-    GPAuthDriver * authDriver;
+    GPAuthDriver * authDriver = nullptr;
 
     PS4State ps4State;
     bool authsent;
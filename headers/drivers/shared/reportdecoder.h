@@ -0,0 +1,82 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+#ifndef _REPORT_DECODER_H_
+#define _REPORT_DECODER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "gamepad/GamepadState.h"
+
+// Fields one plan can hold, a run of up to 24 buttons counts as one
+#ifndef REPORT_DECODER_MAX_FIELDS
+#define REPORT_DECODER_MAX_FIELDS 16
+#endif
+
+//
+// HID input report -> GamepadState, the other direction of ReportEncoder.
+// The report descriptor is parsed once, at mount, into a plan: for every
+// button run, axis and hat of the gamepad collection, where its bits are
+// and how to scale them. Decoding a report is then one pass over the plan
+// with a fixed bit extract per field, the descriptor is never looked at again.
+//
+// Buttons are taken in DirectInput order (the order of our own HID mode), so
+// a DS4, a Switch wired pad or an arcade encoder lands on the same buttons.
+//
+
+typedef enum : uint8_t {
+    REPORT_FIELD_BUTTONS,   // run of 1-bit buttons, target is the first button index
+    REPORT_FIELD_HAT,       // 8 or 4-way hat switch into the dpad
+    REPORT_FIELD_AXIS,      // target is a ReportAxis
+} ReportFieldType;
+
+typedef enum : uint8_t {
+    REPORT_AXIS_LX,
+    REPORT_AXIS_LY,
+    REPORT_AXIS_RX,
+    REPORT_AXIS_RY,
+    REPORT_AXIS_LT,
+    REPORT_AXIS_RT,
+    REPORT_AXIS_NONE,
+} ReportAxis;
+
+typedef struct {
+    ReportFieldType type;
+    uint8_t target;
+    uint8_t count;          // buttons in the run, or the hat step (1 for 8-way, 2 for 4-way)
+    uint8_t bytes;          // bytes the field touches, 1 to 4
+    uint16_t byteOffset;    // first byte, after the report ID
+    uint8_t shift;          // bit of the field in that byte
+    uint8_t signBits;       // 32 - size for a signed field, 0 if unsigned
+    uint32_t mask;          // (1 << size) - 1
+    int32_t min;            // logical minimum
+    uint32_t range;         // logical maximum - minimum
+    uint32_t scale;         // axis: output maximum * 65536 / range
+} ReportField;
+
+class ReportDecoder {
+public:
+    ReportDecoder() : reportId(0), reportBytes(0), fieldCount(0) {}
+
+    // Build the plan from a report descriptor, false if it has no usable gamepad fields
+    bool compile(const uint8_t * desc, uint16_t len);
+
+    // Decode one input report (starting with its report ID if the device uses them).
+    // false, leaving state alone, if the report is not the one the plan was built for.
+    bool decode(const uint8_t * report, uint16_t len, GamepadState & state) const;
+
+    uint8_t getReportId() const { return reportId; }
+    uint16_t getReportBytes() const { return reportBytes; }
+    uint8_t getFieldCount() const { return fieldCount; }
+    const ReportField * getFields() const { return fields; }
+private:
+    uint8_t reportId;       // 0 if the device does not number its reports
+    uint16_t reportBytes;   // payload size of that report, without the ID
+    uint8_t fieldCount;
+    ReportField fields[REPORT_DECODER_MAX_FIELDS];
+};
+
+#endif // _REPORT_DECODER_H_
@@ -0,0 +1,117 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+#ifndef _REPORT_ENCODER_H_
+#define _REPORT_ENCODER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "gamepad/GamepadState.h"
+
+//
+// Declarative gamepad -> report mapping.
+// Each driver lists which GamepadState bit lands on which report bit (and
+// where its hat switch lives) once, the encoder turns that into lookup
+// tables at compile time so building a report is three table loads.
+//
+// Inputs use GAMEPAD_MASK_B1... for buttons and GAMEPAD_MASK_DU... for the dpad.
+//
+
+typedef struct {
+    uint32_t input;
+    uint32_t output;
+} ReportBit;
+
+// Hat switch values in GamepadState dpad order, placed at `shift` in the output
+typedef struct {
+    uint8_t up;
+    uint8_t upRight;
+    uint8_t right;
+    uint8_t downRight;
+    uint8_t down;
+    uint8_t downLeft;
+    uint8_t left;
+    uint8_t upLeft;
+    uint8_t nothing;
+    uint8_t shift;
+} ReportHat;
+
+template <typename T>
+class ReportEncoder {
+public:
+    template <size_t N>
+    constexpr ReportEncoder(const ReportBit (&bits)[N]) : ReportEncoder(bits, N, nullptr) {}
+
+    template <size_t N>
+    constexpr ReportEncoder(const ReportBit (&bits)[N], const ReportHat & hat) : ReportEncoder(bits, N, &hat) {}
+
+    inline T __attribute__((always_inline)) encode(const GamepadState & state) const {
+        return low[state.buttons & 0xFF] | high[(state.buttons >> 8) & 0x3F] | dpad[state.dpad & 0x0F];
+    }
+private:
+    constexpr ReportEncoder(const ReportBit * bits, size_t count, const ReportHat * hat) : low(), high(), dpad() {
+        for (size_t i = 0; i < count; i++) {
+            for (uint32_t value = 0; value < 256; value++) {
+                if ((bits[i].input & 0xFF) & value)
+                    low[value] |= bits[i].output;
+                if (value < 64 && ((bits[i].input >> 8) & 0x3F) & value)
+                    high[value] |= bits[i].output;
+                if (value < 16 && ((bits[i].input >> 16) & 0x0F) & value)
+                    dpad[value] |= bits[i].output;
+            }
+        }
+        if (hat != nullptr) {
+            for (uint32_t value = 0; value < 16; value++) {
+                dpad[value] |= (T)hatValue(*hat, value) << hat->shift;
+            }
+        }
+    }
+
+    static constexpr uint8_t hatValue(const ReportHat & hat, uint32_t dpad) {
+        switch (dpad) {
+            case GAMEPAD_MASK_UP:                        return hat.up;
+            case GAMEPAD_MASK_UP | GAMEPAD_MASK_RIGHT:   return hat.upRight;
+            case GAMEPAD_MASK_RIGHT:                     return hat.right;
+            case GAMEPAD_MASK_DOWN | GAMEPAD_MASK_RIGHT: return hat.downRight;
+            case GAMEPAD_MASK_DOWN:                      return hat.down;
+            case GAMEPAD_MASK_DOWN | GAMEPAD_MASK_LEFT:  return hat.downLeft;
+            case GAMEPAD_MASK_LEFT:                      return hat.left;
+            case GAMEPAD_MASK_UP | GAMEPAD_MASK_LEFT:    return hat.upLeft;
+            default:                                     return hat.nothing;
+        }
+    }
+
+    T low[256];     // buttons B1..R2
+    T high[64];     // buttons S1..A2
+    T dpad[16];     // dpad as buttons and/or hat
+};
+
+// Store the low `bitCount` bits of an encoded value little-endian, keeping whatever follows in the last byte
+static inline void storeReportBits(uint8_t * dst, uint32_t value, uint8_t bitCount) {
+    for (; bitCount >= 8; bitCount -= 8, value >>= 8)
+        *dst++ = (uint8_t)value;
+    if (bitCount > 0) {
+        uint8_t mask = (1U << bitCount) - 1;
+        *dst = (*dst & ~mask) | (value & mask);
+    }
+}
+
+// Reports are only rebuilt when the gamepad state moved
+static inline bool sameGamepadState(const GamepadState & a, const GamepadState & b) {
+    return a.buttons == b.buttons && a.dpad == b.dpad && a.aux == b.aux
+        && a.lx == b.lx && a.ly == b.ly && a.rx == b.rx && a.ry == b.ry
+        && a.lt == b.lt && a.rt == b.rt;
+}
+
+// Seed for a driver's last state: the dpad never has bits outside GAMEPAD_MASK_DPAD, so the first process() always
+// builds the report from the real state
+static inline GamepadState unbuiltGamepadState() {
+    GamepadState state;
+    state.dpad = 0xFF;
+    return state;
+}
+
+#endif // _REPORT_ENCODER_H_
@@ -0,0 +1,54 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+#ifndef _XGIP_REPORT_QUEUE_H_
+#define _XGIP_REPORT_QUEUE_H_
+
+#include <stdint.h>
+
+#include "drivers/xbone/XBOneDescriptors.h"
+
+// Fixed number of queued XGIP packets, producers back off when the queue is full
+#define XGIP_REPORT_QUEUE_SIZE 8
+
+typedef struct {
+    uint8_t report[XBONE_ENDPOINT_SIZE];
+    uint16_t len;
+} xgip_report_t;
+
+//
+// Fixed-capacity ring of outgoing XGIP packets (announce, descriptor,
+// auth chunks and acks). Pacing is timestamp based: callers ask if the
+// queue is ready to send at 'now' instead of sleeping between packets.
+//
+class XGIPReportQueue {
+public:
+    XGIPReportQueue(uint32_t interval) : head(0), count(0), dropped(0), interval(interval), nextSend(0) {}
+
+    bool push(const void * report, uint16_t len);
+    const xgip_report_t * front();
+    void pop();
+    void clear();
+
+    bool empty() { return count == 0; }
+    bool full() { return count == XGIP_REPORT_QUEUE_SIZE; }
+    uint8_t depth() { return count; }
+
+    // Pacing: a packet may go out once the interval has passed since the last send
+    bool ready(uint32_t now) { return count > 0 && (int32_t)(now - nextSend) > 0; }
+    void sent(uint32_t now) { nextSend = now + interval; }
+    void defer(uint32_t now, uint32_t delay) { nextSend = now + delay; }
+
+    uint32_t getDropped() { return dropped; }
+private:
+    xgip_report_t reports[XGIP_REPORT_QUEUE_SIZE];
+    uint8_t head;
+    uint8_t count;
+    uint32_t dropped;
+    uint32_t interval;
+    uint32_t nextSend;
+};
+
+#endif // _XGIP_REPORT_QUEUE_H_
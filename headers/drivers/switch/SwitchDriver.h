@@ -28,6 +28,7 @@ public:
 private:
     uint8_t last_report[CFG_TUD_ENDPOINT0_SIZE] = { };
     SwitchReport switchReport;
+    GamepadState lastState;
 };
 
 #endif // _SWITCH_DRIVER_H_
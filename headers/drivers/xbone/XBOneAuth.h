@@ -1,68 +1,89 @@
 #ifndef _XBONEAUTH_H_
 #define _XBONEAUTH_H_
 
+#include <atomic>
+#include <string.h>
+
 #include "drivers/shared/gpauthdriver.h"
 #include "drivers/shared/xgip_protocol.h"
+#include "mailbox.h"
 
-typedef enum {
-    auth_idle_state = 0,
-    send_auth_console_to_dongle = 1,
-    send_auth_dongle_to_console = 2,
-    wait_auth_console_to_dongle = 3,
-    wait_auth_dongle_to_console = 4,
-} XboxOneState;
+// Auth messages that can wait in each direction, the console and the dongle have one in flight at a time
+#define XBONE_AUTH_QUEUE_SIZE 2
 
-class XBOneAuthBuffer {
-public:
-    XBOneAuthBuffer() {
-        data = nullptr;
-        sequence = 0;
-        length = 0;
-        type = 0;
-    }
-    ~XBOneAuthBuffer(){
-        if ( data != nullptr ) {
-            delete [] data;
-        }
-    }
-
-    void setBuffer(uint8_t * inData, uint16_t inLen, uint8_t inSeq, uint8_t inType) {
-        data = new uint8_t[inLen];
-        length = inLen;
-        sequence = inSeq;
-        type = inType;        
-        memcpy(data, inData, inLen);
-    }
-
-    void reset() {
-        if ( data != nullptr ) {
-            delete [] data;
-        }
-        data = nullptr;
-        sequence = 0;
-        length = 0;
-        type = 0;
-    }
-
-    uint8_t * data;
-    uint8_t sequence;
+// Largest auth message, the same as an XGIPProtocol data buffer
+#define XBONE_AUTH_MAX_DATA 1024
+
+// One auth message, chunks are joined before it is queued
+typedef struct {
+    uint8_t data[XBONE_AUTH_MAX_DATA];
     uint16_t length;
+    uint8_t sequence;
     uint8_t type;
-};
+} XBOneAuthPacket;
 
+typedef SpscQueue<XBOneAuthPacket, XBONE_AUTH_QUEUE_SIZE> XBOneAuthQueue;
+
+// Copy a message into the queue, false if it is full or the message does not fit
+static inline bool queueAuthPacket(XBOneAuthQueue & queue, const uint8_t * data, uint16_t len, uint8_t sequence, uint8_t type) {
+    XBOneAuthPacket * packet = queue.back();
+    if ( packet == nullptr || len > XBONE_AUTH_MAX_DATA )
+        return false;
+    memcpy(packet->data, data, len);
+    packet->length = len;
+    packet->sequence = sequence;
+    packet->type = type;
+    queue.push();
+    return true;
+}
+
+// An auth message its queue had no room for, queued again from the producer's next pass
 typedef struct {
-    XboxOneState xboneState;
+    XBOneAuthPacket packet;
+    bool pending;
+} XBOneAuthRetry;
+
+// Queue a held message, true once nothing is held any more
+static inline bool retryAuthPacket(XBOneAuthQueue & queue, XBOneAuthRetry & retry) {
+    if ( retry.pending && queueAuthPacket(queue, retry.packet.data, retry.packet.length, retry.packet.sequence, retry.packet.type) )
+        retry.pending = false;
+    return !retry.pending;
+}
+
+// Queue a message behind any held one, holding it if the queue is full. false if it had to be dropped:
+// it does not fit, or an earlier message is still held, the handshake can not go on without it either way.
+static inline bool queueAuthPacket(XBOneAuthQueue & queue, XBOneAuthRetry & retry, const uint8_t * data, uint16_t len, uint8_t sequence, uint8_t type) {
+    if ( len > XBONE_AUTH_MAX_DATA || !retryAuthPacket(queue, retry) )
+        return false;
+    if ( queueAuthPacket(queue, data, len, sequence, type) )
+        return true;
+    memcpy(retry.packet.data, data, len);
+    retry.packet.length = len;
+    retry.packet.sequence = sequence;
+    retry.packet.type = type;
+    retry.pending = true;
+    return true;
+}
 
-    // Auth Buffer Queue
-    XBOneAuthBuffer consoleBuffer;
-    XBOneAuthBuffer dongleBuffer;
+typedef struct {
+    // The console side (device driver on core0) and the dongle side (USB host listener) only
+    // hand messages over through these, each side keeps its own sending state
+    XBOneAuthQueue consoleToDongle;
+    XBOneAuthQueue dongleToConsole;
     
     // Console-to-Host e.g. Xbox One to MagicBoots
     //  Note: the Xbox One Passthrough can call send_xbone_report() directly but not the other way around
-    bool authCompleted = false;
+    std::atomic<bool> authCompleted {false};
 
     // Send announce to console AFTER the dongle is established
-    bool dongle_ready = false;
+    std::atomic<bool> dongle_ready {false};
+
+    // An auth message was lost on the way, the console driver announces again to restart the handshake
+    std::atomic<bool> authRestart {false};
+
+    // Set by the console driver on a restart, cleared by the dongle side once it dropped its half of the
+    // old handshake. The console driver leaves both queues alone until then
+    std::atomic<bool> dongleRestart {false};
 } XboxOneAuthData;
 
 class XBOneAuth : public GPAuthDriver {
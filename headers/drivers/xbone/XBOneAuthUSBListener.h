@@ -24,6 +24,8 @@ private:
     uint8_t xbone_dev_addr;
     uint8_t xbone_instance;
     bool mounted;
+    bool authToDongle;  // a console message is being sent to the dongle in outgoingXGIP
+    XBOneAuthRetry dongleToConsoleRetry;
     XGIPProtocol incomingXGIP;
     XGIPProtocol outgoingXGIP;
     XboxOneAuthData * xboxOneAuthData;
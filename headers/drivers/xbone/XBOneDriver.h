@@ -13,6 +13,7 @@
 
 class XBOneDriver : public GPDriver {
 public:
+    virtual ~XBOneDriver();
     virtual void initialize();
     virtual void process(Gamepad * gamepad, uint8_t * outBuffer);
     virtual void initializeAux();
@@ -28,8 +29,11 @@ public:
     virtual uint16_t GetJoystickMidValue();
     virtual USBListener * get_usb_auth_listener();
     bool getAuthSent();
+    uint8_t getReportQueueDepth();
+    uint32_t getReportQueueDropped();
 private:
     virtual void update();
+    bool send_input_report(Gamepad * gamepad, uint32_t now);
     void process_report_queue(uint32_t now);
     bool send_xbone_usb(uint8_t const *buffer, uint16_t bufsize);
     void set_ack_wait();
@@ -40,7 +44,7 @@ private:
     uint8_t keep_alive_sequence;
     uint8_t virtual_keycode_sequence;
     bool xb1_guide_pressed;
-    GPAuthDriver * authDriver;
+    GPAuthDriver * authDriver = nullptr;
 };
 
 #endif // _XBONE_DRIVER_H_
@@ -13,6 +13,7 @@
 
 class XInputDriver : public GPDriver {
 public:
+    virtual ~XInputDriver();
     virtual void initialize();
     virtual void process(Gamepad * gamepad, uint8_t * outBuffer);
     virtual void initializeAux();
@@ -30,7 +31,8 @@ public:
 private:
     uint8_t last_report[CFG_TUD_ENDPOINT0_SIZE] = { };
     XInputReport xinputReport;
-    GPAuthDriver * authDriver;
+    GamepadState lastState;
+    GPAuthDriver * authDriver = nullptr;
 };
 
 #endif
@@ -31,6 +31,16 @@ struct GamepadButtonMapping
 
 #define GAMEPAD_DIGITAL_INPUT_COUNT 18 // Total number of buttons, including D-pad
 
+#define GAMEPAD_HOTKEY_COUNT 16 // HotkeyOptions hotkey01 - hotkey16
+
+// A configured hotkey, compiled from its HotkeyEntry when the gamepad is set up
+struct GamepadHotkeyMatch
+{
+	uint64_t mask;         // dpad | buttons << 8 | aux << 24, the combination that has to be held
+	GamepadHotkey action;
+	bool repeat;           // applied on every frame it is held, instead of once per press
+};
+
 class Gamepad {
 public:
 	Gamepad();
@@ -80,23 +90,6 @@ public:
 		return (state.aux & mask) == mask;
 	}
 
-	/**
-	 * @brief Check for a hotkey combination press. Checks aux, buttons, and dpad.
-	 */
-	inline bool __attribute__((always_inline)) pressedHotkey(const HotkeyEntry hotkey) {
-		return (hotkey.action != 0 && pressedButton(hotkey.buttonsMask) &&
-				pressedDpad(hotkey.dpadMask) && pressedAux(hotkey.auxMask));
-	}
-
-	/**
-	 * @brief Remove hotkey bits from the state bitmask and provide pressed action.
-	 */
-	inline GamepadHotkey __attribute__((always_inline)) selectHotkey(const HotkeyEntry hotkey) {
-		state.buttons &= ~(hotkey.buttonsMask);
-		state.dpad &= ~(hotkey.dpadMask);
-		return static_cast<GamepadHotkey>(hotkey.action);
-	}
-
 	inline bool __attribute__((always_inline)) pressedUp()    { return pressedDpad(GAMEPAD_MASK_UP); }
 	inline bool __attribute__((always_inline)) pressedDown()  { return pressedDpad(GAMEPAD_MASK_DOWN); }
 	inline bool __attribute__((always_inline)) pressedLeft()  { return pressedDpad(GAMEPAD_MASK_LEFT); }
@@ -166,11 +159,16 @@ private:
 	uint8_t getModifier(uint8_t code);
 	uint8_t getMultimedia(uint8_t code);
 	void processHotkeyAction(GamepadHotkey action);
+	void compileHotkeys();
 
 	GamepadOptions & options;
 	const HotkeyOptions & hotkeyOptions;
 
 	GamepadHotkey lastAction = HOTKEY_NONE;
+	GamepadHotkeyMatch hotkeyMatches[GAMEPAD_HOTKEY_COUNT];
+	uint8_t hotkeyMatchCount = 0;
+	uint64_t hotkeyCommonMask = 0; // bits held by every configured hotkey
+	DpadPressOrder dpadPressOrder;
 };
 
 #endif
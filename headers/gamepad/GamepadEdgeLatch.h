@@ -0,0 +1,57 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+#ifndef _GAMEPADEDGELATCH_H_
+#define _GAMEPADEDGELATCH_H_
+
+#include <stdint.h>
+
+#include "gamepad/GamepadState.h"
+
+// Minimum time a button edge stays visible to the host, 0 = as soon as it was reported once
+#ifndef GAMEPAD_MIN_HOLD_US
+#define GAMEPAD_MIN_HOLD_US 0
+#endif
+
+// Buttons only: the dpad has been through SOCD cleaning and the 4-way filters by now, and a latched
+// direction next to a live one could add up to Left+Right or a diagonal those modes rule out
+#define GAMEPAD_EDGE_LATCH_BITS 16
+#define GAMEPAD_EDGE_LATCH_ALL ((1UL << GAMEPAD_EDGE_LATCH_BITS) - 1)
+
+class Gamepad;
+
+//
+// Report history stage between Gamepad::process() and GPDriver::process().
+// Press and release edges are latched until the driver reports a report
+// holding them was handed to the host, so a tap shorter than the host poll
+// interval still shows up in at least one report.
+//
+class GamepadEdgeLatch {
+public:
+    GamepadEdgeLatch();
+    void setMinHold(uint32_t mask, uint32_t holdUs);
+    void process(Gamepad * gamepad, uint32_t now);  // rewrites the digital state before the driver
+    void commit(bool committed, uint32_t now);       // driver result for the state from process()
+    void reset();
+    bool isPending() { return (pendingPress | pendingRelease) != 0; } // edges the host has not seen
+
+    uint32_t getPreservedEdges() { return preservedEdges; } // edges only the latch kept visible
+    uint32_t getMergedEdges() { return mergedEdges; }       // edges lost to repeated taps in one report
+private:
+    uint32_t getHeldMask(uint32_t now);
+
+    uint32_t previous;          // raw state from the last process()
+    uint32_t output;            // state handed to the driver
+    uint32_t committed;         // state the host has seen
+    uint32_t pendingPress;      // pressed, host still sees released
+    uint32_t pendingRelease;    // released, host still sees pressed
+    uint32_t holdMask;          // bits with a minimum hold time
+    uint32_t holdTime[GAMEPAD_EDGE_LATCH_BITS];
+    uint32_t changedAt[GAMEPAD_EDGE_LATCH_BITS];
+    uint32_t preservedEdges;
+    uint32_t mergedEdges;
+};
+
+#endif
@@ -6,7 +6,6 @@
 #pragma once
 
 #include <stdint.h>
-#include <list>
 using namespace std;
 #include "GamepadEnums.h"
 #include "enums.pb.h"
@@ -133,23 +132,47 @@ uint16_t dpadToAnalogY(uint8_t dpad);
 
 uint8_t getMaskFromDirection(DpadDirection direction);
 
-uint8_t updateDpad(uint8_t dpad, DpadDirection direction);
+/**
+ * @brief Press order of the four cardinal directions.
+ *
+ * Every new press is stamped with a counter that advances once per update that has a press in it, so directions
+ * pressed in the same update share a stamp. Each owner (gamepad, add-on) keeps its own instance, nothing is shared.
+ */
+class DpadPressOrder
+{
+public:
+	void update(uint8_t dpad);
+	void reset();
+
+	// The most recently pressed of the held directions in `mask`, ties go to the later of UP, DOWN, LEFT, RIGHT
+	uint8_t latest(uint8_t mask) const;
+
+	// For two held directions: the one pressed last (or first), 0 if they were pressed together
+	uint8_t resolve(uint8_t a, uint8_t b, bool lastWins) const;
+
+private:
+	uint8_t held {0};
+	uint32_t clock {0};
+	uint32_t pressedAt[4] {};
+};
 
 /**
  * @brief Filter diagonals out of the dpad, making the device work as a 4-way lever.
  *
  * The most recent cardinal direction wins.
  *
+ * @param order The press order, already updated with this dpad value.
  * @param dpad The GameState.dpad value.
  * @return uint8_t The new dpad value.
  */
-uint8_t filterToFourWayMode(uint8_t dpad);
+uint8_t filterToFourWayMode(const DpadPressOrder & order, uint8_t dpad);
 
 /**
  * @brief Run SOCD cleaning against a D-pad value.
  *
+ * @param order The press order, already updated with the unfiltered dpad value.
  * @param mode The SOCD cleaning mode.
  * @param dpad The GamepadState.dpad value.
  * @return uint8_t The clean D-pad value.
  */
-uint8_t runSOCDCleaner(SOCDMode mode, uint8_t dpad);
\ No newline at end of file
+uint8_t runSOCDCleaner(const DpadPressOrder & order, SOCDMode mode, uint8_t dpad);
\ No newline at end of file
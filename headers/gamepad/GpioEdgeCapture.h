@@ -0,0 +1,76 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+#ifndef _GPIOEDGECAPTURE_H_
+#define _GPIOEDGECAPTURE_H_
+
+#include <stdint.h>
+#include <atomic>
+
+#include "types.h"
+#include "hardware/gpio.h"
+
+// Sample button GPIO from edge interrupts instead of polling gpio_get_all() once per loop
+#ifndef GPIO_EDGE_CAPTURE_ENABLED
+#define GPIO_EDGE_CAPTURE_ENABLED 0
+#endif
+
+// Edges that can be queued between two loop iterations, must be a power of two
+#ifndef GPIO_EDGE_QUEUE_SIZE
+#define GPIO_EDGE_QUEUE_SIZE 64
+#endif
+
+struct GpioEdgeEvent {
+    uint32_t timeUs;
+    uint8_t pin;
+    uint8_t pressed;    // 1 = active (low), same sense as debouncedGpio
+};
+
+//
+// Single producer (GPIO IRQ on core0), single consumer (core0 loop) ring of
+// button edges. Nothing is overwritten when full, the overflow is flagged and
+// the consumer resynchronizes from the pin levels instead.
+//
+class GpioEdgeQueue {
+public:
+    bool push(const GpioEdgeEvent & event);
+    bool peek(GpioEdgeEvent & event) const;
+    void pop();
+    void clear();
+    bool empty() const { return head.load(std::memory_order_acquire) == tail.load(std::memory_order_relaxed); }
+    bool takeOverflow() { return overflow.exchange(false); }
+private:
+    static_assert((GPIO_EDGE_QUEUE_SIZE & (GPIO_EDGE_QUEUE_SIZE - 1)) == 0, "GPIO_EDGE_QUEUE_SIZE must be a power of two");
+
+    GpioEdgeEvent events[GPIO_EDGE_QUEUE_SIZE];
+    std::atomic<uint16_t> head {0};  // written by the IRQ
+    std::atomic<uint16_t> tail {0};  // written by the loop
+    std::atomic<bool> overflow {false};
+};
+
+//
+// Interrupt driven replacement for the polling debouncer in GP2040. Every edge
+// is timestamped in the IRQ and debounced against its own timestamp, and a pin
+// changes at most once per process() call, so a press and release that both
+// land between two loop iterations still show up as a press for one read.
+//
+class GpioEdgeCapture {
+public:
+    void setup(Mask_t pins);      // enable edge interrupts for the button GPIO
+    void teardown();              // disable them again, before pins are remapped
+    Mask_t process(Mask_t debounced, uint32_t debounceDelayUs);
+
+    uint32_t getOverflows() { return overflows; }
+private:
+    static void irqHandler();
+
+    Mask_t pinMask = 0;
+    Mask_t levels = 0;            // pin levels as of the last edge taken from the queue
+    uint32_t changedAt[NUM_BANK0_GPIOS] = {};  // last change of the debounced state
+    uint32_t levelAt[NUM_BANK0_GPIOS] = {};    // last edge in levels
+    uint32_t overflows = 0;
+};
+
+#endif
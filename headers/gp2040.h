@@ -10,8 +10,11 @@
 
 // GP2040 Classes
 #include "gamepad.h"
+#include "gamepad/GamepadEdgeLatch.h"
+#include "gamepad/GpioEdgeCapture.h"
 #include "addonmanager.h"
 #include "gpdriver.h"
+#include "loopgovernor.h"
 
 #include "pico/types.h"
 
@@ -24,10 +27,13 @@ public:
 private:
     Gamepad snapshot;
     AddonManager addons;
+    GamepadEdgeLatch edgeLatch; // keeps sub-poll taps visible to the host
+    LoopGovernor governor;      // sleeps between host polls, see LOOP_GOVERNOR_ENABLED
     // GPIO debouncer
     void debounceGpioGetAll();
     Mask_t buttonGpios;
     uint32_t gpioDebounceTime[NUM_BANK0_GPIOS];
+    GpioEdgeCapture edgeCapture; // IRQ sampled alternative to polling, see GPIO_EDGE_CAPTURE_ENABLED
 
     struct RebootHotkeys {
         RebootHotkeys();
@@ -8,6 +8,7 @@
 
 #include "addonmanager.h"
 #include "drivermanager.h"
+#include "loopgovernor.h"
 
 class GP2040Aux {
 public:
@@ -16,8 +17,11 @@ public:
     void setup();           // setup core1
     void run();             // loop core1
 private:
+    void initializeDriverAux(); // aux side of the running driver, again after every DriverManager::switchMode
     GPDriver * inputDriver;
+    uint32_t driverGeneration;
     AddonManager addons;
+    LoopGovernor governor;
 };
 
 #endif
@@ -26,6 +26,12 @@ public:
     // For add-ons that require a USB-host listener, get listener
     virtual USBListener * getListener() { return listener; }
 
+    /**
+     * Return true while the addon has to run on every loop iteration (sampling, animation, timed
+     * output), this keeps the LoopGovernor from sleeping the core between host polls.
+     */
+    virtual bool needsContinuousLoop() { return false; }
+
 protected:
     USBListener * listener;
 };
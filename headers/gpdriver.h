@@ -25,6 +25,7 @@ class Gamepad;
 //
 class GPDriver {
 public:
+    virtual ~GPDriver() {}
     virtual void initialize() = 0;
     virtual void initializeAux() = 0;
     virtual void process(Gamepad * gamepad, uint8_t * outBuffer) = 0;
@@ -40,8 +41,10 @@ public:
     virtual uint16_t GetJoystickMidValue() = 0;
     const usbd_class_driver_t * get_class_driver() { return &class_driver; }
     virtual USBListener * get_usb_auth_listener() = 0;
+    bool isReportCommitted() { return reportCommitted; } // host has (or will get) the last processed input
 protected:
     usbd_class_driver_t class_driver;
+    bool reportCommitted = true;
 };
 
 #endif
@@ -31,6 +31,12 @@ typedef struct {
     GPButtonParameters parameters;
 } GPButtonLayout;
 
+typedef struct {
+    uint16_t index;
+    const GPButtonLayout* elements;
+    uint16_t count;
+} GPButtonLayoutEntry;
+
 #define LAYOUTMGR LayoutManager::getInstance()
 
 class LayoutManager {
@@ -56,78 +62,6 @@ class LayoutManager {
         std::string getButtonLayoutRightName(ButtonLayoutRight layout);
 
         LayoutList adjustByCustomSettings(LayoutList layout, ButtonLayoutParamsCommon common, uint16_t originX = 0, uint16_t originY = 0);
-
-        // old layout methods
-        LayoutList drawStickless();
-        LayoutList drawWasdBox();
-        LayoutList drawArcadeStick();
-        LayoutList drawUDLR();
-        LayoutList drawMAMEA();
-        LayoutList drawOpenCore0WASDA();
-        LayoutList drawOpenCore0WASDB();
-        LayoutList drawMAMEB();
-        LayoutList drawMAME8B();
-        LayoutList drawKeyboardAngled();
-        LayoutList drawVewlix();
-        LayoutList drawVewlix7();
-        LayoutList drawSega2p();
-        LayoutList drawNoir8();
-        LayoutList drawCapcom();
-        LayoutList drawCapcom6();
-        LayoutList drawSticklessButtons();
-        LayoutList drawWasdButtons();
-        LayoutList drawArcadeButtons();
-        LayoutList drawDancepadA();
-        LayoutList drawDancepadB();
-        LayoutList drawTwinStickA();
-        LayoutList drawTwinStickB();
-        LayoutList drawBlankA();
-        LayoutList drawBlankB();
-        LayoutList drawVLXA();
-        LayoutList drawVLXB();
-        LayoutList drawFightboard();
-        LayoutList drawFightboardMirrored();
-        LayoutList drawFightboardStick();
-        LayoutList drawFightboardStickMirrored();
-        LayoutList drawStickless13A();
-        LayoutList drawSticklessButtons13B();
-        LayoutList drawStickless16A();
-        LayoutList drawSticklessButtons16B();
-        LayoutList drawStickless14A();
-        LayoutList drawSticklessButtons14B();
-        LayoutList drawButtonLayoutLeft();
-        LayoutList drawButtonLayoutRight();
-        LayoutList drawBoardDefinedA();
-        LayoutList drawBoardDefinedB();
-        LayoutList drawDancepadDDRLeft();
-        LayoutList drawDancepadDDRSolo();
-        LayoutList drawDancepadPIULeft();
-        LayoutList drawPopnA();
-        LayoutList drawTaikoA();
-        LayoutList drawBMTurntableA();
-        LayoutList drawBM5KeyA();
-        LayoutList drawBM7KeyA();
-        LayoutList drawGitadoraFretA();
-        LayoutList drawGitadoraStrumA();
-        LayoutList drawBandHeroFretA();
-        LayoutList drawBandHeroStrumA();
-        LayoutList draw6GAWDLeft();
-        LayoutList draw6GAWDAllButtonLeft();
-        LayoutList draw6GAWDAllButtonPlusLeft();
-        LayoutList drawDancepadDDRRight();
-        LayoutList drawDancepadPIURight();
-        LayoutList drawPopnB();
-        LayoutList drawTaikoB();
-        LayoutList drawBMTurntableB();
-        LayoutList drawBM5KeyB();
-        LayoutList drawBM7KeyB();
-        LayoutList drawGitadoraFretB();
-        LayoutList drawGitadoraStrumB();
-        LayoutList drawBandHeroFretB();
-        LayoutList drawBandHeroStrumB();
-        LayoutList draw6GAWDRight();
-        LayoutList draw6GAWDAllButtonRight();
-        LayoutList draw6GAWDAllButtonPlusRight();
     private:
         LayoutManager(){}
 
@@ -135,6 +69,10 @@ class LayoutManager {
 
         LayoutManager::LayoutList getLeftLayout(uint16_t index);
         LayoutManager::LayoutList getRightLayout(uint16_t index);
+        LayoutManager::LayoutList findLayout(const GPButtonLayoutEntry* table, size_t tableSize, uint16_t index);
+
+        LayoutList drawButtonLayoutLeft();
+        LayoutList drawButtonLayoutRight();
 };
 
 #endif
\ No newline at end of file
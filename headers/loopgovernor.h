@@ -0,0 +1,47 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+#ifndef _LOOPGOVERNOR_H_
+#define _LOOPGOVERNOR_H_
+
+#include <stdint.h>
+
+#include "types.h"
+
+// Let the core loops sleep while idle instead of spinning
+#ifndef LOOP_GOVERNOR_ENABLED
+#define LOOP_GOVERNOR_ENABLED 0
+#endif
+
+// Bounds of a single idle sleep
+#ifndef LOOP_GOVERNOR_MIN_SLEEP_US
+#define LOOP_GOVERNOR_MIN_SLEEP_US 100
+#endif
+
+#ifndef LOOP_GOVERNOR_MAX_SLEEP_US
+#define LOOP_GOVERNOR_MAX_SLEEP_US 4000
+#endif
+
+//
+// Sleeps the calling core with __wfe() between loop iterations that had
+// nothing to do. A sleep lasts at most half the host poll interval and ends
+// early on any interrupt (GPIO edge, USB, alarm) or on __sev() from the other
+// core, so a button press still reaches the next report in time.
+//
+class LoopGovernor {
+public:
+    void setup(uint32_t pollIntervalUs);
+    void setWakePins(Mask_t pins);   // button GPIO whose edges have to end a sleep
+    void idle(bool busy);            // end of a loop iteration, sleeps unless busy
+
+    uint32_t getSleepUs() { return sleepUs; }
+
+    // Shortest interrupt IN endpoint interval in a configuration descriptor, 1 ms if there is none
+    static uint32_t getPollIntervalUs(const uint8_t * configDescriptor);
+private:
+    uint32_t sleepUs = 0;
+};
+
+#endif
@@ -0,0 +1,91 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+#ifndef _MAILBOX_H_
+#define _MAILBOX_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+//
+// Latest-value mailbox between the cores: one writer, any number of readers.
+// A write never waits, a read that overlapped a write is retried. The value
+// is kept in atomic words, so a torn copy is only ever thrown away.
+//
+template <typename T>
+class SeqlockMailbox {
+public:
+    static_assert(std::is_trivially_copyable<T>::value, "SeqlockMailbox copies T word by word");
+
+    void write(const T & value) {
+        uint32_t buffer[WORDS] = {};
+        memcpy(buffer, &value, sizeof(T));
+        uint32_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);  // odd: write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        for (uint32_t i = 0; i < WORDS; i++)
+            words[i].store(buffer[i], std::memory_order_relaxed);
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    // Copies the last value written (all zero before the first write), returns its sequence number
+    uint32_t read(T & value) const {
+        uint32_t buffer[WORDS];
+        uint32_t before, after;
+        do {
+            before = sequence.load(std::memory_order_acquire);
+            for (uint32_t i = 0; i < WORDS; i++)
+                buffer[i] = words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+        memcpy(&value, buffer, sizeof(T));
+        return before;
+    }
+private:
+    static constexpr uint32_t WORDS = (sizeof(T) + 3) / 4;
+
+    std::atomic<uint32_t> words[WORDS] = {};
+    std::atomic<uint32_t> sequence {0};
+};
+
+//
+// Bounded single producer, single consumer queue between the cores. Entries
+// are filled and read in place: the producer writes the slot from back() and
+// publishes it with push(), the consumer reads front() and frees it with pop().
+// Nothing is overwritten, back() is null while the queue is full.
+//
+template <typename T, uint8_t N>
+class SpscQueue {
+public:
+    static_assert(N > 0 && N <= 128 && (N & (N - 1)) == 0, "SpscQueue size must be a power of two up to 128");
+
+    T * back() {
+        uint8_t h = head.load(std::memory_order_relaxed);
+        if ((uint8_t)(h - tail.load(std::memory_order_acquire)) >= N)
+            return nullptr;
+        return &slots[h & (N - 1)];
+    }
+    void push() { head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    const T * front() {
+        uint8_t t = tail.load(std::memory_order_relaxed);
+        if (head.load(std::memory_order_acquire) == t)
+            return nullptr;
+        return &slots[t & (N - 1)];
+    }
+    void pop() { tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    // Consumer side: drop everything queued so far
+    void clear() { tail.store(head.load(std::memory_order_acquire), std::memory_order_release); }
+private:
+    T slots[N];
+    std::atomic<uint8_t> head {0};  // written by the producer
+    std::atomic<uint8_t> tail {0};  // written by the consumer
+};
+
+#endif
@@ -20,6 +20,33 @@
 
 #define SI Storage::getInstance()
 
+// A deferred save waits until nothing has changed for this long, so a burst of changes is one flash write
+#ifndef STORAGE_SAVE_QUIET_MS
+#define STORAGE_SAVE_QUIET_MS 2000
+#endif
+
+// ...but no longer than this after the first change of the burst
+#ifndef STORAGE_SAVE_MAX_DELAY_MS
+#define STORAGE_SAVE_MAX_DELAY_MS 10000
+#endif
+
+// Deferred saves are rate limited by a token bucket: up to STORAGE_SAVE_BURST back to back,
+// then one more every STORAGE_SAVE_REFILL_MS
+#ifndef STORAGE_SAVE_BURST
+#define STORAGE_SAVE_BURST 3
+#endif
+
+#ifndef STORAGE_SAVE_REFILL_MS
+#define STORAGE_SAVE_REFILL_MS 30000
+#endif
+
+// Parts of the config a deferred save was requested for
+enum StorageSection : uint32_t {
+	STORAGE_SECTION_GAMEPAD   = (1U << 0), // gamepad options changed by hotkeys: modes, SOCD, profile
+	STORAGE_SECTION_ADDONS    = (1U << 1), // add-on options changed at runtime, e.g. the turbo shot count
+	STORAGE_SECTION_ANIMATION = (1U << 2), // animation options handed over from core1
+};
+
 // Storage manager for board, LED options, and thread-safe settings
 class Storage {
 public:
@@ -50,9 +77,15 @@ public:
 	void init();
 	bool save();
 
-	// Perform saves that were enqueued from core1
+	// Commit deferred saves once their section has been quiet long enough and the rate limit allows it
 	void performEnqueuedSaves();
 
+	// Commit deferred saves now, before a reboot (core0 only)
+	void flushSaves();
+
+	// Mark sections of the config as changed, they are written by a later performEnqueuedSaves()
+	void enqueueSave(uint32_t sections = STORAGE_SECTION_GAMEPAD);
+
 	void enqueueAnimationOptionsSave(const AnimationOptions& animationOptions);
 
 	void SetConfigMode(bool); 			// Config Mode (on-boot)
@@ -82,7 +115,15 @@ private:
 	uint8_t featureData[32]; // USB X-Input Feature Data
 	DisplayOptions previewDisplayOptions;
 	Config config;
-	std::atomic<bool> animationOptionsSavePending;
+	std::atomic<uint32_t> dirtySections {0};
+	std::atomic<uint32_t> saveRequests {0};   // bumped by every enqueue, tells performEnqueuedSaves a change came in
+	uint32_t seenSaveRequests = 0;
+	bool saveBurstPending = false;
+	uint32_t firstChangeMs = 0;               // first and latest change of the pending burst
+	uint32_t lastChangeMs = 0;
+	uint32_t saveTokens = STORAGE_SAVE_BURST;
+	uint32_t tokenRefillMs = 0;               // time the next token is counted from
+	void commitEnqueuedSaves();
 	critical_section_t animationOptionsCs;
 	uint32_t animationOptionsCrc = 0;
 	AnimationOptions animationOptionsToSave = {};
@@ -26,7 +26,23 @@ namespace System {
     // This value can be retrieved after reboot by client code, which can then take the required actions
     void reboot(BootMode bootMode);
     // Retrieves the BootMode value from the watchdog scratch register and resets its value to BootMode::DEFAULT
+    // The boot timing of the boot before the reboot is taken from the scratch registers at the same time
     BootMode takeBootMode();
+
+    enum class BootEvent : uint8_t {
+        DEVICE_START = 0,   // tud_init() has returned
+        DEVICE_MOUNTED,     // the host has configured the device
+        FIRST_REPORT,       // the host has taken the first input report
+        HOST_READY,         // the USB host stack is running
+        COUNT
+    };
+
+    // Records when this boot first reached the event, later calls for the same event are ignored
+    void markBootEvent(BootEvent event);
+    // Microseconds from power-up to the event in this boot, 0 if it has not happened
+    uint32_t getBootEventUs(BootEvent event);
+    // Milliseconds from power-up to the event in the boot before the last software reboot, 0 if unknown
+    uint32_t getPreviousBootEventMs(BootEvent event);
 }
 
 #endif
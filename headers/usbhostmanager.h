@@ -2,6 +2,7 @@
 #define _USBHOSTMANAGER_H_
 
 #include "usblistener.h"
+#include <atomic>
 #include <vector>
 
 #include "pio_usb.h"
@@ -9,6 +10,17 @@
 #include "host/usbh.h"
 #include "host/usbh_pvt.h"
 
+// Service the USB host (tuh_task() and the USBListener callbacks) from the core1 loop instead of the
+// core0 input loop. Listener state reaches core0 through a mailbox (see mailbox.h).
+#ifndef USB_HOST_ON_CORE1
+#define USB_HOST_ON_CORE1 0
+#endif
+
+// Time the host port lines have to show an attached device before the host stack is started
+#ifndef USB_HOST_ATTACH_SETTLE_US
+#define USB_HOST_ATTACH_SETTLE_US 10000
+#endif
+
 // USB Host manager decides on TinyUSB Host driver
 usbh_class_driver_t const* usbh_app_driver_get_cb(uint8_t *driver_count);
 
@@ -20,10 +32,13 @@ public:
 		static USBHostManager instance; // Guaranteed to be destroyed. // Instantiated on first use.
 		return instance;
 	}
-    void start();               // Start USB Host
+    void start();               // Start USB Host (the host stack itself comes up from process()), no-op once started
     void shutdown();            // Called on system reboot
     void pushListener(USBListener *); // If anything needs to update in the gpconfig driver
+    void removeListener(USBListener *); // before the listener is freed, see DriverManager::switchMode
     void process();
+    void processStart();        // core1 loop: runs tuh_init() once process() has seen a device on the port
+    bool isReady() { return state.load() == HostState::RUNNING; } // host stack is running and wants tuh_task() every loop
     void hid_mount_cb(uint8_t dev_addr, uint8_t instance, uint8_t const* desc_report, uint16_t desc_len);
     void hid_umount_cb(uint8_t daddr, uint8_t instance);
     void hid_report_received_cb(uint8_t dev_addr, uint8_t instance, uint8_t const* report, uint16_t len);
@@ -35,11 +50,24 @@ public:
     void xinput_report_sent_cb(uint8_t dev_addr, uint8_t instance, uint8_t const* report, uint16_t len);
     
 private:
-    USBHostManager() : tuh_ready(false), core0Ready(false), core1Ready(false) {}
+    enum class HostState : uint8_t {
+        DISABLED,       // no host port, or nothing listening to it
+        WAIT_DEVICE,    // device side is not up yet, it goes first
+        WAIT_ATTACH,    // watching the port lines for a device
+        START,          // a device is on the port, core1 brings the host stack up
+        RUNNING,        // tuh_init() done, tuh_task() every loop
+    };
+
+    USBHostManager() : state(HostState::DISABLED), core0Ready(false), core1Ready(false) {}
+    bool lineAttached();
+    void startHost();
+
     std::vector<USBListener*> listeners;
     usb_device_t *usb_device;
     uint8_t dataPin;
-    bool tuh_ready;
+    uint8_t dmPin;
+    uint32_t attachedSince;
+    std::atomic<HostState> state;
     bool core0Ready;
     bool core1Ready;
 };
@@ -0,0 +1,48 @@
+#ifndef _USBHOSTSLOTS_H_
+#define _USBHOSTSLOTS_H_
+
+#include <stdint.h>
+
+#include "gamepad/GamepadState.h"
+#include "mailbox.h"
+
+// Host devices a listener keeps apart, one hub's worth (CFG_TUH_DEVICE_MAX)
+#ifndef USB_HOST_MAX_DEVICES
+#define USB_HOST_MAX_DEVICES 4
+#endif
+
+// A host stick closer to centre than this counts as untouched when slots are merged
+#ifndef USB_HOST_STICK_DEADZONE
+#define USB_HOST_STICK_DEADZONE 0x0800
+#endif
+
+//
+// Fixed per-device state for a USBListener. Each mounted (dev_addr, instance)
+// owns a slot from mount to unmount and publishes its decoded state there; the
+// slots are combined on core0 with merge(). Slot bookkeeping happens on the
+// host core only, the states cross over in one SeqlockMailbox per slot, so
+// freeing a slot resets that slot and nothing else.
+//
+class USBHostSlots {
+public:
+	USBHostSlots();
+
+	// Host core
+	int8_t claim(uint8_t dev_addr, uint8_t instance);     // first free slot, -1 if all are taken
+	int8_t find(uint8_t dev_addr, uint8_t instance) const;
+	void release(int8_t slot);                             // back to free and neutral
+	void releaseDevice(uint8_t dev_addr);                  // every slot of an unmounted device
+	void publish(int8_t slot, const GamepadState & state) { states[slot].write(state); }
+
+	// Reading core: combine the slots into one state, neutral when no slot has input
+	void merge(GamepadState & merged, HostMergeMode mode, uint8_t playerSlot);
+
+	static bool hasInput(const GamepadState & state);
+private:
+	uint8_t devAddr[USB_HOST_MAX_DEVICES];    // 0 = free, TinyUSB never hands out address 0
+	uint8_t instances[USB_HOST_MAX_DEVICES];
+	SeqlockMailbox<GamepadState> states[USB_HOST_MAX_DEVICES];
+	int8_t prioritySlot;                      // HOST_MERGE_PRIORITY owner until it goes idle, -1 = none, reading core only
+};
+
+#endif
@@ -52,6 +52,9 @@
 #if LWIP_HTTPD_CUSTOM_FILES
 int fs_open_custom(struct fs_file *file, const char *name);
 void fs_close_custom(struct fs_file *file);
+#if LWIP_HTTPD_DYNAMIC_FILE_READ
+int fs_read_custom(struct fs_file *file, char *buffer, int count);
+#endif /* LWIP_HTTPD_DYNAMIC_FILE_READ */
 #if LWIP_HTTPD_FS_ASYNC_READ
 u8_t fs_canread_custom(struct fs_file *file);
 u8_t fs_wait_read_custom(struct fs_file *file, fs_wait_cb callback_fn, void *callback_arg);
@@ -127,6 +130,12 @@ fs_read(struct fs_file *file, char *buffer, int count)
   if(file->index == file->len) {
     return FS_READ_EOF;
   }
+#if LWIP_HTTPD_CUSTOM_FILES
+  /* custom files without data are generated while they are sent */
+  if (file->is_custom_file && file->data == NULL) {
+    return fs_read_custom(file, buffer, count);
+  }
+#endif /* LWIP_HTTPD_CUSTOM_FILES */
 #if LWIP_HTTPD_FS_ASYNC_READ
 #if LWIP_HTTPD_CUSTOM_FILES
   if (!fs_canread_custom(file)) {
@@ -9,6 +9,9 @@ extern "C" {
 
 int fs_open_custom(struct fs_file *file, const char *name);
 void fs_close_custom(struct fs_file *file);
+#if LWIP_HTTPD_DYNAMIC_FILE_READ
+int fs_read_custom(struct fs_file *file, char *buffer, int count);
+#endif
 
 #ifdef __cplusplus
 }
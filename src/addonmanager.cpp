@@ -47,6 +47,14 @@ void AddonManager::ProcessAddons(ADDON_PROCESS processType) {
     }
 }
 
+bool AddonManager::NeedsContinuousLoop(ADDON_PROCESS processType) {
+    for (std::vector<AddonBlock*>::iterator it = addons.begin(); it != addons.end(); it++) {
+        if ( (*it)->process == processType && (*it)->ptr->needsContinuousLoop() )
+            return true;
+    }
+    return false;
+}
+
 // HACK : change this for NeoPicoLED
 GPAddon * AddonManager::GetAddon(std::string name) { // hack for NeoPicoLED
     for (std::vector<AddonBlock*>::iterator it = addons.begin(); it != addons.end(); it++) {
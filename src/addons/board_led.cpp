@@ -70,9 +70,9 @@ void BoardLedAddon::process() {
             }
             break;
         case OnBoardLedMode::ON_BOARD_LED_MODE_PS_AUTH:
-            processedGamepad = Storage::getInstance().GetProcessedGamepad();
-            if(processedGamepad->getOptions().inputMode == INPUT_MODE_PS4 ||
-                processedGamepad->getOptions().inputMode == INPUT_MODE_PS5) {
+            // the running driver, not the saved mode, since the web config hotkey swaps it in place
+            if(DriverManager::getInstance().getInputMode() == INPUT_MODE_PS4 ||
+                DriverManager::getInstance().getInputMode() == INPUT_MODE_PS5) {
                 state = ((PS4Driver*)DriverManager::getInstance().getDriver())->getAuthSent() == true;
             }
             if (prevState != state) {
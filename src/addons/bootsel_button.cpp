@@ -1,10 +1,12 @@
 #include "addons/bootsel_button.h"
 #include "storagemanager.h"
+#include "pico/multicore.h"
 #include "hardware/gpio.h"
 #include "hardware/sync.h"
 #include "hardware/structs/ioqspi.h"
 #include "hardware/structs/sio.h"
 #include "helper.h"
+#include "usbhostmanager.h"
 #include "config.pb.h"
 
 bool __no_inline_not_in_flash_func(BootselButtonAddon::isBootselPressed)() {
@@ -42,14 +44,37 @@ bool BootselButtonAddon::available() {
 	return options.enabled && options.buttonMap != 0;
 }
 
+/**
+ * @brief Sample BOOTSEL at a fixed rate instead of on every loop iteration.
+ *
+ * Floating chip select cuts both cores off from flash, so core1 is parked in RAM through multicore
+ * lockout while a sample is taken, the same way FlashPROM does for writes. Until core1
+ * is up (or while something else holds it) the sample is skipped and the last state stays published.
+ * With USB_HOST_ON_CORE1 core1 cannot be stalled that long without breaking the PIO-USB frame timing,
+ * so BOOTSEL reads as released for as long as the host is running there.
+ */
+int64_t BootselButtonAddon::sampleAlarm(alarm_id_t id, void * user) {
+	BootselButtonAddon * addon = (BootselButtonAddon *)user;
+	if (USB_HOST_ON_CORE1 && USBHostManager::getInstance().isReady()) {
+		addon->bootselPressed = false;
+	} else if (multicore_lockout_victim_is_initialized(1) &&
+			multicore_lockout_start_timeout_us(BOOTSEL_LOCKOUT_TIMEOUT_US)) {
+		addon->bootselPressed = addon->isBootselPressed();
+		multicore_lockout_end_timeout_us(BOOTSEL_LOCKOUT_TIMEOUT_US);
+	}
+	return -BOOTSEL_SAMPLE_INTERVAL_US;
+}
+
 void BootselButtonAddon::setup() {
     const BootselButtonOptions& options = Storage::getInstance().getAddonOptions().bootselButtonOptions;
 	bootselButtonMap = options.buttonMap;
+	bootselPressed = false;
+	add_alarm_in_us(BOOTSEL_SAMPLE_INTERVAL_US, sampleAlarm, this, true);
 }
 
 void BootselButtonAddon::preprocess() {
 	Gamepad * gamepad = Storage::getInstance().GetGamepad();
-	if (isBootselPressed()) {
+	if (bootselPressed) {
 		switch (bootselButtonMap) {
 			case (GAMEPAD_MASK_DU):
 				gamepad->state.dpad |= GAMEPAD_MASK_UP;
@@ -0,0 +1,18 @@
+#include "addons/gamepad_usb_host.h"
+#include "addons/gamepad_usb_host_listener.h"
+#include "storagemanager.h"
+#include "peripheralmanager.h"
+
+bool GamepadUSBHostAddon::available() {
+	const GamepadUSBHostOptions& gamepadUSBHostOptions = Storage::getInstance().getAddonOptions().gamepadUSBHostOptions;
+	return gamepadUSBHostOptions.enabled && PeripheralManager::getInstance().isUSBEnabled(0);
+}
+
+void GamepadUSBHostAddon::setup() {
+	listener = new GamepadUSBHostListener();
+	((GamepadUSBHostListener*)listener)->setup();
+}
+
+void GamepadUSBHostAddon::preprocess() {
+	((GamepadUSBHostListener*)listener)->process();
+}
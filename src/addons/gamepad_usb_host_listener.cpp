@@ -0,0 +1,63 @@
+#include "addons/gamepad_usb_host_listener.h"
+#include "storagemanager.h"
+#include "class/hid/hid_host.h"
+
+#include <algorithm>
+
+void GamepadUSBHostListener::setup() {
+	const GamepadUSBHostOptions& gamepadUSBHostOptions = Storage::getInstance().getAddonOptions().gamepadUSBHostOptions;
+	_gamepad_host_merge_mode = gamepadUSBHostOptions.mergeMode;
+	// playerSlot is a uint32 in the config, clamp before it narrows so a large value cannot wrap into a valid slot
+	_gamepad_host_player_slot = std::min<uint32_t>(gamepadUSBHostOptions.playerSlot, USB_HOST_MAX_DEVICES - 1);
+}
+
+void GamepadUSBHostListener::process() {
+	GamepadState hostState;
+	_gamepad_host_slots.merge(hostState, _gamepad_host_merge_mode, _gamepad_host_player_slot);
+
+	// buttons add up, a host stick only moves ours while ours is centred, triggers take the deeper press
+	Gamepad *gamepad = Storage::getInstance().GetGamepad();
+	gamepad->state.dpad    |= hostState.dpad;
+	gamepad->state.buttons |= hostState.buttons;
+	if (gamepad->state.lx == GAMEPAD_JOYSTICK_MID && gamepad->state.ly == GAMEPAD_JOYSTICK_MID) {
+		gamepad->state.lx = hostState.lx;
+		gamepad->state.ly = hostState.ly;
+	}
+	if (gamepad->state.rx == GAMEPAD_JOYSTICK_MID && gamepad->state.ry == GAMEPAD_JOYSTICK_MID) {
+		gamepad->state.rx = hostState.rx;
+		gamepad->state.ry = hostState.ry;
+	}
+	if (hostState.lt > gamepad->state.lt)
+		gamepad->state.lt = hostState.lt;
+	if (hostState.rt > gamepad->state.rt)
+		gamepad->state.rt = hostState.rt;
+}
+
+void GamepadUSBHostListener::mount(uint8_t dev_addr, uint8_t instance, uint8_t const* desc_report, uint16_t desc_len) {
+	// keyboards and mice announce a boot protocol, controllers do not
+	if (tuh_hid_interface_protocol(dev_addr, instance) != HID_ITF_PROTOCOL_NONE)
+		return;
+
+	int8_t slot = _gamepad_host_slots.claim(dev_addr, instance);
+	if (slot < 0)
+		return; // every slot is taken
+
+	// the descriptor is only valid during this callback, everything needed later goes into the plan
+	if (!_gamepad_host_decoders[slot].compile(desc_report, desc_len))
+		_gamepad_host_slots.release(slot);
+}
+
+void GamepadUSBHostListener::unmount(uint8_t dev_addr) {
+	_gamepad_host_slots.releaseDevice(dev_addr);
+}
+
+void GamepadUSBHostListener::report_received(uint8_t dev_addr, uint8_t instance, uint8_t const* report, uint16_t len) {
+	int8_t slot = _gamepad_host_slots.find(dev_addr, instance);
+	if (slot < 0)
+		return;
+
+	// reports with other IDs (DS4 feature data, vendor reports) are skipped and leave the last state in place
+	GamepadState hostState;
+	if (_gamepad_host_decoders[slot].decode(report, len, hostState))
+		_gamepad_host_slots.publish(slot, hostState);
+}
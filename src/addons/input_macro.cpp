@@ -3,6 +3,7 @@
 #include "GamepadState.h"
 
 #include "hardware/gpio.h"
+#include "hardware/sync.h"
 
 bool InputMacro::available() {
     // Macro Button initialized by void Gamepad::setup()
@@ -26,38 +27,6 @@ bool InputMacro::available() {
 }
 
 void InputMacro::setup() {
-    GpioAction* pinMappings = Storage::getInstance().getProfilePinMappings();
-    macroButtonMask = 0;
-    memset(macroPinMasks, 0, sizeof(macroPinMasks));
-    for (Pin_t pin = 0; pin < (Pin_t)NUM_BANK0_GPIOS; pin++)
-    {
-        switch( pinMappings[pin] ) {
-            case GpioAction::BUTTON_PRESS_MACRO:
-                macroButtonMask = 1 << pin;
-                break;
-            case GpioAction::BUTTON_PRESS_MACRO_1:
-                macroPinMasks[0] = 1 << pin;
-                break;
-            case GpioAction::BUTTON_PRESS_MACRO_2:
-                macroPinMasks[1] = 1 << pin;
-                break;
-            case GpioAction::BUTTON_PRESS_MACRO_3:
-                macroPinMasks[2] = 1 << pin;
-                break;
-            case GpioAction::BUTTON_PRESS_MACRO_4:
-                macroPinMasks[3] = 1 << pin;
-                break;
-            case GpioAction::BUTTON_PRESS_MACRO_5:
-                macroPinMasks[4] = 1 << pin;
-                break;
-            case GpioAction::BUTTON_PRESS_MACRO_6:
-                macroPinMasks[5] = 1 << pin;
-                break;
-            default:
-                break;
-        }
-    }
-
     inputMacroOptions = &Storage::getInstance().getAddonOptions().macroOptions;
     if (inputMacroOptions->macroBoardLedEnabled && isValidPin(BOARD_LED_PIN)) {
         gpio_init(BOARD_LED_PIN);
@@ -68,51 +37,161 @@ void InputMacro::setup() {
     }
     boardLedEnabled = false;
     prevMacroInputPressed = false;
+    stepAlarmId = 0;
     reset();
+    compileMacros();
 }
 
+/**
+ * @brief Build the trigger masks and the step table the interpreter runs from the pin mappings and macro list.
+ *
+ * Everything preprocess() and the step alarm would otherwise work out again on every run is done here once:
+ * which pins trigger which macro, the button/dpad split of every input and its hold and wait times.
+ */
+void InputMacro::compileMacros() {
+    GpioAction* pinMappings = Storage::getInstance().getProfilePinMappings();
+    uint32_t macroButtonMask = 0;
+    uint32_t macroPinMasks[MAX_MACRO_LIMIT] = {};
+    for (Pin_t pin = 0; pin < (Pin_t)NUM_BANK0_GPIOS; pin++)
+    {
+        if ( pinMappings[pin] == GpioAction::BUTTON_PRESS_MACRO ) {
+            macroButtonMask = 1 << pin;
+        } else if ( pinMappings[pin] >= GpioAction::BUTTON_PRESS_MACRO_1 &&
+                pinMappings[pin] <= GpioAction::BUTTON_PRESS_MACRO_6 ) {
+            macroPinMasks[pinMappings[pin] - GpioAction::BUTTON_PRESS_MACRO_1] = 1 << pin;
+        }
+    }
+
+    triggerPinMask = 0;
+    uint8_t stepCount = 0;
+    for (int i = 0; i < MAX_MACRO_LIMIT; i++) {
+        const Macro& macro = inputMacroOptions->macroList[i];
+        CompiledMacro& compiled = macros[i];
+        compiled.type = macro.macroType;
+        compiled.useTriggerButton = macro.useMacroTriggerButton;
+        compiled.triggerPins = !macro.enabled ? 0 : (macro.useMacroTriggerButton ? macroButtonMask : macroPinMasks[i]);
+        compiled.triggerButtons = macro.macroTriggerButton & 0xFFFF;
+        compiled.triggerDpad = (macro.macroTriggerButton >> 16) & 0xFF;
+        compiled.exclusive = !macro.interruptible && macro.exclusive;
+        compiled.interruptible = macro.interruptible;
+        compiled.firstStep = stepCount;
+        compiled.stepCount = 0;
+        triggerPinMask |= compiled.triggerPins;
+        if (!macro.enabled)
+            continue;
+
+        for (pb_size_t j = 0; j < macro.macroInputs_count && j < MAX_MACRO_INPUT_LIMIT; j++) {
+            const MacroInput& macroInput = macro.macroInputs[j];
+            MacroStep& step = macroSteps[stepCount++];
+            // GAMEPAD_MASK_DU... are the dpad masks moved up 16 bits, so the split is already in place
+            step.output = macroInput.buttonMask & (0xFFFF | (GAMEPAD_MASK_DPAD << 16));
+            // an input without a duration taps its buttons for one loop, with neither time set its slot still lasts a frame
+            step.holdUs = macroInput.duration;
+            step.waitUs = (macroInput.duration == 0 && macroInput.waitDuration == 0) ? INPUT_HOLD_US : macroInput.waitDuration;
+            compiled.stepCount++;
+        }
+    }
+}
 
 void InputMacro::reset() {
+    // stop the step alarm before touching anything it uses
+    if (stepAlarmId > 0) {
+        cancel_alarm(stepAlarmId);
+        stepAlarmId = 0;
+    }
     macroPosition = -1;
     pressedMacro = -1;
     isMacroRunning = false;
-    macroStartTime = 0;
-    macroInputPosition = 0;
+    macroStep = 0;
+    isInputWaiting = false;
+    macroOverlay = 0;
+    macroTap = 0;
+    isMacroFinished = false;
     isMacroTriggerHeld = false;
-    macroInputHoldTime = INPUT_HOLD_US;
     if (boardLedEnabled) {
         gpio_put(BOARD_LED_PIN, 0);
     }
 }
 
-void InputMacro::restart(Macro& macro) {
-    macroStartTime = currentMicros;
-    macroInputPosition = 0;
-    MacroInput& newMacroInput = macro.macroInputs[macroInputPosition];
-    uint32_t newMacroInputDuration = newMacroInput.duration + newMacroInput.waitDuration;
-    macroInputHoldTime = newMacroInputDuration <= 0 ? INPUT_HOLD_US : newMacroInputDuration;
+/**
+ * @brief Start the steps of the macro at macroPosition on a hardware alarm.
+ *
+ * The step timing does not depend on when the loop gets to preprocess(): the alarm moves through the
+ * steps and publishes the output to hold in macroOverlay, preprocess() only merges it in.
+ */
+void InputMacro::start() {
+    macroStep = macros[macroPosition].firstStep;
+    isMacroFinished = false;
+    uint32_t length = startInput();
+    // keep the alarm interrupt off until the id is stored, otherwise a callback that finishes
+    // the macro first would leave a stale id behind for reset() to cancel
+    uint32_t interrupts = save_and_disable_interrupts();
+    stepAlarmId = add_alarm_in_us(length, stepAlarm, this, true);
+    restore_interrupts(interrupts);
+    if (stepAlarmId < 0) {
+        stepAlarmId = 0;
+        reset(); // no free alarm, drop the macro rather than hold its first input forever
+    }
+}
+
+// Hold the output of macroStep, returns how long for
+uint32_t InputMacro::startInput() {
+    const MacroStep& step = macroSteps[macroStep];
+    isInputWaiting = (step.holdUs == 0);
+    macroOverlay = isInputWaiting ? 0 : step.output;
+    if (isInputWaiting) {
+        macroTap |= step.output; // no duration: pressed for one loop, as when preprocess() timed the steps
+    }
+    return isInputWaiting ? step.waitUs : step.holdUs;
+}
+
+// Move from the hold to the wait of the current step, or on to the next step. 0 = macro finished
+uint32_t InputMacro::nextStep() {
+    const MacroStep& step = macroSteps[macroStep];
+    if (!isInputWaiting && step.waitUs > 0) {
+        isInputWaiting = true;
+        macroOverlay = 0;
+        return step.waitUs;
+    }
+
+    const CompiledMacro& macro = macros[macroPosition];
+    if (++macroStep >= macro.firstStep + macro.stepCount) {
+        if (macro.type == ON_PRESS) {
+            macroOverlay = 0;
+            isMacroFinished = true; // On press = no more macro
+            return 0;
+        }
+        macroStep = macro.firstStep; // On Hold-Repeat or On Toggle = start macro again
+    }
+    return startInput();
+}
+
+/**
+ * @brief Step alarm callback, rescheduled from when it was due so late callbacks do not stretch the macro.
+ */
+int64_t InputMacro::stepAlarm(alarm_id_t id, void * user) {
+    InputMacro * inputMacro = (InputMacro *)user;
+    uint32_t length = inputMacro->nextStep();
+    if (length == 0)
+        inputMacro->stepAlarmId = 0; // not rescheduled, the id is free again
+    return -(int64_t)length;
 }
 
 void InputMacro::checkMacroPress() {
     Gamepad * gamepad = Storage::getInstance().GetGamepad();
     Mask_t allPins = gamepad->debouncedGpio;
 
-    // Go through our macro list
     pressedMacro = -1;
+    if (!(allPins & triggerPinMask))
+        return;
+
+    // Go through our macro list, in order, the first one triggered wins
     for(int i = 0; i < MAX_MACRO_LIMIT; i++) {
-        if ( inputMacroOptions->macroList[i].enabled == false ) // Skip disabled macros
+        const CompiledMacro& macro = macros[i];
+        if (!(allPins & macro.triggerPins))
             continue;
-        Macro * macro = &inputMacroOptions->macroList[i];
-        if ( macro->useMacroTriggerButton ) {
-            // Use Gamepad Button for Macro Trigger
-            if ((allPins & macroButtonMask) &&
-                ((gamepad->state.buttons & macro->macroTriggerButton) ||
-                    (gamepad->state.dpad & (macro->macroTriggerButton >> 16))) ) {
-                pressedMacro = i;
-                break;
-            }
-        } else if ( allPins & macroPinMasks[i] ) {
-            // Use Pin Manager for Macro Trigger
+        if (!macro.useTriggerButton ||
+                (gamepad->state.buttons & macro.triggerButtons) || (gamepad->state.dpad & macro.triggerDpad)) {
             pressedMacro = i;
             break;
         }
@@ -130,15 +209,16 @@ void InputMacro::checkMacroAction() {
     bool newPress = macroInputPressed && (prevMacroInputPressed ^ macroInputPressed);
 
     // Check to see if we should change the current macro (or turn off based on input)
-    if ( inputMacroOptions->macroList[macroPosition].macroType == ON_PRESS ) {
+    if ( macroPosition == -1 ) {
+        isMacroTriggerHeld = false; // nothing pressed and nothing running
+    } else if ( macros[macroPosition].type == ON_PRESS ) {
         // START Macro: On Press or On Hold Repeat
         if (!isMacroRunning ) {
             isMacroTriggerHeld = newPress;
         }
-    } else if ( inputMacroOptions->macroList[macroPosition].macroType == ON_HOLD_REPEAT ) {
+    } else if ( macros[macroPosition].type == ON_HOLD_REPEAT ) {
         isMacroTriggerHeld = macroInputPressed;
-    } else if ( inputMacroOptions->macroList[macroPosition].macroType == ON_TOGGLE ) {
-        //isMacroTriggerHeld = macroInputPressed;
+    } else if ( macros[macroPosition].type == ON_TOGGLE ) {
         if (!isMacroRunning ) {
             isMacroTriggerHeld = newPress;
         } else if (isMacroRunning && newPress) {
@@ -150,15 +230,11 @@ void InputMacro::checkMacroAction() {
     }
 
     prevMacroInputPressed = macroInputPressed;
-    if (!isMacroRunning && isMacroTriggerHeld) {
+    if (!isMacroRunning && isMacroTriggerHeld && macros[pressedMacro].stepCount > 0) {
         // New Macro to run
         macroPosition = pressedMacro; // Set current macro
-        Macro& macro = inputMacroOptions->macroList[macroPosition];
-        MacroInput& macroInput = macro.macroInputs[macroInputPosition];
-        uint32_t macroInputDuration = macroInput.duration + macroInput.waitDuration;
-        macroInputHoldTime = macroInputDuration <= 0 ? INPUT_HOLD_US : macroInputDuration;
         isMacroRunning = true;
-        macroStartTime = getMicro(); // current time
+        start();
     }
 }
 
@@ -168,28 +244,29 @@ void InputMacro::runCurrentMacro() {
             macroPosition == -1)
         return;
 
-    Macro& macro = inputMacroOptions->macroList[macroPosition];
+    const CompiledMacro& macro = macros[macroPosition];
+
+    // Finished is read first: a tap the last input set before it is then already in macroTap
+    bool finished = isMacroFinished;
+    uint32_t tap = macroTap.exchange(0);
 
-    // Stop Macro if released (ON PRESS & ON HOLD REPEAT)
-    if (inputMacroOptions->macroList[macroPosition].macroType == ON_HOLD_REPEAT &&
-            !isMacroTriggerHeld ) {
+    // Stop Macro if released (ON PRESS & ON HOLD REPEAT), or when an ON PRESS macro ran out of inputs and sent its last tap
+    if ((macro.type == ON_HOLD_REPEAT && !isMacroTriggerHeld) || (finished && tap == 0)) {
         reset();
         return;
     }
 
-    MacroInput& macroInput = macro.macroInputs[macroInputPosition];
     Gamepad * gamepad = Storage::getInstance().GetGamepad();
-    currentMicros = getMicro();
 
-    if (!macro.interruptible && macro.exclusive) {
+    if (macro.exclusive) {
         // Prevent any other inputs from modifying our input (Exclusive)
         gamepad->state.dpad = 0;
         gamepad->state.buttons = 0;
     } else {
-        if (macro.useMacroTriggerButton) {
+        if (macro.useTriggerButton) {
             // Remove the trigger button from the input state
-            gamepad->state.dpad &= ~(macro.macroTriggerButton >> 16);
-            gamepad->state.buttons &= ~macro.macroTriggerButton;
+            gamepad->state.dpad &= ~macro.triggerDpad;
+            gamepad->state.buttons &= ~macro.triggerButtons;
         }
         if (macro.interruptible &&
             (gamepad->state.buttons != 0 || gamepad->state.dpad != 0)) {
@@ -199,46 +276,21 @@ void InputMacro::runCurrentMacro() {
         }
     }
 
-    // Have we elapsed the input hold time?
-    if ((currentMicros - macroStartTime) >= macroInputHoldTime) {
-        macroStartTime = currentMicros;
-        macroInputPosition++;
-        
-        if (macroInputPosition >= (macro.macroInputs_count)) {
-            if ( macro.macroType == ON_PRESS ) {
-                reset(); // On press = no more macro
-            } else {
-                restart(macro); // On Hold-Repeat or On Toggle = start macro again
-            }
-        } else {
-            MacroInput& newMacroInput = macro.macroInputs[macroInputPosition];
-            uint32_t newMacroInputDuration = newMacroInput.duration + newMacroInput.waitDuration;
-            macroInputHoldTime = newMacroInputDuration <= 0 ? INPUT_HOLD_US : newMacroInputDuration;
-        }
-    }
-
-    // Check if we should still hold this macro input based on duration
-    if ((currentMicros - macroStartTime) <= macroInput.duration) {
-        uint32_t buttonMask = macroInput.buttonMask;
-        if (buttonMask & GAMEPAD_MASK_DU) {
-            gamepad->state.dpad |= GAMEPAD_MASK_UP;
-        }
-        if (buttonMask & GAMEPAD_MASK_DD) {
-            gamepad->state.dpad |= GAMEPAD_MASK_DOWN;
-        }
-        if (buttonMask & GAMEPAD_MASK_DL) {
-            gamepad->state.dpad |= GAMEPAD_MASK_LEFT;
-        }
-        if (buttonMask & GAMEPAD_MASK_DR) {
-            gamepad->state.dpad |= GAMEPAD_MASK_RIGHT;
-        }
-        gamepad->state.buttons |= buttonMask;
+    // Hold whatever the step alarm says the current input holds (wait-timers hold nothing)
+    uint32_t output = macroOverlay | tap;
+    if (output != 0) {
+        gamepad->state.buttons |= output & 0xFFFF;
+        gamepad->state.dpad |= output >> 16;
 
         // Macro LED is on if we're currently running and inputs are doing something (wait-timers turn it off)
         if (boardLedEnabled) {
             gpio_put(BOARD_LED_PIN, (gamepad->state.dpad || gamepad->state.buttons) ? 1 : 0);
         }
     }
+
+    if (finished) {
+        reset(); // the last tap is in this report
+    }
 }
 
 void InputMacro::preprocess()
@@ -253,35 +305,7 @@ void InputMacro::preprocess()
 }
 
 void InputMacro::reinit() {
-    GpioAction* pinMappings = Storage::getInstance().getProfilePinMappings();
-    macroButtonMask = 0;
-    memset(macroPinMasks, 0, sizeof(macroPinMasks));
-    for (Pin_t pin = 0; pin < (Pin_t)NUM_BANK0_GPIOS; pin++)
-    {
-        switch( pinMappings[pin] ) {
-            case GpioAction::BUTTON_PRESS_MACRO:
-                macroButtonMask = 1 << pin;
-                break;
-            case GpioAction::BUTTON_PRESS_MACRO_1:
-                macroPinMasks[0] = 1 << pin;
-                break;
-            case GpioAction::BUTTON_PRESS_MACRO_2:
-                macroPinMasks[1] = 1 << pin;
-                break;
-            case GpioAction::BUTTON_PRESS_MACRO_3:
-                macroPinMasks[2] = 1 << pin;
-                break;
-            case GpioAction::BUTTON_PRESS_MACRO_4:
-                macroPinMasks[3] = 1 << pin;
-                break;
-            case GpioAction::BUTTON_PRESS_MACRO_5:
-                macroPinMasks[4] = 1 << pin;
-                break;
-            case GpioAction::BUTTON_PRESS_MACRO_6:
-                macroPinMasks[5] = 1 << pin;
-                break;
-            default:
-                break;
-        }
-    }
+    // the running macro indexes the tables about to be rebuilt
+    reset();
+    compileMacros();
 }
@@ -43,44 +43,45 @@ void KeyboardHostListener::setup() {
   _keyboard_host_mapButtonR3.setKey(keyboardMapping.keyButtonR3);
   _keyboard_host_mapButtonA1.setKey(keyboardMapping.keyButtonA1);
   _keyboard_host_mapButtonA2.setKey(keyboardMapping.keyButtonA2);
-
-  _keyboard_host_enabled = false;
 }
 
 void KeyboardHostListener::process() {
+  // every key pressed on any keyboard counts
+  GamepadState hostState;
+  _keyboard_host_slots.merge(hostState, HOST_MERGE_OR, 0);
+
   Gamepad *gamepad = Storage::getInstance().GetGamepad();
-  gamepad->state.dpad     |= _keyboard_host_state.dpad;
-  gamepad->state.buttons  |= _keyboard_host_state.buttons;
-  gamepad->state.lx       |= _keyboard_host_state.lx;
-  gamepad->state.ly       |= _keyboard_host_state.ly;
-  gamepad->state.rx       |= _keyboard_host_state.rx;
-  gamepad->state.ry       |= _keyboard_host_state.ry;
+  gamepad->state.dpad     |= hostState.dpad;
+  gamepad->state.buttons  |= hostState.buttons;
+  gamepad->state.lx       |= hostState.lx;
+  gamepad->state.ly       |= hostState.ly;
+  gamepad->state.rx       |= hostState.rx;
+  gamepad->state.ry       |= hostState.ry;
   if (!gamepad->hasAnalogTriggers) {
-    gamepad->state.lt       |= _keyboard_host_state.lt;
-    gamepad->state.rt       |= _keyboard_host_state.rt;
+    gamepad->state.lt       |= hostState.lt;
+    gamepad->state.rt       |= hostState.rt;
   }
 }
 
 void KeyboardHostListener::mount(uint8_t dev_addr, uint8_t instance, uint8_t const* desc_report, uint16_t desc_len) {
-  _keyboard_host_enabled = true;
+  // Interface protocol (hid_interface_protocol_enum_t)
+  if (tuh_hid_interface_protocol(dev_addr, instance) != HID_ITF_PROTOCOL_KEYBOARD)
+    return;
+
+  _keyboard_host_slots.claim(dev_addr, instance);
 }
 
 void KeyboardHostListener::unmount(uint8_t dev_addr) {
-  _keyboard_host_enabled = false;
+  _keyboard_host_slots.releaseDevice(dev_addr);
 }
 
 void KeyboardHostListener::report_received(uint8_t dev_addr, uint8_t instance, uint8_t const* report, uint16_t len){
-  if ( _keyboard_host_enabled == false )
-    return; // do nothing if we haven't mounted
-
-  // Interface protocol (hid_interface_protocol_enum_t)
-  uint8_t const itf_protocol = tuh_hid_interface_protocol(dev_addr, instance);
-
-  // tuh_hid_report_received_cb() will be invoked when report is available
-  if (itf_protocol != HID_ITF_PROTOCOL_KEYBOARD)
+  // only keyboards that got a slot at mount
+  int8_t slot = _keyboard_host_slots.find(dev_addr, instance);
+  if ( slot < 0 )
     return;
 
-  process_kbd_report(dev_addr, (hid_keyboard_report_t const*) report );
+  process_kbd_report(slot, (hid_keyboard_report_t const*) report );
 }
 
 uint8_t KeyboardHostListener::getKeycodeFromModifier(uint8_t modifier) {
@@ -99,21 +100,22 @@ uint8_t KeyboardHostListener::getKeycodeFromModifier(uint8_t modifier) {
 }
 
 // convert hid keycode to ascii and print via usb device CDC (ignore non-printable)
-void KeyboardHostListener::process_kbd_report(uint8_t dev_addr, hid_keyboard_report_t const *report)
+void KeyboardHostListener::process_kbd_report(int8_t slot, hid_keyboard_report_t const *report)
 {
   uint16_t joystickMid = GAMEPAD_JOYSTICK_MID;
   if ( DriverManager::getInstance().getDriver() != nullptr ) {
     joystickMid = DriverManager::getInstance().getDriver()->GetJoystickMidValue();
   }
 
-  _keyboard_host_state.dpad = 0;
-  _keyboard_host_state.buttons = 0;
-  _keyboard_host_state.lx = joystickMid;
-  _keyboard_host_state.ly = joystickMid;
-  _keyboard_host_state.rx = joystickMid;
-  _keyboard_host_state.ry = joystickMid;
-  _keyboard_host_state.lt = 0;
-  _keyboard_host_state.rt = 0;
+  GamepadState keyboardState;
+  keyboardState.dpad = 0;
+  keyboardState.buttons = 0;
+  keyboardState.lx = joystickMid;
+  keyboardState.ly = joystickMid;
+  keyboardState.rx = joystickMid;
+  keyboardState.ry = joystickMid;
+  keyboardState.lt = 0;
+  keyboardState.rt = 0;
 
   // make this 13 instead of 7 to include modifier bitfields from hid_keyboard_modifier_bm_t
   for(uint8_t i=0; i<13; i++)
@@ -130,29 +132,31 @@ void KeyboardHostListener::process_kbd_report(uint8_t dev_addr, hid_keyboard_rep
     }
     if ( keycode )
     {
-      _keyboard_host_state.dpad |=
-            ((keycode == _keyboard_host_mapDpadUp.key)    ? _keyboard_host_mapDpadUp.buttonMask : _keyboard_host_state.dpad)
-          | ((keycode == _keyboard_host_mapDpadDown.key)  ? _keyboard_host_mapDpadDown.buttonMask : _keyboard_host_state.dpad)
-          | ((keycode == _keyboard_host_mapDpadLeft.key)  ? _keyboard_host_mapDpadLeft.buttonMask  : _keyboard_host_state.dpad)
-          | ((keycode == _keyboard_host_mapDpadRight.key) ? _keyboard_host_mapDpadRight.buttonMask : _keyboard_host_state.dpad)
+      keyboardState.dpad |=
+            ((keycode == _keyboard_host_mapDpadUp.key)    ? _keyboard_host_mapDpadUp.buttonMask : keyboardState.dpad)
+          | ((keycode == _keyboard_host_mapDpadDown.key)  ? _keyboard_host_mapDpadDown.buttonMask : keyboardState.dpad)
+          | ((keycode == _keyboard_host_mapDpadLeft.key)  ? _keyboard_host_mapDpadLeft.buttonMask  : keyboardState.dpad)
+          | ((keycode == _keyboard_host_mapDpadRight.key) ? _keyboard_host_mapDpadRight.buttonMask : keyboardState.dpad)
         ;
 
-        _keyboard_host_state.buttons |=
-            ((keycode == _keyboard_host_mapButtonB1.key)  ? _keyboard_host_mapButtonB1.buttonMask  : _keyboard_host_state.buttons)
-          | ((keycode == _keyboard_host_mapButtonB2.key)  ? _keyboard_host_mapButtonB2.buttonMask  : _keyboard_host_state.buttons)
-          | ((keycode == _keyboard_host_mapButtonB3.key)  ? _keyboard_host_mapButtonB3.buttonMask  : _keyboard_host_state.buttons)
-          | ((keycode == _keyboard_host_mapButtonB4.key)  ? _keyboard_host_mapButtonB4.buttonMask  : _keyboard_host_state.buttons)
-          | ((keycode == _keyboard_host_mapButtonL1.key)  ? _keyboard_host_mapButtonL1.buttonMask  : _keyboard_host_state.buttons)
-          | ((keycode == _keyboard_host_mapButtonR1.key)  ? _keyboard_host_mapButtonR1.buttonMask  : _keyboard_host_state.buttons)
-          | ((keycode == _keyboard_host_mapButtonL2.key)  ? _keyboard_host_mapButtonL2.buttonMask  : _keyboard_host_state.buttons)
-          | ((keycode == _keyboard_host_mapButtonR2.key)  ? _keyboard_host_mapButtonR2.buttonMask  : _keyboard_host_state.buttons)
-          | ((keycode == _keyboard_host_mapButtonS1.key)  ? _keyboard_host_mapButtonS1.buttonMask  : _keyboard_host_state.buttons)
-          | ((keycode == _keyboard_host_mapButtonS2.key)  ? _keyboard_host_mapButtonS2.buttonMask  : _keyboard_host_state.buttons)
-          | ((keycode == _keyboard_host_mapButtonL3.key)  ? _keyboard_host_mapButtonL3.buttonMask  : _keyboard_host_state.buttons)
-          | ((keycode == _keyboard_host_mapButtonR3.key)  ? _keyboard_host_mapButtonR3.buttonMask  : _keyboard_host_state.buttons)
-          | ((keycode == _keyboard_host_mapButtonA1.key)  ? _keyboard_host_mapButtonA1.buttonMask  : _keyboard_host_state.buttons)
-          | ((keycode == _keyboard_host_mapButtonA2.key)  ? _keyboard_host_mapButtonA2.buttonMask  : _keyboard_host_state.buttons)
+        keyboardState.buttons |=
+            ((keycode == _keyboard_host_mapButtonB1.key)  ? _keyboard_host_mapButtonB1.buttonMask  : keyboardState.buttons)
+          | ((keycode == _keyboard_host_mapButtonB2.key)  ? _keyboard_host_mapButtonB2.buttonMask  : keyboardState.buttons)
+          | ((keycode == _keyboard_host_mapButtonB3.key)  ? _keyboard_host_mapButtonB3.buttonMask  : keyboardState.buttons)
+          | ((keycode == _keyboard_host_mapButtonB4.key)  ? _keyboard_host_mapButtonB4.buttonMask  : keyboardState.buttons)
+          | ((keycode == _keyboard_host_mapButtonL1.key)  ? _keyboard_host_mapButtonL1.buttonMask  : keyboardState.buttons)
+          | ((keycode == _keyboard_host_mapButtonR1.key)  ? _keyboard_host_mapButtonR1.buttonMask  : keyboardState.buttons)
+          | ((keycode == _keyboard_host_mapButtonL2.key)  ? _keyboard_host_mapButtonL2.buttonMask  : keyboardState.buttons)
+          | ((keycode == _keyboard_host_mapButtonR2.key)  ? _keyboard_host_mapButtonR2.buttonMask  : keyboardState.buttons)
+          | ((keycode == _keyboard_host_mapButtonS1.key)  ? _keyboard_host_mapButtonS1.buttonMask  : keyboardState.buttons)
+          | ((keycode == _keyboard_host_mapButtonS2.key)  ? _keyboard_host_mapButtonS2.buttonMask  : keyboardState.buttons)
+          | ((keycode == _keyboard_host_mapButtonL3.key)  ? _keyboard_host_mapButtonL3.buttonMask  : keyboardState.buttons)
+          | ((keycode == _keyboard_host_mapButtonR3.key)  ? _keyboard_host_mapButtonR3.buttonMask  : keyboardState.buttons)
+          | ((keycode == _keyboard_host_mapButtonA1.key)  ? _keyboard_host_mapButtonA1.buttonMask  : keyboardState.buttons)
+          | ((keycode == _keyboard_host_mapButtonA2.key)  ? _keyboard_host_mapButtonA2.buttonMask  : keyboardState.buttons)
         ;
     }
   }
-}
\ No newline at end of file
+
+  _keyboard_host_slots.publish(slot, keyboardState);
+}
@@ -1,6 +1,5 @@
 #include "addons/playernum.h"
 #include "storagemanager.h"
-#include "system.h"
 #include "helper.h"
 #include "config.pb.h"
 #include "device/usbd.h"
@@ -38,12 +37,19 @@ void PlayerNumAddon::setup() {
     if ( playerNum < 1 || playerNum > 4 ) {
         playerNum = 1; // error checking, set to 1 if we're off
     }
-    assigned = 0; // what player ID did we get assigned to
+    state = PLAYERNUM_WAITING;
+    attempts = 0;
 }
 
 void PlayerNumAddon::process()
 {
-    if ( assigned == 0 ) {
+    if ( state == PLAYERNUM_DISCONNECTED ) {
+        if ( time_reached(reconnectTime) ) {
+            Storage::getInstance().GetFeatureData()[0] = 0; // forget the LED report from the last connection
+            tud_connect();
+            state = PLAYERNUM_WAITING;
+        }
+    } else if ( state == PLAYERNUM_WAITING ) {
         Gamepad * gamepad = Storage::getInstance().GetGamepad();
         InputMode inputMode = static_cast<InputMode>(gamepad->getOptions().inputMode);
         if ( inputMode == INPUT_MODE_XINPUT ) {
@@ -60,17 +66,26 @@ void PlayerNumAddon::process()
                     handleLED(4);
             }
         } else {
-            assigned = 1;
+            state = PLAYERNUM_ASSIGNED;
         }
     }
 }
 
+/**
+ * @brief Act on the player slot the host assigned.
+ *
+ * XInput hosts hand out the lowest free slot, so a controller in the wrong one drops off the bus and
+ * comes back later, staggered by player number so lower players get to claim their slots first. Each
+ * retry waits longer. This all runs from process(), so the rest of the firmware keeps running.
+ */
 void PlayerNumAddon::handleLED(int num) {
-    if ( playerNum != num ) {
-        tud_disconnect();
-        sleep_ms(2000 * playerNum);
-        System::reboot(System::BootMode::GAMEPAD);
-    } else {
-        assigned = 1;
+    if ( playerNum == num || attempts >= PLAYERNUM_MAX_ATTEMPTS ) {
+        state = PLAYERNUM_ASSIGNED;
+        return;
     }
+
+    attempts++;
+    tud_disconnect();
+    reconnectTime = make_timeout_time_ms(PLAYERNUM_DISCONNECT_MS + PLAYERNUM_RECONNECT_MS * (playerNum - 1) * attempts);
+    state = PLAYERNUM_DISCONNECTED;
 }
@@ -12,7 +12,6 @@
 #define TURBO_SHOT_MIN 2
 #define TURBO_SHOT_MAX 30
 #define TURBO_DIAL_INCREMENTS (0xFFF / (TURBO_SHOT_MAX - TURBO_SHOT_MIN)) // 12-bit ADC
-#define TURBO_LOOP_OFFSET 50 // Extra time to compensate for loop runtime variance, turbo lags a bit otherwise
 
 #ifndef TURBO_LED_STATE_OFF
 #define TURBO_LED_STATE_OFF 0
@@ -102,7 +101,22 @@ void TurboInput::setup()
     lastDpad = 0;
     bTurboFlicker = false;
     updateInterval(shotCount);
-    nextTimer = getMicro();
+
+    // The flicker runs off a hardware alarm so its cadence does not depend on how often the loop gets here
+    flickerAlarmId = add_alarm_in_us(uIntervalUS, flickerAlarm, this, true);
+}
+
+/**
+ * @brief Toggle the turbo flicker.
+ *
+ * Returning a negative delay reschedules relative to when this alarm was due rather than when it ran,
+ * so late callbacks (flash writes, other interrupts) do not accumulate into drift.
+ */
+int64_t TurboInput::flickerAlarm(alarm_id_t id, void * user)
+{
+    TurboInput * turbo = (TurboInput *)user;
+    turbo->bTurboFlicker.store(!turbo->bTurboFlicker.load());
+    return -(int64_t)turbo->uIntervalUS.load();
 }
 
 /**
@@ -182,11 +196,8 @@ void TurboInput::process()
         nextAdcRead = now + 100000; // Sample every 100ms
     }
 
-    // Check if we've reached the next timer right before applying turbo state
-    if (nextTimer < now) {
-        bTurboFlicker ^= true;
-        nextTimer = now + uIntervalUS - TURBO_LOOP_OFFSET;
-    }
+    // Sample the alarm driven flicker once so the LED and the buttons agree
+    bool flicker = bTurboFlicker.load();
 
     // Set TURBO LED
     // OFF: No turbo buttons enabled
@@ -196,7 +207,7 @@ void TurboInput::process()
         // Turbo toggled on
         if (turboButtonsMask) {
             if (gamepad->state.buttons & turboButtonsMask)
-                gpio_put(options.ledPin, bTurboFlicker ? TURBO_LED_STATE_ON : TURBO_LED_STATE_OFF);
+                gpio_put(options.ledPin, flicker ? TURBO_LED_STATE_ON : TURBO_LED_STATE_OFF);
             else
                 gpio_put(options.ledPin, TURBO_LED_STATE_ON);
         }
@@ -214,7 +225,7 @@ void TurboInput::process()
     }
 
     // Disable button during turbo flicker
-    if (bTurboFlicker) {
+    if (flicker) {
         if ( options.shmupModeEnabled && options.shmupMixMode == SHMUP_MIX_MODE_CHARGE_PRIORITY) {
             gamepad->state.buttons &= ~(turboButtonsMask & ~(chargeState));  // Do not flicker charge buttons
         } else {
@@ -234,7 +245,7 @@ void TurboInput::updateTurboShotCount(uint8_t shotCount)
     shotCount = std::clamp<uint8_t>(shotCount, TURBO_SHOT_MIN, TURBO_SHOT_MAX);
     if (shotCount != options.shotCount) {
         options.shotCount = shotCount;
-        Storage::getInstance().save();
+        Storage::getInstance().enqueueSave(STORAGE_SECTION_ADDONS);
     }
     updateInterval(shotCount);
 }
@@ -21,6 +21,7 @@
 #include "addons/display.h"
 #include "addons/jslider.h"
 #include "addons/keyboard_host.h"
+#include "addons/gamepad_usb_host.h"
 #include "addons/neopicoleds.h"
 #include "addons/playernum.h"
 #include "addons/pleds.h"
@@ -38,9 +39,9 @@
 #include "FlashPROM.h"
 #include "configs/base64.h"
 
-#include <ArduinoJson.h>
-
+#include <algorithm>
 #include <cassert>
+#include <cstdio>
 #include <cstring>
 #include <memory>
 
@@ -733,6 +734,11 @@ void ConfigUtils::initUnsetPropertiesWithDefaults(Config& config)
     INIT_UNSET_PROPERTY(config.addonOptions.keyboardHostOptions.mapping, keyButtonA1, KEY_BUTTON_A1);
     INIT_UNSET_PROPERTY(config.addonOptions.keyboardHostOptions.mapping, keyButtonA2, KEY_BUTTON_A2);
 
+    // addonOptions.gamepadUSBHostOptions
+    INIT_UNSET_PROPERTY(config.addonOptions.gamepadUSBHostOptions, enabled, GAMEPAD_USB_HOST_ENABLED);
+    INIT_UNSET_PROPERTY(config.addonOptions.gamepadUSBHostOptions, mergeMode, GAMEPAD_USB_HOST_MERGE_MODE);
+    INIT_UNSET_PROPERTY(config.addonOptions.gamepadUSBHostOptions, playerSlot, GAMEPAD_USB_HOST_PLAYER_SLOT);
+
     // addonOptions.focusModeOptions
     INIT_UNSET_PROPERTY(config.addonOptions.focusModeOptions, enabled, !!FOCUS_MODE_ENABLED);
     INIT_UNSET_PROPERTY(config.addonOptions.focusModeOptions, pin, FOCUS_MODE_PIN);
@@ -1430,12 +1436,19 @@ static const uint32_t FOOTER_MAGIC = 0xd2f1e365;
     #error "Maximum size of Config cannot be determined statically, make sure that you do not use any dynamically sized arrays or strings"
 #endif
 
-static bool loadConfigInner(Config& config)
+// Decodes protobuf data that is followed by a ConfigFooter, `end` points behind the footer and `available` is the
+// number of bytes that may be read before it. Used for both the flash block and binary backups.
+static bool decodeConfigWithFooter(Config& config, const uint8_t* end, size_t available)
 {
     config = Config Config_init_zero;
 
-    const uint8_t* flashEnd = reinterpret_cast<const uint8_t*>(EEPROM_ADDRESS_START) + EEPROM_SIZE_BYTES;
-    const ConfigFooter& footer = *reinterpret_cast<const ConfigFooter*>(flashEnd - sizeof(ConfigFooter));
+    if (available < sizeof(ConfigFooter))
+    {
+        return false;
+    }
+
+    ConfigFooter footer;
+    memcpy(&footer, end - sizeof(ConfigFooter), sizeof(ConfigFooter));
 
     // Check for presence of magic value
     if (footer.magic != FOOTER_MAGIC)
@@ -1443,13 +1456,13 @@ static bool loadConfigInner(Config& config)
         return false;
     }
 
-        // Check if dataSize exceeds the reserved space
-    if (footer.dataSize + sizeof(ConfigFooter) > EEPROM_SIZE_BYTES)
+    // Check if dataSize exceeds the reserved space
+    if (footer.dataSize > available - sizeof(ConfigFooter))
     {
         return false;
     }
 
-    const uint8_t* dataPtr = flashEnd - sizeof(ConfigFooter) - footer.dataSize;
+    const uint8_t* dataPtr = end - sizeof(ConfigFooter) - footer.dataSize;
 
     // Verify CRC32 hash
     if (CRC32::calculate(dataPtr, footer.dataSize) != footer.dataCrc)
@@ -1462,25 +1475,22 @@ static bool loadConfigInner(Config& config)
     return pb_decode(&inputStream, Config_fields, &config);
 }
 
-void ConfigUtils::load(Config& config)
+static bool loadConfigInner(Config& config)
 {
-    // First try to load from Protobuf storage, if that fails fall back to legacy storage.
-    const bool loaded = loadConfigInner(config) | fromLegacyStorage(config);
-
-    if (!loaded)
-    {
-        // We could neither deserialize Protobuf config data nor legacy config data.
-        // We are probably dealing with a new device and therefore initialize the config to default values.
-        config = Config Config_init_default;
-    }
+    const uint8_t* flashEnd = reinterpret_cast<const uint8_t*>(EEPROM_ADDRESS_START) + EEPROM_SIZE_BYTES;
+    return decodeConfigWithFooter(config, flashEnd, EEPROM_SIZE_BYTES);
+}
 
+// Brings a freshly decoded config up to date with the running firmware
+static void migrateLoadedConfig(Config& config)
+{
     // run migrations
     if (!config.migrations.hotkeysMigrated)
         hotkeysMigration(config);
 
     // Make sure that fields that were not deserialized are properly initialized.
     // They were probably added with a newer version of the firmware.
-    initUnsetPropertiesWithDefaults(config);
+    ConfigUtils::initUnsetPropertiesWithDefaults(config);
 
     // Run migrations that need to happen after initUnset...
     // ProtoBuf && Board Config settings are loaded here
@@ -1503,6 +1513,21 @@ void ConfigUtils::load(Config& config)
     strncpy(config.boardVersion, GP2040VERSION, sizeof(config.boardVersion));
     config.boardVersion[sizeof(config.boardVersion) - 1] = '\0';
     config.has_boardVersion = true;
+}
+
+void ConfigUtils::load(Config& config)
+{
+    // First try to load from Protobuf storage, if that fails fall back to legacy storage.
+    const bool loaded = loadConfigInner(config) | fromLegacyStorage(config);
+
+    if (!loaded)
+    {
+        // We could neither deserialize Protobuf config data nor legacy config data.
+        // We are probably dealing with a new device and therefore initialize the config to default values.
+        config = Config Config_init_default;
+    }
+
+    migrateLoadedConfig(config);
 
     // Save, to make sure we persist any performed migration steps
     save(config);
@@ -1614,37 +1639,185 @@ bool ConfigUtils::save(Config& config)
     return true;
 }
 
+// Binary backups use the same layout as the flash block without the unused memory in front: the protobuf data
+// followed by its ConfigFooter. The export is produced window by window like toJSON, so it never needs a buffer
+// for the whole encoding.
+struct BinaryWindow
+{
+    uint8_t* buffer;
+    size_t offset;
+    size_t end;
+    size_t position;
+    CRC32 crc;
+};
+
+static void appendToWindow(BinaryWindow& window, const uint8_t* data, size_t count)
+{
+    if (window.buffer != nullptr && window.position < window.end && window.position + count > window.offset)
+    {
+        size_t skip = (window.position < window.offset) ? (window.offset - window.position) : 0;
+        size_t length = std::min(count - skip, window.end - (window.position + skip));
+        memcpy(window.buffer + (window.position + skip - window.offset), data + skip, length);
+    }
+    window.position += count;
+}
+
+static bool writeBinaryWindow(pb_ostream_t* stream, const pb_byte_t* buf, size_t count)
+{
+    BinaryWindow& window = *reinterpret_cast<BinaryWindow*>(stream->state);
+    window.crc.update(buf, count);
+    appendToWindow(window, buf, count);
+    return true;
+}
+
+size_t ConfigUtils::toBinary(const Config& config, uint8_t* buffer, size_t bufferSize, size_t offset)
+{
+    BinaryWindow window = { buffer, offset, offset + bufferSize, 0, CRC32() };
+    pb_ostream_t outputStream = {};
+    outputStream.callback = writeBinaryWindow;
+    outputStream.state = &window;
+    outputStream.max_size = SIZE_MAX;
+    if (!pb_encode(&outputStream, Config_fields, &config))
+    {
+        return 0;
+    }
+
+    ConfigFooter footer;
+    footer.dataSize = outputStream.bytes_written;
+    footer.dataCrc = window.crc.finalize();
+    footer.magic = FOOTER_MAGIC;
+    appendToWindow(window, reinterpret_cast<const uint8_t*>(&footer), sizeof(ConfigFooter));
+
+    if (buffer == nullptr)
+    {
+        return window.position;
+    }
+    return (window.position > offset) ? (std::min(window.position, window.end) - offset) : 0;
+}
+
+// The footer has to match the data exactly, afterwards the backup goes through the same migrations as a config
+// loaded from flash
+bool ConfigUtils::fromBinary(Config& config, const uint8_t* data, size_t dataLen)
+{
+    ConfigFooter footer;
+    if (dataLen < sizeof(ConfigFooter))
+    {
+        return false;
+    }
+    memcpy(&footer, data + dataLen - sizeof(ConfigFooter), sizeof(ConfigFooter));
+    if (footer.dataSize != dataLen - sizeof(ConfigFooter) || !decodeConfigWithFooter(config, data + dataLen, dataLen))
+    {
+        return false;
+    }
+
+    migrateLoadedConfig(config);
+
+    return true;
+}
+
 // -----------------------------------------------------
 // To JSON
 // -----------------------------------------------------
 
-static void writeIndentation(std::string& str, int level)
+// Writes the window [offset, offset + size) of the generated document into a fixed buffer, everything
+// before the window is only counted. Without a buffer nothing is written and the whole document is measured.
+class JsonWriter
 {
-    str.append(static_cast<std::string::size_type>(level), '\t');
+public:
+    JsonWriter(char* buffer, size_t size, size_t offset) :
+        buffer(buffer), offset(offset), end(offset + size), position(0) {}
+
+    // Once the window is filled the rest of the document can be skipped
+    bool full() const { return buffer != nullptr && position >= end; }
+
+    size_t length() const { return position; }
+    size_t written() const { return (position > offset) ? (std::min(position, end) - offset) : 0; }
+
+    void append(const char* data, size_t length)
+    {
+        if (buffer != nullptr && position < end && position + length > offset)
+        {
+            size_t skip = (position < offset) ? (offset - position) : 0;
+            size_t count = std::min(length - skip, end - (position + skip));
+            memcpy(buffer + (position + skip - offset), data + skip, count);
+        }
+        position += length;
+    }
+
+    void append(const char* str) { append(str, strlen(str)); }
+    void push_back(char c) { append(&c, 1); }
+
+    void append(size_t count, char c)
+    {
+        while (count-- > 0)
+            push_back(c);
+    }
+
+private:
+    char* buffer;
+    size_t offset;
+    size_t end;
+    size_t position;
+};
+
+static void writeIndentation(JsonWriter& str, int level)
+{
+    str.append(static_cast<size_t>(level), '\t');
 }
 
 // Don't inline this function, we do not want to consume stack space in the calling function
-static void __attribute__((noinline)) appendAsString(std::string& str, double value)
+static void __attribute__((noinline)) appendAsString(JsonWriter& str, double value)
 {
-    str.append(std::to_string(value));
+    char buffer[64];
+    int length = snprintf(buffer, sizeof(buffer), "%f", value);
+    if (length >= static_cast<int>(sizeof(buffer)))
+        str.append(std::to_string(value).c_str());
+    else if (length > 0)
+        str.append(buffer, length);
 }
 
 // Don't inline this function, we do not want to consume stack space in the calling function
-static void __attribute__((noinline)) appendAsString(std::string& str, float value)
+static void __attribute__((noinline)) appendAsString(JsonWriter& str, float value)
 {
-    str.append(std::to_string(value));
+    appendAsString(str, static_cast<double>(value));
 }
 
 // Don't inline this function, we do not want to consume stack space in the calling function
-static void __attribute__((noinline)) appendAsString(std::string& str, int32_t value)
+static void __attribute__((noinline)) appendAsString(JsonWriter& str, uint32_t value)
 {
-    str.append(std::to_string(value));
+    char buffer[10];
+    size_t pos = sizeof(buffer);
+    do
+    {
+        buffer[--pos] = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
+    str.append(&buffer[pos], sizeof(buffer) - pos);
 }
 
 // Don't inline this function, we do not want to consume stack space in the calling function
-static void __attribute__((noinline)) appendAsString(std::string& str, uint32_t value)
+static void __attribute__((noinline)) appendAsString(JsonWriter& str, int32_t value)
 {
-    str.append(std::to_string(value));
+    if (value < 0)
+    {
+        str.push_back('-');
+        appendAsString(str, static_cast<uint32_t>(0) - static_cast<uint32_t>(value));
+    }
+    else
+    {
+        appendAsString(str, static_cast<uint32_t>(value));
+    }
+}
+
+// Don't inline this function, we do not want to consume stack space in the calling function
+static void __attribute__((noinline)) appendAsBase64(JsonWriter& str, const uint8_t* data, size_t length)
+{
+    char encoded[4];
+    for (size_t i = 0; i < length && !str.full(); i += 3)
+    {
+        Base64::EncodeBlock(reinterpret_cast<const char*>(data + i), std::min<size_t>(3, length - i), encoded);
+        str.append(encoded, sizeof(encoded));
+    }
 }
 
 #define TO_JSON_ENUM(fieldname, submessageType) appendAsString(str, static_cast<int32_t>(s.fieldname));
@@ -1655,7 +1828,7 @@ static void __attribute__((noinline)) appendAsString(std::string& str, uint32_t
 #define TO_JSON_UINT32(fieldname, submessageType) appendAsString(str, s.fieldname);
 #define TO_JSON_BOOL(fieldname, submessageType) str.append((s.fieldname) ? "true" : "false");
 #define TO_JSON_STRING(fieldname, submessageType) str.push_back('"'); str.append(s.fieldname); str.push_back('"');
-#define TO_JSON_BYTES(fieldname, submessageType) str.push_back('"'); str.append(Base64::Encode(reinterpret_cast<const char*>(s.fieldname.bytes), s.fieldname.size)); str.push_back('"');
+#define TO_JSON_BYTES(fieldname, submessageType) str.push_back('"'); appendAsBase64(str, s.fieldname.bytes, s.fieldname.size); str.push_back('"');
 #define TO_JSON_MESSAGE(fieldname, submessageType) PREPROCESSOR_JOIN(toJSON, submessageType)(str, s.fieldname, indentLevel + 1);
 
 #define TO_JSON_REPEATED_ENUM(fieldname, submessageType) appendAsString(str, static_cast<int32_t>(s.fieldname[i]));
@@ -1702,11 +1875,12 @@ static void __attribute__((noinline)) appendAsString(std::string& str, uint32_t
         PREPROCESSOR_JOIN(TO_JSON_, atype)(htype, ltype, fieldname, parenttype ## _ ## fieldname ## _MSGTYPE) \
     }
 
-#define GEN_TO_JSON_FUNCTION_DECL(structtype) static void toJSON ## structtype(std::string& str, const structtype& s, int indentLevel);
+#define GEN_TO_JSON_FUNCTION_DECL(structtype) static void toJSON ## structtype(JsonWriter& str, const structtype& s, int indentLevel);
 
 #define GEN_TO_JSON_FUNCTION(structtype) \
-    static void toJSON ## structtype(std::string& str, const structtype& s, int indentLevel) \
+    static void toJSON ## structtype(JsonWriter& str, const structtype& s, int indentLevel) \
     { \
+        if (str.full()) return; \
         bool firstField = true; \
         str.append("{\n"); \
         structtype ## _FIELDLIST(TO_JSON_FIELD, structtype) \
@@ -1724,14 +1898,13 @@ static void __attribute__((noinline)) appendAsString(std::string& str, uint32_t
     ENUM_MESSAGES_GP2040(GEN_TO_JSON_FUNCTION)
 #endif
 
-std::string ConfigUtils::toJSON(const Config& config)
+size_t ConfigUtils::toJSON(const Config& config, char* buffer, size_t bufferSize, size_t offset)
 {
-    std::string str;
-    str.reserve(1024 * 4);
+    JsonWriter str(buffer, bufferSize, offset);
     toJSONConfig(str, config, 1);
     str.push_back('\n');
 
-    return str;
+    return (buffer != nullptr) ? str.written() : str.length();
 }
 
 // -----------------------------------------------------
@@ -1754,328 +1927,551 @@ std::string ConfigUtils::toJSON(const Config& config)
     ENUMS_ENUMS_GP2040(GEN_IS_VALID_ENUM_VALUE_FUNCTION)
 #endif
 
-#define FROM_JSON_ENUM(fieldname, enumType) \
-    if (jsonObject.containsKey(#fieldname)) \
-    { \
-        JsonVariantConst value = jsonObject[#fieldname]; \
-        if (value.is<int>()) \
-        { \
-            const int v = value.as<int>(); \
-            if (PREPROCESSOR_JOIN(isValid, PREPROCESSOR_JOIN(enumType, _ENUMTYPE))(v)) \
-            { \
-                configStruct.fieldname = static_cast<decltype(configStruct.fieldname)>(v); \
-                configStruct.PREPROCESSOR_JOIN(has_, fieldname) = true; \
-            } \
-            else \
-            { \
-                return false; \
-            } \
-        } \
-        else \
-        { \
-            return false; \
-        } \
-    }
-
-#define FROM_JSON_UENUM(fieldname, enumType) \
-    if (jsonObject.containsKey(#fieldname)) \
-    { \
-        JsonVariantConst value = jsonObject[#fieldname]; \
-        if (value.is<unsigned int>()) \
-        { \
-            const unsigned int v = value.as<unsigned int>(); \
-            if (PREPROCESSOR_JOIN(isValid, PREPROCESSOR_JOIN(enumType, _ENUMTYPE))(v)) \
-            { \
-                configStruct.fieldname = static_cast<decltype(configStruct.fieldname)>(v); \
-                configStruct.PREPROCESSOR_JOIN(has_, fieldname) = true; \
-            } \
-            else \
-            { \
-                return false; \
-            } \
-        } \
-        else \
-        { \
-            return false; \
-        } \
-    }
+// Pull parser over the raw request body. Values are parsed straight into the
+// config struct as the document is walked, so no DOM is ever built and memory
+// use does not grow with the size of the document.
+#define JSON_READER_MAX_DEPTH 10
+#define JSON_READER_MAX_KEY_LENGTH 64
+#define JSON_READER_MAX_NUMBER_LENGTH 32
 
-static bool fromJsonDouble(JsonObjectConst jsonObject, const char* fieldname, double& value, bool& flag)
+class JsonReader
 {
-    if (jsonObject.containsKey(fieldname))
+public:
+    JsonReader(const char* data, size_t length) :
+        position(data), end(data + length), depth(0), firstEntry(false), error(false), key() {}
+
+    bool failed() const { return error; }
+
+    bool isKey(const char* name) const { return strcmp(key, name) == 0; }
+
+    bool beginObject() { return beginContainer('{'); }
+    bool beginArray() { return beginContainer('['); }
+
+    // Advances to the next key of the current object, returns false once the object is closed
+    bool nextKey()
     {
-        JsonVariantConst jsonVariant = jsonObject[fieldname];
-        if (jsonVariant.is<double>())
+        if (!nextEntry('}'))
+            return false;
+
+        size_t length = 0;
+        bool truncated = false;
+        bool valid = readString([&](char c)
         {
-            value = jsonVariant.as<double>();
-            flag = true;
+            if (length + 1 < sizeof(key))
+                key[length++] = c;
+            else
+                truncated = true;
             return true;
-        }
-        else
-        {
-            return false;
-        }
-    }
+        });
+        // Overlong keys can't name a field, they are skipped like any other unknown key
+        key[truncated ? 0 : length] = '\0';
 
-    return true;
-}
+        if (!valid || !consume(':'))
+            return fail();
+        return true;
+    }
 
-#define FROM_JSON_DOUBLE(fieldname, submessageType) if (!fromJsonDouble(jsonObject, #fieldname, configStruct.fieldname, configStruct.PREPROCESSOR_JOIN(has_, fieldname))) { return false; }
+    // Advances to the next element of the current array, returns false once the array is closed
+    bool nextElement() { return nextEntry(']'); }
 
-static bool fromJsonFloat(JsonObjectConst jsonObject, const char* fieldname, float& value, bool& flag)
-{
-    if (jsonObject.containsKey(fieldname))
+    // Fails if the string (plus terminator) does not fit into the buffer
+    bool readString(char* buffer, size_t size)
     {
-        JsonVariantConst jsonVariant = jsonObject[fieldname];
-        if (jsonVariant.is<float>())
+        size_t length = 0;
+        bool valid = readString([&](char c)
         {
-            value = jsonVariant.as<float>();
-            flag = true;
+            if (length + 1 >= size)
+                return false;
+            buffer[length++] = c;
             return true;
-        }
-        else
+        });
+        if (!valid)
+            return false;
+        buffer[length] = '\0';
+        return true;
+    }
+
+    // Decodes a Base64 string group by group, the final group is held back until its padding is known
+    bool readBase64(uint8_t* bytes, uint16_t& size, size_t maxSize)
+    {
+        char group[4];
+        size_t groupLength = 0;
+        size_t length = 0;
+        bool pending = false;
+        char last[4];
+        bool valid = readString([&](char c)
         {
+            group[groupLength++] = c;
+            if (groupLength < 4)
+                return true;
+            groupLength = 0;
+            if (pending && !storeBase64Group(last, 3, bytes, length, maxSize))
+                return false;
+            memcpy(last, group, sizeof(last));
+            pending = true;
+            return true;
+        });
+        if (!valid)
             return false;
+
+        // Length of Base64 encoded data has to be divisible by 4
+        if (groupLength != 0)
+            return fail();
+
+        if (pending)
+        {
+            size_t count = 3;
+            if (last[3] == '=') --count;
+            if (last[2] == '=') --count;
+            if (!storeBase64Group(last, count, bytes, length, maxSize))
+                return fail();
         }
+        size = length;
+        return true;
     }
 
-    return true;
-}
+    bool readInt32(int32_t& value)
+    {
+        int64_t v;
+        if (!readInteger(v) || v < INT32_MIN || v > INT32_MAX)
+            return fail();
+        value = static_cast<int32_t>(v);
+        return true;
+    }
 
-#define FROM_JSON_FLOAT(fieldname, submessageType) if (!fromJsonFloat(jsonObject, #fieldname, configStruct.fieldname, configStruct.PREPROCESSOR_JOIN(has_, fieldname))) { return false; }
+    bool readUint32(uint32_t& value)
+    {
+        int64_t v;
+        if (!readInteger(v) || v < 0 || v > UINT32_MAX)
+            return fail();
+        value = static_cast<uint32_t>(v);
+        return true;
+    }
 
-static bool fromJsonInt32(JsonObjectConst jsonObject, const char* fieldname, int32_t& value, bool& flag)
-{
-    if (jsonObject.containsKey(fieldname))
+    bool readDouble(double& value)
     {
-        JsonVariantConst jsonVariant = jsonObject[fieldname];
-        if (jsonVariant.is<int>())
-        {
-            value = jsonVariant.as<int>();
-            flag = true;
-            return true;
-        }
-        else
-        {
+        char buffer[JSON_READER_MAX_NUMBER_LENGTH];
+        bool integer;
+        if (!readNumber(buffer, sizeof(buffer), integer))
             return false;
-        }
+        value = strtod(buffer, nullptr);
+        return true;
     }
 
-    return true;
-}
+    bool readFloat(float& value)
+    {
+        double v;
+        if (!readDouble(v))
+            return false;
+        value = static_cast<float>(v);
+        return true;
+    }
 
-#define FROM_JSON_INT32(fieldname, submessageType) if (!fromJsonInt32(jsonObject, #fieldname, configStruct.fieldname, configStruct.PREPROCESSOR_JOIN(has_, fieldname))) { return false; }
+    bool readBool(bool& value)
+    {
+        if (peek() == 't' && consumeLiteral("true"))
+            value = true;
+        else if (peek() == 'f' && consumeLiteral("false"))
+            value = false;
+        else
+            return fail();
+        return true;
+    }
 
-static bool fromJsonUint32(JsonObjectConst jsonObject, const char* fieldname, uint32_t& value, bool& flag)
-{
-    if (jsonObject.containsKey(fieldname))
+    // Unknown keys are walked over without storing anything
+    bool skipValue()
     {
-        JsonVariantConst jsonVariant = jsonObject[fieldname];
-        if (jsonVariant.is<unsigned int>())
+        switch (peek())
         {
-            value = jsonVariant.as<unsigned int>();
-            flag = true;
-            return true;
+            case '{':
+                if (!beginObject())
+                    return false;
+                while (nextKey())
+                {
+                    if (!skipValue())
+                        return false;
+                }
+                return !error;
+            case '[':
+                if (!beginArray())
+                    return false;
+                while (nextElement())
+                {
+                    if (!skipValue())
+                        return false;
+                }
+                return !error;
+            case '"':
+                return readString([](char) { return true; });
+            case 't':
+            case 'f':
+                {
+                    bool value;
+                    return readBool(value);
+                }
+            case 'n':
+                return consumeLiteral("null") || fail();
+            default:
+                {
+                    char buffer[JSON_READER_MAX_NUMBER_LENGTH];
+                    bool integer;
+                    return readNumber(buffer, sizeof(buffer), integer);
+                }
         }
-        else
-        {
+    }
+
+private:
+    bool fail()
+    {
+        error = true;
+        return false;
+    }
+
+    char peek()
+    {
+        while (position < end && (*position == ' ' || *position == '\t' || *position == '\n' || *position == '\r'))
+            ++position;
+        return (position < end) ? *position : '\0';
+    }
+
+    bool consume(char c)
+    {
+        if (peek() != c)
             return false;
-        }
+        ++position;
+        return true;
     }
 
-    return true;
-}
+    bool consumeLiteral(const char* literal)
+    {
+        size_t length = strlen(literal);
+        if (static_cast<size_t>(end - position) < length || memcmp(position, literal, length) != 0)
+            return false;
+        position += length;
+        return true;
+    }
 
-#define FROM_JSON_UINT32(fieldname, submessageType) if (!fromJsonUint32(jsonObject, #fieldname, configStruct.fieldname, configStruct.PREPROCESSOR_JOIN(has_, fieldname))) { return false; }
+    bool beginContainer(char open)
+    {
+        if (error || depth >= JSON_READER_MAX_DEPTH || !consume(open))
+            return fail();
+        ++depth;
+        firstEntry = true;
+        return true;
+    }
 
-static bool fromJsonBool(JsonObjectConst jsonObject, const char* fieldname, bool& value, bool& flag)
-{
-    if (jsonObject.containsKey(fieldname))
+    bool nextEntry(char close)
     {
-        JsonVariantConst jsonVariant = jsonObject[fieldname];
-        if (jsonVariant.is<bool>())
-        {
-            value = jsonVariant.as<bool>();
-            flag = true;
-            return true;
-        }
-        else
+        if (error)
+            return false;
+        if (consume(close))
         {
+            --depth;
+            firstEntry = false;
             return false;
         }
+        if (!firstEntry && !consume(','))
+            return fail();
+        firstEntry = false;
+        return true;
     }
 
-    return true;
-}
+    // Feeds the unescaped characters of the next string to sink, sink returns false to reject the string
+    template <typename Sink>
+    bool readString(Sink sink)
+    {
+        if (!consume('"'))
+            return fail();
 
-#define FROM_JSON_BOOL(fieldname, submessageType) if (!fromJsonBool(jsonObject, #fieldname, configStruct.fieldname, configStruct.PREPROCESSOR_JOIN(has_, fieldname))) { return false; }
+        while (position < end)
+        {
+            char c = *position++;
+            if (c == '"')
+                return true;
+            if (c == '\\')
+            {
+                if (position >= end)
+                    break;
+                c = *position++;
+                switch (c)
+                {
+                    case '"':
+                    case '\\':
+                    case '/': break;
+                    case 'b': c = '\b'; break;
+                    case 'f': c = '\f'; break;
+                    case 'n': c = '\n'; break;
+                    case 'r': c = '\r'; break;
+                    case 't': c = '\t'; break;
+                    case 'u':
+                        {
+                            uint32_t codepoint;
+                            if (!readUnicodeEscape(codepoint) || !storeUtf8(sink, codepoint))
+                                return fail();
+                            continue;
+                        }
+                    default:
+                        return fail();
+                }
+            }
+            if (!sink(c))
+                return fail();
+        }
 
-#define FROM_JSON_STRING(fieldname, submessageType) \
-    if (jsonObject.containsKey(#fieldname)) \
-    { \
-        JsonVariantConst value = jsonObject[#fieldname]; \
-        if (value.is<const char*>() && strlen(value.as<const char*>()) < sizeof(configStruct.fieldname)) \
-        { \
-            strncpy(configStruct.fieldname, value.as<const char*>(), sizeof(configStruct.fieldname)); \
-            configStruct.fieldname[sizeof(configStruct.fieldname) - 1] = '\0'; \
-            configStruct.PREPROCESSOR_JOIN(has_, fieldname) = true; \
-        } \
-        else \
-        { \
-            return false; \
-        } \
+        return fail();
     }
 
-static bool fromJsonBytes(JsonObjectConst jsonObject, const char* fieldname, uint8_t* bytes, uint16_t& size, size_t maxSize)
-{
-    if (jsonObject.containsKey(fieldname))
+    bool readHex4(uint32_t& value)
     {
-        JsonVariantConst value = jsonObject[fieldname];
-        if (!value.is<const char*>())
-        {
+        if (end - position < 4)
             return false;
+        value = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            char c = *position++;
+            value <<= 4;
+            if (c >= '0' && c <= '9') value |= c - '0';
+            else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+            else return false;
         }
-        const char* str = value.as<const char*>();
-        const size_t strLength = strlen(str);
+        return true;
+    }
 
-        // Length of Base64 encoded data has to be divisible by 4
-        if (strLength % 4 != 0)
-        {
+    // Called after "\u", combines surrogate pairs
+    bool readUnicodeEscape(uint32_t& codepoint)
+    {
+        if (!readHex4(codepoint))
             return false;
+        if (codepoint >= 0xD800 && codepoint < 0xDC00)
+        {
+            uint32_t low;
+            if (end - position < 2 || position[0] != '\\' || position[1] != 'u')
+                return false;
+            position += 2;
+            if (!readHex4(low) || low < 0xDC00 || low >= 0xE000)
+                return false;
+            codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
         }
+        return true;
+    }
 
-        size_t decodedLength = strLength / 4 * 3;
-        if (strLength >= 1 && str[strLength - 1] == '=') --decodedLength;
-        if (strLength >= 2 && str[strLength - 2] == '=') --decodedLength;
-        if (decodedLength > maxSize)
-        {
+    template <typename Sink>
+    static bool storeUtf8(Sink& sink, uint32_t codepoint)
+    {
+        if (codepoint < 0x80)
+            return sink(static_cast<char>(codepoint));
+        if (codepoint < 0x800)
+            return sink(static_cast<char>(0xC0 | (codepoint >> 6))) &&
+                   sink(static_cast<char>(0x80 | (codepoint & 0x3F)));
+        if (codepoint < 0x10000)
+            return sink(static_cast<char>(0xE0 | (codepoint >> 12))) &&
+                   sink(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F))) &&
+                   sink(static_cast<char>(0x80 | (codepoint & 0x3F)));
+        return sink(static_cast<char>(0xF0 | (codepoint >> 18))) &&
+               sink(static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F))) &&
+               sink(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F))) &&
+               sink(static_cast<char>(0x80 | (codepoint & 0x3F)));
+    }
+
+    static bool storeBase64Group(const char* group, size_t count, uint8_t* bytes, size_t& length, size_t maxSize)
+    {
+        if (length + count > maxSize)
             return false;
-        }
+        uint8_t decoded[3];
+        Base64::DecodeBlock(group, decoded);
+        memcpy(bytes + length, decoded, count);
+        length += count;
+        return true;
+    }
 
-        std::string decoded;
-        if (!Base64::Decode(str, strLength, decoded))
+    // Copies the next number into buffer, integer is false if it has a fraction or an exponent
+    bool readNumber(char* buffer, size_t size, bool& integer)
+    {
+        peek();
+        size_t length = 0;
+        integer = true;
+        while (position < end)
         {
-            return false;
+            char c = *position;
+            if (c == '.' || c == 'e' || c == 'E')
+                integer = false;
+            else if (!(c >= '0' && c <= '9') && c != '-' && c != '+')
+                break;
+            if (length + 1 >= size)
+                return fail();
+            buffer[length++] = c;
+            ++position;
         }
-        memcpy(bytes, decoded.data(), decoded.length());
-        size = decoded.length();
+        buffer[length] = '\0';
+
+        char* numberEnd = nullptr;
+        strtod(buffer, &numberEnd);
+        if (length == 0 || numberEnd != buffer + length)
+            return fail();
+        return true;
     }
 
-    return true;
-}
+    bool readInteger(int64_t& value)
+    {
+        char buffer[JSON_READER_MAX_NUMBER_LENGTH];
+        bool integer;
+        if (!readNumber(buffer, sizeof(buffer), integer) || !integer)
+            return fail();
+
+        const char* c = buffer;
+        bool negative = (*c == '-');
+        if (negative)
+            ++c;
+        if (*c == '\0')
+            return fail();
+
+        int64_t v = 0;
+        for (; *c != '\0'; ++c)
+        {
+            if (*c < '0' || *c > '9' || v > (INT64_MAX - (*c - '0')) / 10)
+                return fail();
+            v = v * 10 + (*c - '0');
+        }
+        value = negative ? -v : v;
+        return true;
+    }
 
-#define FROM_JSON_BYTES(fieldname, submessageType) if (!fromJsonBytes(jsonObject, #fieldname, configStruct.fieldname.bytes, configStruct.fieldname.size, sizeof(configStruct.fieldname.bytes))) return false;
+    const char* position;
+    const char* end;
+    uint8_t depth;
+    bool firstEntry;
+    bool error;
+    char key[JSON_READER_MAX_KEY_LENGTH];
+};
 
-#define FROM_JSON_MESSAGE(fieldname, submessageType) \
-    if (jsonObject.containsKey(#fieldname)) \
+#define FROM_JSON_ENUM(fieldname, enumType) \
+    if (json.isKey(#fieldname)) \
     { \
-        JsonVariantConst value = jsonObject[#fieldname]; \
-        if (!value.is<JsonObjectConst>() || !PREPROCESSOR_JOIN(fromJSON, PREPROCESSOR_JOIN(submessageType, _MSGTYPE))(value.as<JsonObjectConst>(), configStruct.fieldname)) \
+        int32_t v; \
+        if (!json.readInt32(v) || !PREPROCESSOR_JOIN(isValid, PREPROCESSOR_JOIN(enumType, _ENUMTYPE))(v)) \
         { \
             return false; \
         } \
+        configStruct.fieldname = static_cast<decltype(configStruct.fieldname)>(v); \
+        configStruct.PREPROCESSOR_JOIN(has_, fieldname) = true; \
+        continue; \
     }
 
-#define FROM_JSON_REPEATED_ENUM(fieldname, enumType) \
-    configStruct.fieldname ## _count = 0; \
-    for (size_t index = 0; index < array.size(); ++index) \
+#define FROM_JSON_UENUM(fieldname, enumType) \
+    if (json.isKey(#fieldname)) \
     { \
-        if (!array[index].is<int>() || !PREPROCESSOR_JOIN(isValid, PREPROCESSOR_JOIN(enumType, _ENUMTYPE))(array[index].as<int>())) \
+        uint32_t v; \
+        if (!json.readUint32(v) || !PREPROCESSOR_JOIN(isValid, PREPROCESSOR_JOIN(enumType, _ENUMTYPE))(v)) \
         { \
             return false; \
         } \
-        configStruct.fieldname[index] = static_cast<PREPROCESSOR_JOIN(enumType, _ENUMTYPE)>(array[index].as<int>()); \
-        ++configStruct.fieldname ## _count; \
+        configStruct.fieldname = static_cast<decltype(configStruct.fieldname)>(v); \
+        configStruct.PREPROCESSOR_JOIN(has_, fieldname) = true; \
+        continue; \
     }
 
-#define FROM_JSON_REPEATED_UENUM(fieldname, enumType) \
-    configStruct.fieldname ## _count = 0; \
-    for (size_t index = 0; index < array.size(); ++index) \
+#define FROM_JSON_SCALAR(fieldname, readFunction) \
+    if (json.isKey(#fieldname)) \
     { \
-        if (!array[index].is<unsigned int>() || !PREPROCESSOR_JOIN(isValid, PREPROCESSOR_JOIN(enumType, _ENUMTYPE))(array[index].as<unsigned int>())) \
+        if (!json.readFunction(configStruct.fieldname)) \
         { \
             return false; \
         } \
-        configStruct.fieldname[index] = static_cast<PREPROCESSOR_JOIN(enumType, _ENUMTYPE)>(array[index].as<unsigned int>()); \
-        ++configStruct.fieldname ## _count; \
+        configStruct.PREPROCESSOR_JOIN(has_, fieldname) = true; \
+        continue; \
     }
 
-#define FROM_JSON_REPEATED_INT32(fieldname, submessageType) \
-    configStruct.fieldname ## _count = 0; \
-    for (size_t index = 0; index < array.size(); ++index) \
+#define FROM_JSON_DOUBLE(fieldname, submessageType) FROM_JSON_SCALAR(fieldname, readDouble)
+#define FROM_JSON_FLOAT(fieldname, submessageType) FROM_JSON_SCALAR(fieldname, readFloat)
+#define FROM_JSON_INT32(fieldname, submessageType) FROM_JSON_SCALAR(fieldname, readInt32)
+#define FROM_JSON_UINT32(fieldname, submessageType) FROM_JSON_SCALAR(fieldname, readUint32)
+#define FROM_JSON_BOOL(fieldname, submessageType) FROM_JSON_SCALAR(fieldname, readBool)
+
+#define FROM_JSON_STRING(fieldname, submessageType) \
+    if (json.isKey(#fieldname)) \
     { \
-        if (!array[index].is<int>()) \
+        if (!json.readString(configStruct.fieldname, sizeof(configStruct.fieldname))) \
         { \
             return false; \
         } \
-        configStruct.fieldname[index] = array[index].as<int>(); \
-        ++configStruct.fieldname ## _count; \
+        configStruct.PREPROCESSOR_JOIN(has_, fieldname) = true; \
+        continue; \
     }
 
-#define FROM_JSON_REPEATED_UINT32(fieldname, submessageType) \
-    configStruct.fieldname ## _count = 0; \
-    for (size_t index = 0; index < array.size(); ++index) \
+#define FROM_JSON_BYTES(fieldname, submessageType) \
+    if (json.isKey(#fieldname)) \
     { \
-        if (!array[index].is<unsigned int>()) \
+        if (!json.readBase64(configStruct.fieldname.bytes, configStruct.fieldname.size, sizeof(configStruct.fieldname.bytes))) \
         { \
             return false; \
         } \
-        configStruct.fieldname[index] = array[index].as<unsigned int>(); \
-        ++configStruct.fieldname ## _count; \
+        continue; \
     }
 
-#define FROM_JSON_REPEATED_BOOL(fieldname, submessageType) \
-    configStruct.fieldname ## _count = 0; \
-    for (size_t index = 0; index < array.size(); ++index) \
+#define FROM_JSON_MESSAGE(fieldname, submessageType) \
+    if (json.isKey(#fieldname)) \
     { \
-        if (!array[index].is<bool>()) \
+        if (!PREPROCESSOR_JOIN(fromJSON, PREPROCESSOR_JOIN(submessageType, _MSGTYPE))(json, configStruct.fieldname)) \
         { \
             return false; \
         } \
-        configStruct.fieldname[index] = array[index].as<bool>(); \
-        ++configStruct.fieldname ## _count; \
+        continue; \
     }
 
-#define FROM_JSON_REPEATED_STRING(fieldname, submessageType) \
-    configStruct.fieldname ## _count = 0; \
-    for (size_t index = 0; index < array.size(); ++index) \
+#define FROM_JSON_REPEATED_ENUM(element, enumType) \
     { \
-        if (!array[index].is<const char*>() || strlen(array[index].as<const char*>()) >= sizeof(configStruct.fieldname[index])) \
+        int32_t v; \
+        if (!json.readInt32(v) || !PREPROCESSOR_JOIN(isValid, PREPROCESSOR_JOIN(enumType, _ENUMTYPE))(v)) \
         { \
             return false; \
         } \
-        strncpy(configStruct.fieldname[index], array[index].as<const char*>(), sizeof(configStruct.fieldname[index])); \
-        configStruct.fieldname[index][sizeof(configStruct.fieldname[index]) - 1] = '\0'; \
-        ++configStruct.fieldname ## _count; \
+        element = static_cast<PREPROCESSOR_JOIN(enumType, _ENUMTYPE)>(v); \
     }
 
-#define FROM_JSON_REPEATED_BYTES(fieldname, submessageType) static_assert(false, "not supported");
-
-#define FROM_JSON_REPEATED_MESSAGE(fieldname, submessageType) \
-    configStruct.fieldname ## _count = 0; \
-    for (size_t index = 0; index < array.size(); ++index) \
+#define FROM_JSON_REPEATED_UENUM(element, enumType) \
     { \
-        if (!array[index].is<JsonObjectConst>() || !PREPROCESSOR_JOIN(fromJSON, PREPROCESSOR_JOIN(submessageType, _MSGTYPE))(array[index].as<JsonObjectConst>(), configStruct.fieldname[index])) \
+        uint32_t v; \
+        if (!json.readUint32(v) || !PREPROCESSOR_JOIN(isValid, PREPROCESSOR_JOIN(enumType, _ENUMTYPE))(v)) \
         { \
             return false; \
         } \
-        ++configStruct.fieldname ## _count; \
+        element = static_cast<PREPROCESSOR_JOIN(enumType, _ENUMTYPE)>(v); \
+    }
+
+#define FROM_JSON_REPEATED_INT32(element, submessageType) if (!json.readInt32(element)) { return false; }
+#define FROM_JSON_REPEATED_UINT32(element, submessageType) if (!json.readUint32(element)) { return false; }
+#define FROM_JSON_REPEATED_BOOL(element, submessageType) if (!json.readBool(element)) { return false; }
+#define FROM_JSON_REPEATED_STRING(element, submessageType) if (!json.readString(element, sizeof(element))) { return false; }
+#define FROM_JSON_REPEATED_BYTES(element, submessageType) static_assert(false, "not supported");
+#define FROM_JSON_REPEATED_MESSAGE(element, submessageType) \
+    if (!PREPROCESSOR_JOIN(fromJSON, PREPROCESSOR_JOIN(submessageType, _MSGTYPE))(json, element)) \
+    { \
+        return false; \
     }
 
 #define FROM_JSON_REPEATED(ltype, fieldname, submessageType) \
-    if (jsonObject.containsKey(#fieldname)) \
+    if (json.isKey(#fieldname)) \
     { \
-        JsonVariantConst value = jsonObject[#fieldname]; \
-        if (!value.is<JsonArrayConst>()) \
+        if (!json.beginArray()) \
         { \
             return false; \
         } \
-        JsonArrayConst array = value.as<JsonArrayConst>(); \
-        if (array.size() > sizeof(configStruct.fieldname) / sizeof(configStruct.fieldname[0])) \
+        configStruct.fieldname ## _count = 0; \
+        while (json.nextElement()) \
+        { \
+            if (configStruct.fieldname ## _count >= sizeof(configStruct.fieldname) / sizeof(configStruct.fieldname[0])) \
+            { \
+                return false; \
+            } \
+            PREPROCESSOR_JOIN(FROM_JSON_REPEATED_, ltype)(configStruct.fieldname[configStruct.fieldname ## _count], submessageType) \
+            ++configStruct.fieldname ## _count; \
+        } \
+        if (json.failed()) \
         { \
             return false; \
         } \
-        PREPROCESSOR_JOIN(FROM_JSON_REPEATED_, ltype)(fieldname, submessageType) \
+        continue; \
     }
 
 #define FROM_JSON_REQUIRED(ltype, fieldname, submessageType) PREPROCESSOR_JOIN(FROM_JSON_, ltype)(fieldname, submessageType)
@@ -2091,13 +2487,25 @@ static bool fromJsonBytes(JsonObjectConst jsonObject, const char* fieldname, uin
 #define FROM_JSON_FIELD(parenttype, atype, htype, ltype, fieldname, tag, disallow_export) \
     PREPROCESSOR_JOIN(FROM_JSON_, atype)(htype, ltype, fieldname, parenttype ## _ ## fieldname)
 
-#define GEN_FROM_JSON_FUNCTION_DECL(structtype) static bool fromJSON ## structtype(JsonObjectConst jsonObject, structtype& configStruct);
+#define GEN_FROM_JSON_FUNCTION_DECL(structtype) static bool fromJSON ## structtype(JsonReader& json, structtype& configStruct);
 
+// Each key is matched against the field list, whatever is left over is skipped
 #define GEN_FROM_JSON_FUNCTION(structtype) \
-    static bool fromJSON ## structtype(JsonObjectConst jsonObject, structtype& configStruct) \
+    static bool fromJSON ## structtype(JsonReader& json, structtype& configStruct) \
     { \
-        structtype ## _FIELDLIST(FROM_JSON_FIELD, structtype) \
-        return true; \
+        if (!json.beginObject()) \
+        { \
+            return false; \
+        } \
+        while (json.nextKey()) \
+        { \
+            structtype ## _FIELDLIST(FROM_JSON_FIELD, structtype) \
+            if (!json.skipValue()) \
+            { \
+                return false; \
+            } \
+        } \
+        return !json.failed(); \
     }
 
 #if defined(CONFIG_MESSAGES_GP2040)
@@ -2113,14 +2521,8 @@ static bool fromJsonBytes(JsonObjectConst jsonObject, const char* fieldname, uin
 // Type mismatches, buffer overruns or illegal enum values cause an error
 bool ConfigUtils::fromJSON(Config& config, const char* data, size_t dataLen)
 {
-    DynamicJsonDocument doc(1024 * 10);
-    if (deserializeJson(doc, data, dataLen) != DeserializationError::Ok || !doc.is<JsonObject>())
-    {
-        return false;
-    }
-
-    // Store config struct on the heap to avoid stack overflow
-    if (!fromJSONConfig(doc.as<JsonObjectConst>(), config))
+    JsonReader json(data, dataLen);
+    if (!fromJSONConfig(json, config))
     {
         return false;
     }
@@ -5,7 +5,8 @@
 #include "addons/neopicoleds.h"
 
 void ConfigManager::setup(ConfigType config) {
-	if (config == CONFIG_TYPE_WEB)
+	// The webserver and its network stack have no teardown, entering web config again reuses them
+	if (config == CONFIG_TYPE_WEB && this->config == nullptr)
 		setupConfig(new WebConfig());
 
     this->cType = config;
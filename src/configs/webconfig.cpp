@@ -11,6 +11,8 @@
 #include "types.h"
 #include "version.h"
 
+#include <algorithm>
+#include <cstdlib>
 #include <cstring>
 #include <string>
 #include <vector>
@@ -28,6 +30,7 @@
 #include "lwip/apps/httpd.h"
 #include "lwip/def.h"
 #include "lwip/mem.h"
+#include "lwip/tcp.h"
 #include "addons/input_macro.h"
 
 #include "bitmaps.h"
@@ -44,6 +47,7 @@ const static char* spaPaths[] = { "/backup", "/display-config", "/led-config", "
 const static char* excludePaths[] = { "/css", "/images", "/js", "/static" };
 const static uint32_t rebootDelayMs = 500;
 static string http_post_uri;
+static bool http_post_pending = false;
 static char http_post_payload[LWIP_HTTPD_POST_MAX_PAYLOAD_LEN];
 static uint16_t http_post_payload_len = 0;
 static absolute_time_t rebootDelayTimeout = nil_time;
@@ -213,13 +217,200 @@ static void __attribute__((noinline)) writeDoc(DynamicJsonDocument& doc, const K
 
 static int32_t cleanPin(int32_t pin) { return isValidPin(pin) ? pin : -1; }
 
+// **** Live input stream ****
+// Server-sent events (text/event-stream) for input testing. The httpd only serves complete files, so the stream
+// listens on its own port and keeps the client pcb itself. It runs from WebConfig::loop on core0, between
+// gamepad reads, so it can look at the gamepad directly without copying or locking. A frame is only written
+// when lwIP has room for it: a slow client drops frames instead of stalling the loop.
+#define INPUT_STREAM_PORT 8080
+#define INPUT_STREAM_DEFAULT_HZ 30
+#define INPUT_STREAM_MAX_HZ 250
+#define INPUT_STREAM_KEEPALIVE_US 1000000
+#define INPUT_STREAM_MAX_REQUEST 256
+#define INPUT_STREAM_MAX_FRAME 192
+
+static struct tcp_pcb* inputStreamClient = nullptr;
+static bool inputStreamActive = false; // response header has been sent
+static char inputStreamRequest[INPUT_STREAM_MAX_REQUEST];
+static uint16_t inputStreamRequestLen = 0;
+static uint32_t inputStreamIntervalUs = 1000000 / INPUT_STREAM_DEFAULT_HZ;
+static uint32_t inputStreamLastPollUs = 0;
+static uint32_t inputStreamLastSendUs = 0;
+static char inputStreamLastFrame[INPUT_STREAM_MAX_FRAME];
+static int inputStreamLastFrameLen = 0;
+
+static const char inputStreamHeader[] =
+    "HTTP/1.0 200 OK\r\n"
+    "Server: GP2040-CE " GP2040VERSION "\r\n"
+    "Content-Type: text/event-stream\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Access-Control-Allow-Origin: *\r\n"
+    "\r\n";
+
+static void input_stream_close(struct tcp_pcb* pcb)
+{
+    tcp_arg(pcb, NULL);
+    tcp_recv(pcb, NULL);
+    tcp_err(pcb, NULL);
+    if (tcp_close(pcb) != ERR_OK)
+        tcp_abort(pcb);
+    if (pcb == inputStreamClient)
+        inputStreamClient = nullptr;
+}
+
+static void input_stream_err(void* arg, err_t err)
+{
+    // lwIP has already freed the pcb
+    LWIP_UNUSED_ARG(arg);
+    LWIP_UNUSED_ARG(err);
+    inputStreamClient = nullptr;
+}
+
+// "GET /api/inputStream?hz=60 HTTP/1.1", the rate is optional
+static bool input_stream_parse_request()
+{
+    inputStreamRequest[inputStreamRequestLen] = '\0';
+    static const char path[] = "GET /api/inputStream";
+    const size_t pathLen = sizeof(path) - 1;
+    // the path has to end here, "/api/inputStreamFoo" is not this endpoint
+    if (strncmp(inputStreamRequest, path, pathLen) != 0 ||
+        (inputStreamRequest[pathLen] != ' ' && inputStreamRequest[pathLen] != '?'))
+        return false;
+
+    uint32_t hz = INPUT_STREAM_DEFAULT_HZ;
+    const char* lineEnd = strstr(inputStreamRequest, "\r\n");
+    const char* rate = strstr(inputStreamRequest, "hz=");
+    if (rate != nullptr && rate < lineEnd)
+        hz = std::clamp<uint32_t>(strtoul(rate + 3, nullptr, 10), 1, INPUT_STREAM_MAX_HZ);
+    inputStreamIntervalUs = 1000000 / hz;
+    return true;
+}
+
+static err_t input_stream_recv(void* arg, struct tcp_pcb* pcb, struct pbuf* p, err_t err)
+{
+    LWIP_UNUSED_ARG(arg);
+
+    if (p == NULL || err != ERR_OK)
+    {
+        if (p != NULL)
+            pbuf_free(p);
+        input_stream_close(pcb);
+        return ERR_OK;
+    }
+
+    // Only the request is read, anything the client sends afterwards is ignored
+    if (!inputStreamActive)
+    {
+        uint16_t count = std::min<uint16_t>(p->tot_len, sizeof(inputStreamRequest) - 1 - inputStreamRequestLen);
+        inputStreamRequestLen += pbuf_copy_partial(p, inputStreamRequest + inputStreamRequestLen, count, 0);
+        inputStreamRequest[inputStreamRequestLen] = '\0';
+    }
+    tcp_recved(pcb, p->tot_len);
+    pbuf_free(p);
+
+    if (!inputStreamActive && strstr(inputStreamRequest, "\r\n\r\n") != nullptr)
+    {
+        if (!input_stream_parse_request() ||
+            tcp_write(pcb, inputStreamHeader, sizeof(inputStreamHeader) - 1, 0) != ERR_OK)
+        {
+            input_stream_close(pcb);
+            return ERR_OK;
+        }
+        tcp_output(pcb);
+        inputStreamActive = true;
+        inputStreamLastFrameLen = 0;
+    }
+    else if (!inputStreamActive && inputStreamRequestLen >= sizeof(inputStreamRequest) - 1)
+    {
+        input_stream_close(pcb);
+    }
+
+    return ERR_OK;
+}
+
+static err_t input_stream_accept(void* arg, struct tcp_pcb* pcb, err_t err)
+{
+    LWIP_UNUSED_ARG(arg);
+
+    if (err != ERR_OK || pcb == NULL)
+        return ERR_VAL;
+
+    // One viewer at a time, a new connection (e.g. a page reload) replaces the old one
+    if (inputStreamClient != nullptr)
+        input_stream_close(inputStreamClient);
+
+    inputStreamClient = pcb;
+    inputStreamActive = false;
+    inputStreamRequestLen = 0;
+    tcp_recv(pcb, input_stream_recv);
+    tcp_err(pcb, input_stream_err);
+
+    return ERR_OK;
+}
+
+static void input_stream_init()
+{
+    struct tcp_pcb* pcb = tcp_new_ip_type(IPADDR_TYPE_ANY);
+    if (pcb == NULL)
+        return;
+
+    if (tcp_bind(pcb, IP_ANY_TYPE, INPUT_STREAM_PORT) != ERR_OK)
+    {
+        tcp_close(pcb);
+        return;
+    }
+
+    struct tcp_pcb* listener = tcp_listen(pcb);
+    if (listener != NULL)
+        tcp_accept(listener, input_stream_accept);
+}
+
+static void input_stream_task()
+{
+    if (inputStreamClient == nullptr || !inputStreamActive)
+        return;
+
+    uint32_t now = time_us_32();
+    if (now - inputStreamLastPollUs < inputStreamIntervalUs)
+        return;
+    inputStreamLastPollUs = now;
+
+    const Gamepad* gamepad = Storage::getInstance().GetGamepad();
+    const GamepadState& state = gamepad->state;
+    char frame[INPUT_STREAM_MAX_FRAME];
+    int length = snprintf(frame, sizeof(frame),
+        "data: {\"gpio\":%lu,\"debouncedGpio\":%lu,\"dpad\":%u,\"buttons\":%u,\"aux\":%u,"
+        "\"lx\":%u,\"ly\":%u,\"rx\":%u,\"ry\":%u,\"lt\":%u,\"rt\":%u}\n\n",
+        static_cast<unsigned long>(~gpio_get_all() & ((1UL << NUM_BANK0_GPIOS) - 1)),
+        static_cast<unsigned long>(gamepad->debouncedGpio),
+        state.dpad, state.buttons, state.aux, state.lx, state.ly, state.rx, state.ry, state.lt, state.rt);
+    if (length <= 0 || length >= static_cast<int>(sizeof(frame)))
+        return;
+
+    // Unchanged input is only repeated as a keepalive
+    bool changed = length != inputStreamLastFrameLen || memcmp(frame, inputStreamLastFrame, length) != 0;
+    if (!changed && now - inputStreamLastSendUs < INPUT_STREAM_KEEPALIVE_US)
+        return;
+
+    if (tcp_sndbuf(inputStreamClient) < length ||
+        tcp_write(inputStreamClient, frame, length, TCP_WRITE_FLAG_COPY) != ERR_OK)
+        return;
+    tcp_output(inputStreamClient);
+
+    memcpy(inputStreamLastFrame, frame, length);
+    inputStreamLastFrameLen = length;
+    inputStreamLastSendUs = now;
+}
+
 void WebConfig::setup() {
     rndis_init();
+    input_stream_init();
 }
 
 void WebConfig::loop() {
     // rndis http server requires inline functions (non-class)
     rndis_task();
+    input_stream_task();
 
     if (!is_nil_time(rebootDelayTimeout) && time_reached(rebootDelayTimeout)) {
         System::reboot(rebootMode);
@@ -233,6 +424,20 @@ enum class HttpStatusCode
     _500,
 };
 
+enum class HttpMethod
+{
+    GET,
+    POST,
+};
+
+// Config exports are not built in memory, fs_read_custom produces them chunk by chunk
+enum class ConfigStream
+{
+    NONE,
+    JSON,
+    BINARY,
+};
+
 struct DataAndStatusCode
 {
     DataAndStatusCode(string&& data, HttpStatusCode statusCode) :
@@ -242,33 +447,92 @@ struct DataAndStatusCode
 
     string data;
     HttpStatusCode statusCode;
+    ConfigStream streamConfig = ConfigStream::NONE;
 };
 
 // **** WEB SERVER Overrides and Special Functionality ****
-int set_file_data(fs_file* file, const DataAndStatusCode& dataAndStatusCode)
+static void set_response_header(string& header, HttpStatusCode statusCode, size_t contentLength, const char* contentType = "application/json")
 {
-    static string returnData;
-
     const char* statusCodeStr = "";
-    switch (dataAndStatusCode.statusCode)
+    switch (statusCode)
     {
         case HttpStatusCode::_200: statusCodeStr = "200 OK"; break;
         case HttpStatusCode::_400: statusCodeStr = "400 Bad Request"; break;
         case HttpStatusCode::_500: statusCodeStr = "500 Internal Server Error"; break;
     }
 
-    returnData.clear();
-    returnData.append("HTTP/1.0 ");
-    returnData.append(statusCodeStr);
-    returnData.append("\r\n");
-    returnData.append(
+    header.clear();
+    header.append("HTTP/1.0 ");
+    header.append(statusCodeStr);
+    header.append("\r\n");
+    header.append(
         "Server: GP2040-CE " GP2040VERSION "\r\n"
-        "Content-Type: application/json\r\n"
+        "Content-Type: "
+    );
+    header.append(contentType);
+    header.append(
+        "\r\n"
         "Access-Control-Allow-Origin: *\r\n"
         "Content-Length: "
     );
-    returnData.append(std::to_string(dataAndStatusCode.data.length()));
-    returnData.append("\r\n\r\n");
+    header.append(std::to_string(contentLength));
+    header.append("\r\n\r\n");
+}
+
+// Only the header is kept in memory, the config export is generated straight into the lwIP send buffer
+static string configStreamHeader;
+static ConfigStream configStreamFormat = ConfigStream::JSON;
+
+static size_t read_config_stream(char* buffer, size_t bufferSize, size_t offset)
+{
+    const Config& config = Storage::getInstance().getConfig();
+    if (configStreamFormat == ConfigStream::BINARY)
+        return ConfigUtils::toBinary(config, reinterpret_cast<uint8_t*>(buffer), bufferSize, offset);
+    return ConfigUtils::toJSON(config, buffer, bufferSize, offset);
+}
+
+int set_config_stream(fs_file* file, HttpStatusCode statusCode, ConfigStream format)
+{
+    configStreamFormat = format;
+    size_t bodyLength = read_config_stream(nullptr, 0, 0);
+    set_response_header(configStreamHeader, statusCode, bodyLength,
+        (format == ConfigStream::BINARY) ? "application/octet-stream" : "application/json");
+
+    file->data = NULL;
+    file->len = configStreamHeader.size() + bodyLength;
+    file->index = 0;
+    file->http_header_included = file->http_header_included;
+    file->pextension = NULL;
+
+    return 1;
+}
+
+int fs_read_custom(struct fs_file *file, char *buffer, int count)
+{
+    int read = 0;
+    size_t headerLength = configStreamHeader.size();
+    if (static_cast<size_t>(file->index) < headerLength)
+    {
+        read = std::min<int>(count, headerLength - file->index);
+        memcpy(buffer, configStreamHeader.data() + file->index, read);
+    }
+    if (read < count)
+    {
+        read += read_config_stream(buffer + read, count - read, file->index + read - headerLength);
+    }
+    file->index += read;
+
+    return (read > 0) ? read : FS_READ_EOF;
+}
+
+int set_file_data(fs_file* file, const DataAndStatusCode& dataAndStatusCode)
+{
+    static string returnData;
+
+    if (dataAndStatusCode.streamConfig != ConfigStream::NONE)
+        return set_config_stream(file, dataAndStatusCode.statusCode, dataAndStatusCode.streamConfig);
+
+    set_response_header(returnData, dataAndStatusCode.statusCode, dataAndStatusCode.data.length());
     returnData.append(dataAndStatusCode.data);
 
     file->data = returnData.c_str();
@@ -400,6 +664,7 @@ void httpd_post_finished(void *connection, char *response_uri, uint16_t response
     if (http_post_payload_len != 0xffff) {
         strncpy(response_uri, http_post_uri.c_str(), response_uri_len);
         response_uri[response_uri_len - 1] = '\0';
+        http_post_pending = true;
     }
 }
 
@@ -1441,6 +1706,11 @@ std::string setAddonOptions()
     docToValue(inputHistoryOptions.col, doc, "inputHistoryCol");
     docToValue(inputHistoryOptions.row, doc, "inputHistoryRow");
 
+    GamepadUSBHostOptions& gamepadUSBHostOptions = Storage::getInstance().getAddonOptions().gamepadUSBHostOptions;
+    docToValue(gamepadUSBHostOptions.enabled, doc, "GamepadUSBHostAddonEnabled");
+    docToValue(gamepadUSBHostOptions.mergeMode, doc, "gamepadUSBHostMergeMode");
+    docToValue(gamepadUSBHostOptions.playerSlot, doc, "gamepadUSBHostPlayerSlot");
+
     KeyboardHostOptions& keyboardHostOptions = Storage::getInstance().getAddonOptions().keyboardHostOptions;
     docToValue(keyboardHostOptions.enabled, doc, "KeyboardHostAddonEnabled");
     docToValue(keyboardHostOptions.mapping.keyDpadUp, doc, "keyboardHostMap", "Up");
@@ -1850,6 +2120,11 @@ std::string getAddonOptions()
     writeDoc(doc, "inputHistoryCol", inputHistoryOptions.col);
     writeDoc(doc, "inputHistoryRow", inputHistoryOptions.row);
 
+    const GamepadUSBHostOptions& gamepadUSBHostOptions = Storage::getInstance().getAddonOptions().gamepadUSBHostOptions;
+    writeDoc(doc, "GamepadUSBHostAddonEnabled", gamepadUSBHostOptions.enabled);
+    writeDoc(doc, "gamepadUSBHostMergeMode", gamepadUSBHostOptions.mergeMode);
+    writeDoc(doc, "gamepadUSBHostPlayerSlot", gamepadUSBHostOptions.playerSlot);
+
     const KeyboardHostOptions& keyboardHostOptions = Storage::getInstance().getAddonOptions().keyboardHostOptions;
     writeDoc(doc, "KeyboardHostAddonEnabled", keyboardHostOptions.enabled);
     writeDoc(doc, "keyboardHostMap", "Up", keyboardHostOptions.mapping.keyDpadUp);
@@ -2008,6 +2283,23 @@ std::string getMemoryReport()
     return serialize_json(doc);
 }
 
+// Boot-to-first-report timing, for this boot and for the one before the last software reboot
+std::string getBootTiming()
+{
+    DynamicJsonDocument doc(LWIP_HTTPD_POST_MAX_PAYLOAD_LEN);
+    const struct { const char* name; System::BootEvent event; } events[] = {
+        { "deviceStart", System::BootEvent::DEVICE_START },
+        { "deviceMounted", System::BootEvent::DEVICE_MOUNTED },
+        { "firstReport", System::BootEvent::FIRST_REPORT },
+        { "hostReady", System::BootEvent::HOST_READY },
+    };
+    for (const auto& e : events) {
+        writeDoc(doc, "current", e.name, (System::getBootEventUs(e.event) + 999) / 1000);
+        writeDoc(doc, "previous", e.name, System::getPreviousBootEventMs(e.event));
+    }
+    return serialize_json(doc);
+}
+
 static bool _abortGetHeldPins = false;
 
 std::string getHeldPins()
@@ -2084,9 +2376,11 @@ std::string abortGetHeldPins()
     return {};
 }
 
-std::string getConfig()
+DataAndStatusCode getConfig()
 {
-    return ConfigUtils::toJSON(Storage::getInstance().getConfig());
+    DataAndStatusCode response(string(), HttpStatusCode::_200);
+    response.streamConfig = ConfigStream::JSON;
+    return response;
 }
 
 DataAndStatusCode setConfig()
@@ -2100,7 +2394,7 @@ DataAndStatusCode setConfig()
         config.reset();
         if (Storage::getInstance().save())
         {
-            return DataAndStatusCode(getConfig(), HttpStatusCode::_200);
+            return getConfig();
         }
         else
         {
@@ -2113,6 +2407,37 @@ DataAndStatusCode setConfig()
     }
 }
 
+DataAndStatusCode getConfigBinary()
+{
+    DataAndStatusCode response(string(), HttpStatusCode::_200);
+    response.streamConfig = ConfigStream::BINARY;
+    return response;
+}
+
+// Restores a backup made with getConfigBinary, the body is the raw protobuf data plus its footer
+DataAndStatusCode setConfigBinary()
+{
+    // Store config struct on the heap to avoid stack overflow
+    std::unique_ptr<Config> config(new Config);
+    if (ConfigUtils::fromBinary(*config.get(), reinterpret_cast<const uint8_t*>(http_post_payload), http_post_payload_len))
+    {
+        Storage::getInstance().getConfig() = *config.get();
+        config.reset();
+        if (Storage::getInstance().save())
+        {
+            return getConfigBinary();
+        }
+        else
+        {
+            return DataAndStatusCode("{ \"error\": \"internal error while saving config\" }", HttpStatusCode::_500);
+        }
+    }
+    else
+    {
+        return DataAndStatusCode("{ \"error\": \"invalid config backup\" }", HttpStatusCode::_400);
+    }
+}
+
 // This should be a storage feature
 std::string resetSettings()
 {
@@ -2154,73 +2479,110 @@ std::string reboot()
 }
 
 typedef std::string (*HandlerFuncPtr)();
-static const std::pair<const char*, HandlerFuncPtr> handlerFuncs[] =
-{
-    { "/api/setDisplayOptions", setDisplayOptions },
-    { "/api/setPreviewDisplayOptions", setPreviewDisplayOptions },
-    { "/api/setGamepadOptions", setGamepadOptions },
-    { "/api/setLedOptions", setLedOptions },
-    { "/api/setCustomTheme", setCustomTheme },
-    { "/api/getCustomTheme", getCustomTheme },
-    { "/api/setPinMappings", setPinMappings },
-    { "/api/setProfileOptions", setProfileOptions },
-    { "/api/setPeripheralOptions", setPeripheralOptions },
-    { "/api/getPeripheralOptions", getPeripheralOptions },
-    { "/api/setExpansionPins", setExpansionPins },
-    { "/api/getExpansionPins", getExpansionPins },
-    { "/api/setKeyMappings", setKeyMappings },
-    { "/api/setAddonsOptions", setAddonOptions },
-    { "/api/setMacroAddonOptions", setMacroAddonOptions },
-    { "/api/setPS4Options", setPS4Options },
-    { "/api/setWiiControls", setWiiControls },
-    { "/api/setSplashImage", setSplashImage },
-    { "/api/reboot", reboot },
-    { "/api/getDisplayOptions", getDisplayOptions },
-    { "/api/getGamepadOptions", getGamepadOptions },
-    { "/api/getButtonLayoutDefs", getButtonLayoutDefs },
-    { "/api/getButtonLayouts", getButtonLayouts },
-    { "/api/getLedOptions", getLedOptions },
-    { "/api/getPinMappings", getPinMappings },
-    { "/api/getProfileOptions", getProfileOptions },
-    { "/api/getKeyMappings", getKeyMappings },
-    { "/api/getAddonsOptions", getAddonOptions },
-    { "/api/getWiiControls", getWiiControls },
-    { "/api/getMacroAddonOptions", getMacroAddonOptions },
-    { "/api/resetSettings", resetSettings },
-    { "/api/getSplashImage", getSplashImage },
-    { "/api/getFirmwareVersion", getFirmwareVersion },
-    { "/api/getMemoryReport", getMemoryReport },
-    { "/api/getHeldPins", getHeldPins },
-    { "/api/abortGetHeldPins", abortGetHeldPins },
-    { "/api/getUsedPins", getUsedPins },
-    { "/api/getConfig", getConfig },
+typedef DataAndStatusCode (*HandlerFuncStatusCodePtr)();
+
+struct ApiRoute
+{
+    const char* path;
+    HttpMethod method;
+    HandlerFuncPtr handler;                         // empty response means not found
+    HandlerFuncStatusCodePtr handlerWithStatusCode; // used when handler is null
+};
+
+// Sorted by path (byte order) so requests are resolved with a binary search, see isSortedByPath below
+static constexpr ApiRoute apiRoutes[] =
+{
+    { "/api/abortGetHeldPins",           HttpMethod::GET,  abortGetHeldPins, nullptr },
 #if !defined(NDEBUG)
-    { "/api/echo", echo },
+    { "/api/echo",                       HttpMethod::POST, echo, nullptr },
 #endif
+    { "/api/getAddonsOptions",           HttpMethod::GET,  getAddonOptions, nullptr },
+    { "/api/getBootTiming",              HttpMethod::GET,  getBootTiming, nullptr },
+    { "/api/getButtonLayoutDefs",        HttpMethod::GET,  getButtonLayoutDefs, nullptr },
+    { "/api/getButtonLayouts",           HttpMethod::GET,  getButtonLayouts, nullptr },
+    { "/api/getConfig",                  HttpMethod::GET,  nullptr, getConfig },
+    { "/api/getConfigBinary",            HttpMethod::GET,  nullptr, getConfigBinary },
+    { "/api/getCustomTheme",             HttpMethod::GET,  getCustomTheme, nullptr },
+    { "/api/getDisplayOptions",          HttpMethod::GET,  getDisplayOptions, nullptr },
+    { "/api/getExpansionPins",           HttpMethod::GET,  getExpansionPins, nullptr },
+    { "/api/getFirmwareVersion",         HttpMethod::GET,  getFirmwareVersion, nullptr },
+    { "/api/getGamepadOptions",          HttpMethod::GET,  getGamepadOptions, nullptr },
+    { "/api/getHeldPins",                HttpMethod::GET,  getHeldPins, nullptr },
+    { "/api/getKeyMappings",             HttpMethod::GET,  getKeyMappings, nullptr },
+    { "/api/getLedOptions",              HttpMethod::GET,  getLedOptions, nullptr },
+    { "/api/getMacroAddonOptions",       HttpMethod::GET,  getMacroAddonOptions, nullptr },
+    { "/api/getMemoryReport",            HttpMethod::GET,  getMemoryReport, nullptr },
+    { "/api/getPeripheralOptions",       HttpMethod::GET,  getPeripheralOptions, nullptr },
+    { "/api/getPinMappings",             HttpMethod::GET,  getPinMappings, nullptr },
+    { "/api/getProfileOptions",          HttpMethod::GET,  getProfileOptions, nullptr },
+    { "/api/getSplashImage",             HttpMethod::GET,  getSplashImage, nullptr },
+    { "/api/getUsedPins",                HttpMethod::GET,  getUsedPins, nullptr },
+    { "/api/getWiiControls",             HttpMethod::GET,  getWiiControls, nullptr },
+    { "/api/reboot",                     HttpMethod::POST, reboot, nullptr },
+    { "/api/resetSettings",              HttpMethod::GET,  resetSettings, nullptr },
+    { "/api/setAddonsOptions",           HttpMethod::POST, setAddonOptions, nullptr },
+    { "/api/setConfig",                  HttpMethod::POST, nullptr, setConfig },
+    { "/api/setConfigBinary",            HttpMethod::POST, nullptr, setConfigBinary },
+    { "/api/setCustomTheme",             HttpMethod::POST, setCustomTheme, nullptr },
+    { "/api/setDisplayOptions",          HttpMethod::POST, setDisplayOptions, nullptr },
+    { "/api/setExpansionPins",           HttpMethod::POST, setExpansionPins, nullptr },
+    { "/api/setGamepadOptions",          HttpMethod::POST, setGamepadOptions, nullptr },
+    { "/api/setKeyMappings",             HttpMethod::POST, setKeyMappings, nullptr },
+    { "/api/setLedOptions",              HttpMethod::POST, setLedOptions, nullptr },
+    { "/api/setMacroAddonOptions",       HttpMethod::POST, setMacroAddonOptions, nullptr },
+    { "/api/setPS4Options",              HttpMethod::POST, setPS4Options, nullptr },
+    { "/api/setPeripheralOptions",       HttpMethod::POST, setPeripheralOptions, nullptr },
+    { "/api/setPinMappings",             HttpMethod::POST, setPinMappings, nullptr },
+    { "/api/setPreviewDisplayOptions",   HttpMethod::POST, setPreviewDisplayOptions, nullptr },
+    { "/api/setProfileOptions",          HttpMethod::POST, setProfileOptions, nullptr },
+    { "/api/setSplashImage",             HttpMethod::POST, setSplashImage, nullptr },
+    { "/api/setWiiControls",             HttpMethod::POST, setWiiControls, nullptr },
 };
 
-typedef DataAndStatusCode (*HandlerFuncStatusCodePtr)();
-static const std::pair<const char*, HandlerFuncStatusCodePtr> handlerFuncsWithStatusCode[] =
+static constexpr int comparePath(const char* a, const char* b)
 {
-    { "/api/setConfig", setConfig },
-};
+    while (*a != '\0' && *a == *b)
+    {
+        ++a;
+        ++b;
+    }
+    return static_cast<unsigned char>(*a) - static_cast<unsigned char>(*b);
+}
 
-int fs_open_custom(struct fs_file *file, const char *name)
+static constexpr bool isSortedByPath(const ApiRoute* routes, size_t count)
 {
-    for (const auto& handlerFunc : handlerFuncs)
+    for (size_t i = 1; i < count; i++)
     {
-        if (strcmp(handlerFunc.first, name) == 0)
-        {
-            return set_file_data(file, handlerFunc.second());
-        }
+        if (comparePath(routes[i - 1].path, routes[i].path) >= 0)
+            return false;
     }
+    return true;
+}
 
-    for (const auto& handlerFunc : handlerFuncsWithStatusCode)
+static_assert(isSortedByPath(apiRoutes, sizeof(apiRoutes) / sizeof(apiRoutes[0])), "apiRoutes must be sorted by path without duplicates");
+
+static const ApiRoute* findApiRoute(const char* path)
+{
+    const ApiRoute* first = apiRoutes;
+    const ApiRoute* last = apiRoutes + sizeof(apiRoutes) / sizeof(apiRoutes[0]);
+    const ApiRoute* route = std::lower_bound(first, last, path,
+        [](const ApiRoute& route, const char* path) { return strcmp(route.path, path) < 0; });
+    return (route != last && strcmp(route->path, path) == 0) ? route : nullptr;
+}
+
+int fs_open_custom(struct fs_file *file, const char *name)
+{
+    // lwIP opens the response of a finished POST right away, anything else is a GET
+    const HttpMethod method = http_post_pending ? HttpMethod::POST : HttpMethod::GET;
+    http_post_pending = false;
+
+    if (const ApiRoute* route = findApiRoute(name))
     {
-        if (strcmp(handlerFunc.first, name) == 0)
-        {
-            return set_file_data(file, handlerFunc.second());
-        }
+        if (route->method != method)
+            return 0;
+        if (route->handler != nullptr)
+            return set_file_data(file, route->handler());
+        return set_file_data(file, route->handlerWithStatusCode());
     }
 
     for (const char* excludePath : excludePaths)
@@ -47,7 +47,7 @@ void GPGFX::drawPixel(uint16_t x, uint16_t y, uint32_t color) {
     this->displayDriver->drawPixel(x, y, color);
 }
 
-void GPGFX::drawText(uint16_t x, uint16_t y, std::string text, uint8_t invert) {
+void GPGFX::drawText(uint16_t x, uint16_t y, const std::string& text, uint8_t invert) {
     this->displayDriver->drawText(x, y, text, invert);
 }
 
@@ -1,11 +1,15 @@
 #include "GPButton.h"
 #include "GPGFX_UI_layouts.h"
 
-void GPButton::draw() {
-    // new style button:
+/**
+ * @brief Work out where and how large the button is on screen.
+ *
+ * The viewport scale is floating point, the M0+ has no FPU for it, so this runs once when the layout is built
+ * and draw() only reads input state and emits primitives from the stored integers.
+ */
+void GPButton::prepare() {
     uint16_t baseX = this->x;
     uint16_t baseY = this->y;
-    Mask_t pinValues = ~gpio_get_all();
 
     // scale to viewport
     double scaleX = this->getScaleX();
@@ -19,7 +23,6 @@ void GPButton::draw() {
     }
 
     uint16_t offsetX = ((getRenderer()->getDriver()->getMetrics()->width - (uint16_t)((double)(this->getViewport().right - this->getViewport().left) * scaleX)) / 2);
-    uint16_t offsetY = ((getRenderer()->getDriver()->getMetrics()->height - (uint16_t)((double)(this->getViewport().bottom - this->getViewport().top) * scaleY)) / 2);
 
     if (scaleX > 0.0f) {
         baseX = ((this->x) * scaleX + this->getViewport().left) + offsetX;
@@ -29,128 +32,123 @@ void GPButton::draw() {
         baseY = ((this->y) * scaleY + this->getViewport().top);
     }
 
-    bool pinState = false;
-    bool buttonState = false;
-    uint16_t state = 0;
-    int16_t setPin = -1;
-    int32_t maskedPins = 0;
-    bool useMask = false;
-    GamepadButtonMapping *mapMask = NULL;
+    _geometry = {};
+    _geometry.x = baseX;
+    _geometry.y = baseY;
 
-    if (_inputType == GP_ELEMENT_BTN_BUTTON) {
-        // button mask
-        buttonState = getProcessedGamepad()->pressedButton(this->_inputMask);
-        useMask = true;
+    if (this->_shape == GP_SHAPE_SQUARE) {
+        uint16_t sizeX = (this->_sizeX) * scaleX + this->getViewport().left;
+        uint16_t sizeY = (this->_sizeY) * scaleY + this->getViewport().top;
+        uint16_t width = sizeX - baseX;
+        uint16_t height = sizeY - baseY;
+        uint16_t turboW = (uint16_t)round(width * GP_BUTTON_TURBO_SCALE);
+        uint16_t turboH = (uint16_t)round(height * GP_BUTTON_TURBO_SCALE);
 
+        _geometry.right = sizeX + offsetX;
+        _geometry.bottom = sizeY;
+        _geometry.turboX = baseX + (width - turboW) / 2;
+        _geometry.turboY = baseY + (height - turboH) / 2;
+        _geometry.turboRight = _geometry.turboX + turboW;
+        _geometry.turboBottom = _geometry.turboY + turboH;
+    } else if (this->_shape != GP_SHAPE_LINE) {
+        uint16_t scaledSize = (uint16_t)((double)this->_sizeX * scaleX);
+        _geometry.radius = scaledSize;
+        _geometry.turboRadius = (uint16_t)(scaledSize * GP_BUTTON_TURBO_SCALE);
+    }
+
+    _mapping = nullptr;
+    if (_inputType == GP_ELEMENT_BTN_BUTTON) {
         if ((this->_inputMask & GAMEPAD_MASK_B1) == GAMEPAD_MASK_B1) {
-            mapMask = getGamepad()->mapButtonB1;
+            _mapping = &Gamepad::mapButtonB1;
         } else if ((this->_inputMask & GAMEPAD_MASK_B2) == GAMEPAD_MASK_B2) {
-            mapMask = getGamepad()->mapButtonB2;
+            _mapping = &Gamepad::mapButtonB2;
         } else if ((this->_inputMask & GAMEPAD_MASK_B3) == GAMEPAD_MASK_B3) {
-            mapMask = getGamepad()->mapButtonB3;
+            _mapping = &Gamepad::mapButtonB3;
         } else if ((this->_inputMask & GAMEPAD_MASK_B4) == GAMEPAD_MASK_B4) {
-            mapMask = getGamepad()->mapButtonB4;
+            _mapping = &Gamepad::mapButtonB4;
         } else if ((this->_inputMask & GAMEPAD_MASK_L1) == GAMEPAD_MASK_L1) {
-            mapMask = getGamepad()->mapButtonL1;
+            _mapping = &Gamepad::mapButtonL1;
         } else if ((this->_inputMask & GAMEPAD_MASK_R1) == GAMEPAD_MASK_R1) {
-            mapMask = getGamepad()->mapButtonR1;
+            _mapping = &Gamepad::mapButtonR1;
         } else if ((this->_inputMask & GAMEPAD_MASK_L2) == GAMEPAD_MASK_L2) {
-            mapMask = getGamepad()->mapButtonL2;
+            _mapping = &Gamepad::mapButtonL2;
         } else if ((this->_inputMask & GAMEPAD_MASK_R2) == GAMEPAD_MASK_R2) {
-            mapMask = getGamepad()->mapButtonR2;
+            _mapping = &Gamepad::mapButtonR2;
         } else if ((this->_inputMask & GAMEPAD_MASK_S1) == GAMEPAD_MASK_S1) {
-            mapMask = getGamepad()->mapButtonS1;
+            _mapping = &Gamepad::mapButtonS1;
         } else if ((this->_inputMask & GAMEPAD_MASK_S2) == GAMEPAD_MASK_S2) {
-            mapMask = getGamepad()->mapButtonS2;
+            _mapping = &Gamepad::mapButtonS2;
         } else if ((this->_inputMask & GAMEPAD_MASK_L3) == GAMEPAD_MASK_L3) {
-            mapMask = getGamepad()->mapButtonL3;
+            _mapping = &Gamepad::mapButtonL3;
         } else if ((this->_inputMask & GAMEPAD_MASK_R3) == GAMEPAD_MASK_R3) {
-            mapMask = getGamepad()->mapButtonR3;
+            _mapping = &Gamepad::mapButtonR3;
         } else if ((this->_inputMask & GAMEPAD_MASK_A1) == GAMEPAD_MASK_A1) {
-            mapMask = getGamepad()->mapButtonA1;
+            _mapping = &Gamepad::mapButtonA1;
         } else if ((this->_inputMask & GAMEPAD_MASK_A2) == GAMEPAD_MASK_A2) {
-            mapMask = getGamepad()->mapButtonA2;
+            _mapping = &Gamepad::mapButtonA2;
         }
     } else if (_inputType == GP_ELEMENT_DIR_BUTTON) {
-        // direction button mask
-        buttonState = getProcessedGamepad()->pressedDpad(this->_inputMask);
-        useMask = true;
-
         if ((this->_inputMask & GAMEPAD_MASK_UP) == GAMEPAD_MASK_UP) {
-            mapMask = getGamepad()->mapDpadUp;
+            _mapping = &Gamepad::mapDpadUp;
         } else if ((this->_inputMask & GAMEPAD_MASK_DOWN) == GAMEPAD_MASK_DOWN) {
-            mapMask = getGamepad()->mapDpadDown;
+            _mapping = &Gamepad::mapDpadDown;
         } else if ((this->_inputMask & GAMEPAD_MASK_LEFT) == GAMEPAD_MASK_LEFT) {
-            mapMask = getGamepad()->mapDpadLeft;
+            _mapping = &Gamepad::mapDpadLeft;
         } else if ((this->_inputMask & GAMEPAD_MASK_RIGHT) == GAMEPAD_MASK_RIGHT) {
-            mapMask = getGamepad()->mapDpadRight;
+            _mapping = &Gamepad::mapDpadRight;
         }
+    }
+}
+
+void GPButton::draw() {
+    const GPButtonGeometry& g = _geometry;
+    Mask_t pinValues = ~gpio_get_all();
+
+    bool pinState = false;
+    bool buttonState = false;
+
+    if (_inputType == GP_ELEMENT_BTN_BUTTON) {
+        buttonState = getProcessedGamepad()->pressedButton(this->_inputMask);
+    } else if (_inputType == GP_ELEMENT_DIR_BUTTON) {
+        buttonState = getProcessedGamepad()->pressedDpad(this->_inputMask);
     } else if (_inputType == GP_ELEMENT_PIN_BUTTON) {
         // physical pin
         pinState = ((pinValues >> this->_inputMask) & 0x01);
         buttonState = true;
     }
 
-    if (useMask && mapMask != NULL) {
-        maskedPins = (pinValues & mapMask->pinMask);
-        
-        for (Pin_t pin = 0; pin < (Pin_t)NUM_BANK0_GPIOS; pin++) {
-            if ((maskedPins & (1 << pin)) == (1 << pin)) {
-                setPin = pin;
-                break;
-            }
-        }
-
-        if (setPin > -1) {
-            pinState = ((pinValues >> setPin) & 0x01);
+    // lit while any pin mapped to the button is held
+    if (_mapping != nullptr) {
+        GamepadButtonMapping *mapMask = getGamepad()->*_mapping;
+        if (mapMask != NULL) {
+            pinState = (pinValues & mapMask->pinMask) != 0;
         }
     }
 
-    state = (buttonState ? pinState : 0);
+    uint16_t state = (buttonState ? pinState : 0);
+    bool turbo = (this->_inputType == GP_ELEMENT_BTN_BUTTON && (getGamepad()->turboState.buttons & this->_inputMask));
 
-    // base
     if (this->_shape == GP_SHAPE_ELLIPSE) {
-        uint16_t scaledSize = (uint16_t)((double)this->_sizeX * scaleX);
-        uint16_t baseRadius = (uint16_t)scaledSize;
-        uint16_t turboRadius = (uint16_t)scaledSize * GP_BUTTON_TURBO_SCALE;
-
-        getRenderer()->drawEllipse(baseX, baseY, baseRadius, baseRadius, this->strokeColor, state);
-        if (this->_inputType == GP_ELEMENT_BTN_BUTTON && (getGamepad()->turboState.buttons & this->_inputMask)) {
-            getRenderer()->drawEllipse(baseX, baseY, turboRadius, turboRadius, 1, 0);
+        getRenderer()->drawEllipse(g.x, g.y, g.radius, g.radius, this->strokeColor, state);
+        if (turbo) {
+            getRenderer()->drawEllipse(g.x, g.y, g.turboRadius, g.turboRadius, 1, 0);
         }
     } else if (this->_shape == GP_SHAPE_SQUARE) {
-        uint16_t sizeX = (this->_sizeX) * scaleX + this->getViewport().left;
-        uint16_t sizeY = (this->_sizeY) * scaleY + this->getViewport().top;
-        uint16_t width = sizeX - baseX;
-        uint16_t height = sizeY - baseY;
-        uint16_t turboW = (uint16_t)round(width * GP_BUTTON_TURBO_SCALE);
-        uint16_t turboH = (uint16_t)round(height * GP_BUTTON_TURBO_SCALE);
-        uint16_t turboX = baseX + (width - turboW) / 2;
-        uint16_t turboY = baseY + (height - turboH) / 2;
-
-        getRenderer()->drawRectangle(baseX, baseY, sizeX+offsetX, sizeY, this->strokeColor, state, this->_angle);
-        if (this->_inputType == GP_ELEMENT_BTN_BUTTON && (getGamepad()->turboState.buttons & this->_inputMask)) {
-            getRenderer()->drawRectangle(turboX, turboY, turboX+turboW, turboY+turboH, 1, 0, this->_angle);
+        getRenderer()->drawRectangle(g.x, g.y, g.right, g.bottom, this->strokeColor, state, this->_angle);
+        if (turbo) {
+            getRenderer()->drawRectangle(g.turboX, g.turboY, g.turboRight, g.turboBottom, 1, 0, this->_angle);
         }
     } else if (this->_shape == GP_SHAPE_LINE) {
-        getRenderer()->drawLine(baseX, baseY, this->_sizeX, this->_sizeY, this->strokeColor, 0);
+        getRenderer()->drawLine(g.x, g.y, this->_sizeX, this->_sizeY, this->strokeColor, 0);
     } else if (this->_shape == GP_SHAPE_POLYGON) {
-        uint16_t scaledSize = (uint16_t)((double)this->_sizeX * scaleX);
-        uint16_t baseRadius = (uint16_t)scaledSize;
-        uint16_t turboRadius = (uint16_t)scaledSize * GP_BUTTON_TURBO_SCALE;
-
-        getRenderer()->drawPolygon(baseX, baseY, baseRadius, this->_sizeY, this->strokeColor, state, this->_angle);
-        if (this->_inputType == GP_ELEMENT_BTN_BUTTON && (getGamepad()->turboState.buttons & this->_inputMask)) {
-            getRenderer()->drawPolygon(baseX, baseY, turboRadius, this->_sizeY, 1, 0, this->_angle);
+        getRenderer()->drawPolygon(g.x, g.y, g.radius, this->_sizeY, this->strokeColor, state, this->_angle);
+        if (turbo) {
+            getRenderer()->drawPolygon(g.x, g.y, g.turboRadius, this->_sizeY, 1, 0, this->_angle);
         }
     } else if (this->_shape == GP_SHAPE_ARC) {
-        uint16_t scaledSize = (uint16_t)((double)this->_sizeX * scaleX);
-        uint16_t baseRadius = (uint16_t)scaledSize;
-        uint16_t turboRadius = (uint16_t)scaledSize * GP_BUTTON_TURBO_SCALE;
-
-        getRenderer()->drawArc(baseX, baseY, baseRadius, baseRadius, this->strokeColor, state, this->_angle, this->_angleEnd, this->_closed);
-        if (this->_inputType == GP_ELEMENT_BTN_BUTTON && (getGamepad()->turboState.buttons & this->_inputMask)) {
-            getRenderer()->drawArc(baseX, baseY, turboRadius, turboRadius, 1, 0, this->_angle, this->_angleEnd, this->_closed);
+        getRenderer()->drawArc(g.x, g.y, g.radius, g.radius, this->strokeColor, state, this->_angle, this->_angleEnd, this->_closed);
+        if (turbo) {
+            getRenderer()->drawArc(g.x, g.y, g.turboRadius, g.turboRadius, 1, 0, this->_angle, this->_angleEnd, this->_closed);
         }
     }
 }
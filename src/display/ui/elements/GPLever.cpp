@@ -1,16 +1,18 @@
 #include "GPLever.h"
 
-void GPLever::draw() {
-    // new style lever:
+/**
+ * @brief Work out where the lever sits on screen and everything about it that does not move.
+ *
+ * Same as GPButton::prepare(): the floating point viewport scale and trigonometry run once when the layout is
+ * built. The analog travel is tabled per step, so the lever lands on the same pixel the scaled position did.
+ */
+void GPLever::prepare() {
     // radius defines the base of the lever
     // the lever indicator itself will be sized slightly smaller than the base
 
     int baseX = this->x;
     int baseY = this->y;
 
-    int leverX = this->x;
-    int leverY = this->y;
-
     // scale to viewport
     double scaleX = this->getScaleX();
     double scaleY = this->getScaleY();
@@ -26,17 +28,66 @@ void GPLever::draw() {
 
     if (scaleX > 0.0f) {
         baseX = ((this->x) * scaleX + this->getViewport().left) + offsetX;
-        leverX = ((this->x) * scaleX + this->getViewport().left) + offsetX;
     }
 
     if (scaleY > 0.0f) {
         baseY = ((this->y) * scaleY + this->getViewport().top);
-        leverY = ((this->y) * scaleY + this->getViewport().top);
     }
 
     int baseRadius = (int)(((double)this->_radius * 1.00) * scaleX);
     int leverRadius = (int)(((double)this->_radius * 0.75) * scaleY);
 
+    GPLeverGeometry& g = _geometry;
+    g.x = baseX;
+    g.y = baseY;
+    g.radius = baseRadius;
+    g.leverRadius = leverRadius;
+
+    // analog travel
+    uint16_t minX = std::max(0,(baseX - baseRadius));
+    uint16_t maxX = std::min((baseX + baseRadius),128);
+    uint16_t minY = std::max(0,(baseY - baseRadius));
+    uint16_t maxY = std::min((baseY + baseRadius),64);
+    g.minX = minX;
+    g.minY = minY;
+    for (uint16_t step = 0; step < GP_LEVER_ANALOG_STEPS; step++) {
+        g.travelX[step] = (uint16_t)((step * 0.01) * (maxX - minX));
+        g.travelY[step] = (uint16_t)((step * 0.01) * (maxY - minY));
+    }
+
+    uint16_t cardinalSize = 3;
+    uint16_t cardinalN = std::max(0,(baseY - baseRadius)-cardinalSize);
+    uint16_t cardinalS = std::min((baseY + baseRadius),64);
+    uint16_t cardinalE = std::max(0,(baseX - baseRadius)-cardinalSize);
+    uint16_t cardinalW = std::min((baseX + baseRadius),128);
+    g.cardinal[0] = {(uint16_t)baseX, cardinalN, (uint16_t)baseX, (uint16_t)(cardinalN+cardinalSize)};
+    g.cardinal[1] = {(uint16_t)baseX, cardinalS, (uint16_t)baseX, (uint16_t)(cardinalS+cardinalSize)};
+    g.cardinal[2] = {cardinalE, (uint16_t)baseY, (uint16_t)(cardinalE+cardinalSize), (uint16_t)baseY};
+    g.cardinal[3] = {cardinalW, (uint16_t)baseY, (uint16_t)(cardinalW+cardinalSize), (uint16_t)baseY};
+
+    uint16_t ordinalSize = 2;
+    for (int i = 0, angle = 45; angle <= 315; i++, angle += 90) {
+        // Convert angle to radians
+        double radians = angle * M_PI / 180.0;
+
+        // Calculate coordinates of point on ellipse
+        int xEllipse = baseX + baseRadius * cos(radians);
+        int yEllipse = baseY + baseRadius * sin(radians);
+
+        // Calculate coordinates of endpoint of line
+        int xEndpoint = xEllipse + ordinalSize * cos(radians);
+        int yEndpoint = yEllipse + ordinalSize * sin(radians);
+
+        g.ordinal[i] = {(uint16_t)xEllipse, (uint16_t)yEllipse, (uint16_t)xEndpoint, (uint16_t)yEndpoint};
+    }
+}
+
+void GPLever::draw() {
+    const GPLeverGeometry& g = _geometry;
+    int leverX = g.x;
+    int leverY = g.y;
+    int leverRadius = g.leverRadius;
+
     if (this->_inputType == DPAD_MODE_DIGITAL) {
         // dpad
         bool upState    = (this->_upMask > -1 ? getProcessedGamepad()->pressedButton((uint16_t)this->_upMask) : getProcessedGamepad()->pressedUp());
@@ -67,50 +118,22 @@ void GPLever::draw() {
         uint16_t analogX = map((this->_inputType == DPAD_MODE_LEFT_ANALOG ? getProcessedGamepad()->state.lx : getProcessedGamepad()->state.rx), 0, 0xFFFF, 0, 100);
         uint16_t analogY = map((this->_inputType == DPAD_MODE_LEFT_ANALOG ? getProcessedGamepad()->state.ly : getProcessedGamepad()->state.ry), 0, 0xFFFF, 0, 100);
 
-        uint16_t minX = std::max(0,(baseX - baseRadius));
-        uint16_t maxX = std::min((baseX + baseRadius),128);
-        uint16_t offsetX = (analogX * 0.01) * (maxX - minX);
-        uint16_t minY = std::max(0,(baseY - baseRadius));
-        uint16_t maxY = std::min((baseY + baseRadius),64);
-        uint16_t offsetY = (analogY * 0.01) * (maxY - minY);
-
         // move lever around
-        leverX = minX + offsetX;
-        leverY = minY + offsetY;
+        leverX = g.minX + g.travelX[analogX];
+        leverY = g.minY + g.travelY[analogY];
     }
 
     // base
-    getRenderer()->drawEllipse(baseX, baseY, baseRadius, baseRadius, this->strokeColor, 0);
-    
+    getRenderer()->drawEllipse(g.x, g.y, g.radius, g.radius, this->strokeColor, 0);
+
     if (this->_showCardinal) {
-        uint16_t cardinalSize = 3;
-        uint16_t cardinalN = std::max(0,(baseY - baseRadius)-cardinalSize);
-        uint16_t cardinalS = std::min((baseY + baseRadius),64);
-        uint16_t cardinalE = std::max(0,(baseX - baseRadius)-cardinalSize);
-        uint16_t cardinalW = std::min((baseX + baseRadius),128);
-        getRenderer()->drawLine(baseX, cardinalN, baseX, cardinalN+cardinalSize, this->strokeColor, 1);
-        getRenderer()->drawLine(baseX, cardinalS, baseX, cardinalS+cardinalSize, this->strokeColor, 1);
-        getRenderer()->drawLine(cardinalE, baseY, cardinalE+cardinalSize, baseY, this->strokeColor, 1);
-        getRenderer()->drawLine(cardinalW, baseY, cardinalW+cardinalSize, baseY, this->strokeColor, 1);
+        for (const GPLeverTick& tick : g.cardinal)
+            getRenderer()->drawLine(tick.x1, tick.y1, tick.x2, tick.y2, this->strokeColor, 1);
     }
 
     if (this->_showOrdinal) {
-        uint16_t ordinalSize = 2;
-        for (int angle = 45; angle <= 315; angle += 90) {
-            // Convert angle to radians
-            double radians = angle * M_PI / 180.0;
-    
-            // Calculate coordinates of point on ellipse
-            int xEllipse = baseX + baseRadius * cos(radians);
-            int yEllipse = baseY + baseRadius * sin(radians);
-    
-            // Calculate coordinates of endpoint of line
-            int xEndpoint = xEllipse + ordinalSize * cos(radians);
-            int yEndpoint = yEllipse + ordinalSize * sin(radians);
-    
-            // Draw line from point on ellipse to endpoint
-            getRenderer()->drawLine(xEllipse, yEllipse, xEndpoint, yEndpoint, this->strokeColor, 1);
-        }
+        for (const GPLeverTick& tick : g.ordinal)
+            getRenderer()->drawLine(tick.x1, tick.y1, tick.x2, tick.y2, this->strokeColor, 1);
     }
 
     // lever
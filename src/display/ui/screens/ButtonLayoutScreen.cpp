@@ -1,4 +1,6 @@
 #include "ButtonLayoutScreen.h"
+
+#include <algorithm>
 #include "buttonlayouts.h"
 #include "drivermanager.h"
 #include "drivers/ps4/PS4Driver.h"
@@ -9,14 +11,19 @@ void ButtonLayoutScreen::init() {
     isInputHistoryEnabled = inputHistoryOptions.enabled;
     inputHistoryX = inputHistoryOptions.row;
     inputHistoryY = inputHistoryOptions.col;
-    inputHistoryLength = inputHistoryOptions.length;
+    inputHistoryLength = std::min<size_t>(inputHistoryOptions.length, INPUT_HISTORY_MAX_CHARS);
     profileDelayStart = getMillis();
     gamepad = Storage::getInstance().GetGamepad();
     inputMode = DriverManager::getInstance().getInputMode();
     
-    footer = "";
-    historyString = "";
-    inputHistory.clear();
+    // reserve once so the per-frame header and history updates never reallocate
+    statusBar.reserve(HEADER_MAX_CHARS);
+    statusBar.clear();
+    footer.reserve(INPUT_HISTORY_MAX_CHARS);
+    footer.clear();
+    inputHistoryHead = 0;
+    inputHistoryCount = 0;
+    lastInput.fill(false);
 
     setViewport((isInputHistoryEnabled ? 8 : 0), 0, (isInputHistoryEnabled ? 56 : getRenderer()->getDriver()->getMetrics()->height), getRenderer()->getDriver()->getMetrics()->width);
 
@@ -113,13 +120,17 @@ int8_t ButtonLayoutScreen::update() {
 
 void ButtonLayoutScreen::generateHeader() {
 	// Limit to 21 chars with 6x8 font for now
-	statusBar.clear();
+	char header[HEADER_MAX_CHARS];
+	size_t length = 0;
+	header[0] = '\0';
 
 	// Display Profile # banner
 	if ( profileModeDisplay ) {
 		if (((getMillis() - profileDelayStart) / 1000) < profileDelay) {
-			statusBar = "     Profile #";
-			statusBar +=  std::to_string(getGamepad()->getOptions().profileNumber);
+			appendHeader(header, length, "     Profile #");
+			appendHeader(header, length, getGamepad()->getOptions().profileNumber);
+			if (statusBar.compare(header) != 0)
+				statusBar.assign(header, length);
         	return;
 		} else {
 			profileModeDisplay = false;
@@ -129,70 +140,91 @@ void ButtonLayoutScreen::generateHeader() {
 	// Display standard header
 	switch (inputMode)
 	{
-		case INPUT_MODE_HID:    statusBar += "DINPUT"; break;
-		case INPUT_MODE_SWITCH: statusBar += "SWITCH"; break;
-		case INPUT_MODE_XINPUT: statusBar += "XINPUT"; break;
-		case INPUT_MODE_MDMINI: statusBar += "GEN/MD"; break;
-		case INPUT_MODE_NEOGEO: statusBar += "NGMINI"; break;
-		case INPUT_MODE_PCEMINI: statusBar += "PCE/TG"; break;
-		case INPUT_MODE_EGRET: statusBar += "EGRET"; break;
-		case INPUT_MODE_ASTRO: statusBar += "ASTRO"; break;
-		case INPUT_MODE_PSCLASSIC: statusBar += "PSC"; break;
-		case INPUT_MODE_XBOXORIGINAL: statusBar += "OGXBOX"; break;
+		case INPUT_MODE_HID:    appendHeader(header, length, "DINPUT"); break;
+		case INPUT_MODE_SWITCH: appendHeader(header, length, "SWITCH"); break;
+		case INPUT_MODE_XINPUT: appendHeader(header, length, "XINPUT"); break;
+		case INPUT_MODE_MDMINI: appendHeader(header, length, "GEN/MD"); break;
+		case INPUT_MODE_NEOGEO: appendHeader(header, length, "NGMINI"); break;
+		case INPUT_MODE_PCEMINI: appendHeader(header, length, "PCE/TG"); break;
+		case INPUT_MODE_EGRET: appendHeader(header, length, "EGRET"); break;
+		case INPUT_MODE_ASTRO: appendHeader(header, length, "ASTRO"); break;
+		case INPUT_MODE_PSCLASSIC: appendHeader(header, length, "PSC"); break;
+		case INPUT_MODE_XBOXORIGINAL: appendHeader(header, length, "OGXBOX"); break;
 		case INPUT_MODE_PS4:
-			statusBar += "PS4";
+			appendHeader(header, length, "PS4");
 			if(((PS4Driver*)DriverManager::getInstance().getDriver())->getAuthSent() == true )
-				statusBar += ":AS";
+				appendHeader(header, length, ":AS");
 			else
-				statusBar += "   ";
+				appendHeader(header, length, "   ");
 			break;
 		case INPUT_MODE_PS5:
-			statusBar += "PS5";
+			appendHeader(header, length, "PS5");
 			if(((PS4Driver*)DriverManager::getInstance().getDriver())->getAuthSent() == true )
-				statusBar += ":AS";
+				appendHeader(header, length, ":AS");
 			else
-				statusBar += "   ";
+				appendHeader(header, length, "   ");
 			break;
 		case INPUT_MODE_XBONE:
-			statusBar += "XBON";
+			appendHeader(header, length, "XBON");
 			if(((XBOneDriver*)DriverManager::getInstance().getDriver())->getAuthSent() == true )
-				statusBar += "E";
+				appendHeader(header, length, "E");
 			else
-				statusBar += "*";
+				appendHeader(header, length, "*");
 			break;
-		case INPUT_MODE_KEYBOARD: statusBar += "HID-KB"; break;
-		case INPUT_MODE_CONFIG: statusBar += "CONFIG"; break;
+		case INPUT_MODE_KEYBOARD: appendHeader(header, length, "HID-KB"); break;
+		case INPUT_MODE_CONFIG: appendHeader(header, length, "CONFIG"); break;
 	}
 
 	const TurboOptions& turboOptions = Storage::getInstance().getAddonOptions().turboOptions;
 	if ( turboOptions.enabled ) {
-		statusBar += " T";
-		if ( turboOptions.shotCount < 10 ) // padding
-			statusBar += "0";
-		statusBar += std::to_string(turboOptions.shotCount);
+		appendHeader(header, length, " T");
+		appendHeader(header, length, turboOptions.shotCount, 2); // padding
 	} else {
-		statusBar += "    "; // no turbo, don't show Txx setting
+		appendHeader(header, length, "    "); // no turbo, don't show Txx setting
 	}
 
-	const GamepadOptions & options = gamepad->getOptions();
-
 	switch (gamepad->getOptions().dpadMode)
 	{
-		case DPAD_MODE_DIGITAL:      statusBar += " D"; break;
-		case DPAD_MODE_LEFT_ANALOG:  statusBar += " L"; break;
-		case DPAD_MODE_RIGHT_ANALOG: statusBar += " R"; break;
+		case DPAD_MODE_DIGITAL:      appendHeader(header, length, " D"); break;
+		case DPAD_MODE_LEFT_ANALOG:  appendHeader(header, length, " L"); break;
+		case DPAD_MODE_RIGHT_ANALOG: appendHeader(header, length, " R"); break;
 	}
 
 	switch (Gamepad::resolveSOCDMode(gamepad->getOptions()))
 	{
-		case SOCD_MODE_NEUTRAL:               statusBar += " SOCD-N"; break;
-		case SOCD_MODE_UP_PRIORITY:           statusBar += " SOCD-U"; break;
-		case SOCD_MODE_SECOND_INPUT_PRIORITY: statusBar += " SOCD-L"; break;
-		case SOCD_MODE_FIRST_INPUT_PRIORITY:  statusBar += " SOCD-F"; break;
-		case SOCD_MODE_BYPASS:                statusBar += " SOCD-X"; break;
+		case SOCD_MODE_NEUTRAL:               appendHeader(header, length, " SOCD-N"); break;
+		case SOCD_MODE_UP_PRIORITY:           appendHeader(header, length, " SOCD-U"); break;
+		case SOCD_MODE_SECOND_INPUT_PRIORITY: appendHeader(header, length, " SOCD-L"); break;
+		case SOCD_MODE_FIRST_INPUT_PRIORITY:  appendHeader(header, length, " SOCD-F"); break;
+		case SOCD_MODE_BYPASS:                appendHeader(header, length, " SOCD-X"); break;
 	}
 	if (macroEnabled)
-		statusBar += " M";
+		appendHeader(header, length, " M");
+
+	// only touch the drawn string when the header actually changed
+	if (statusBar.compare(header) != 0)
+		statusBar.assign(header, length);
+}
+
+void ButtonLayoutScreen::appendHeader(char* header, size_t& length, const char* text) {
+	while (*text != '\0' && length < (HEADER_MAX_CHARS - 1)) {
+		header[length++] = *text++;
+	}
+	header[length] = '\0';
+}
+
+void ButtonLayoutScreen::appendHeader(char* header, size_t& length, uint32_t number, uint8_t minDigits) {
+	char digits[10];
+	uint8_t digitCount = 0;
+	do {
+		digits[digitCount++] = '0' + (number % 10);
+		number /= 10;
+	} while ((number > 0 || digitCount < minDigits) && digitCount < sizeof(digits));
+
+	while (digitCount > 0 && length < (HEADER_MAX_CHARS - 1)) {
+		header[length++] = digits[--digitCount];
+	}
+	header[length] = '\0';
 }
 
 void ButtonLayoutScreen::drawScreen() {
@@ -251,7 +283,9 @@ GPSprite* ButtonLayoutScreen::addSprite(uint16_t startX, uint16_t startY, uint16
 
 GPWidget* ButtonLayoutScreen::pushElement(GPButtonLayout element) {
     if (element.elementType == GP_ELEMENT_LEVER) {
-        return addLever(element.parameters.x1, element.parameters.y1, element.parameters.x2, element.parameters.y2, element.parameters.stroke, element.parameters.fill, element.parameters.value);
+        GPLever* lever = addLever(element.parameters.x1, element.parameters.y1, element.parameters.x2, element.parameters.y2, element.parameters.stroke, element.parameters.fill, element.parameters.value);
+        lever->prepare();
+        return lever;
     } else if ((element.elementType == GP_ELEMENT_BTN_BUTTON) || (element.elementType == GP_ELEMENT_DIR_BUTTON) || (element.elementType == GP_ELEMENT_PIN_BUTTON)) {
         GPButton* button = addButton(element.parameters.x1, element.parameters.y1, element.parameters.x2, element.parameters.y2, element.parameters.stroke, element.parameters.fill, element.parameters.value);
 
@@ -265,6 +299,9 @@ GPWidget* ButtonLayoutScreen::pushElement(GPButtonLayout element) {
 
         if (element.elementType == GP_ELEMENT_DIR_BUTTON) button->setInputDirection(true);
 
+        // resolve the geometry now, draw() runs every frame
+        button->prepare();
+
         return (GPWidget*)button;
     } else if (element.elementType == GP_ELEMENT_SPRITE) {
         return addSprite(element.parameters.x1, element.parameters.y1, element.parameters.x2, element.parameters.y2);
@@ -280,8 +317,6 @@ GPWidget* ButtonLayoutScreen::pushElement(GPButtonLayout element) {
 }
 
 void ButtonLayoutScreen::processInputHistory() {
-	std::deque<std::string> pressed;
-
 	// Get key states
 	std::array<bool, INPUT_HISTORY_MAX_INPUTS> currentInput = {
 
@@ -311,57 +346,48 @@ void ButtonLayoutScreen::processInputHistory() {
 		getProcessedGamepad()->pressedA2(),
 	};
 
-	uint8_t mode = ((displayModeLookup.count(getGamepad()->getOptions().inputMode) > 0) ? displayModeLookup.at(getGamepad()->getOptions().inputMode) : 0);
-
-	// Check if any new keys have been pressed
-	if (lastInput != currentInput) {
-		// Iterate through array
-		for (uint8_t x=0; x<INPUT_HISTORY_MAX_INPUTS; x++) {
-			// Add any pressed keys to deque
-			std::string inputChar(displayNames[mode][x]);
-			if (currentInput[x] && (inputChar != "")) pressed.push_back(inputChar);
-		}
-		// Update the last keypress array
-		lastInput = currentInput;
-	}
+	// Only rebuild the history when the pressed keys change
+	if (lastInput == currentInput)
+		return;
 
-	if (pressed.size() > 0) {
-		std::string newInput;
-		for(const auto &s : pressed) {
-				if(!newInput.empty())
-						newInput += "+";
-				newInput += s;
-		}
+	// Update the last keypress array
+	lastInput = currentInput;
 
-		inputHistory.push_back(newInput);
-	}
+	uint8_t mode = ((displayModeLookup.count(getGamepad()->getOptions().inputMode) > 0) ? displayModeLookup.at(getGamepad()->getOptions().inputMode) : 0);
 
-	if (inputHistory.size() > (inputHistoryLength / 2) + 1) {
-		inputHistory.pop_front();
+	// Append pressed keys as one "A+B" entry, entries are separated by a space
+	bool newEntry = false;
+	for (uint8_t x=0; x<INPUT_HISTORY_MAX_INPUTS; x++) {
+		if (!currentInput[x] || displayNames[mode][x][0] == '\0')
+			continue;
+
+		if (newEntry)
+			pushInputHistory("+");
+		else if (inputHistoryCount > 0)
+			pushInputHistory(" ");
+		pushInputHistory(displayNames[mode][x]);
+		newEntry = true;
 	}
 
-	std::string ret;
-
-	for (auto it = inputHistory.crbegin(); it != inputHistory.crend(); ++it) {
-		std::string newRet = ret;
-		if (!newRet.empty())
-			newRet = " " + newRet;
+	if (!newEntry)
+		return;
 
-		newRet = *it + newRet;
-		ret = newRet;
-
-		if (ret.size() >= inputHistoryLength) {
-			break;
-		}
+	// The footer shows the newest inputHistoryLength characters
+	size_t visible = std::min(inputHistoryCount, inputHistoryLength);
+	size_t start = (inputHistoryHead + INPUT_HISTORY_MAX_CHARS - visible) % INPUT_HISTORY_MAX_CHARS;
+	footer.clear();
+	for (size_t charCtr = 0; charCtr < visible; charCtr++) {
+		footer.push_back(inputHistory[(start + charCtr) % INPUT_HISTORY_MAX_CHARS]);
 	}
+}
 
-	if(ret.size() >= inputHistoryLength) {
-		historyString = ret.substr(ret.size() - inputHistoryLength);
-	} else {
-		historyString = ret;
+void ButtonLayoutScreen::pushInputHistory(const char* text) {
+	while (*text != '\0') {
+		inputHistory[inputHistoryHead] = *text++;
+		inputHistoryHead = (inputHistoryHead + 1) % INPUT_HISTORY_MAX_CHARS;
+		if (inputHistoryCount < INPUT_HISTORY_MAX_CHARS)
+			inputHistoryCount++;
 	}
-
-    footer = historyString;
 }
 
 bool ButtonLayoutScreen::compareCustomLayouts()
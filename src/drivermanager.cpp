@@ -15,63 +15,176 @@
 #include "drivers/xboxog/XboxOriginalDriver.h"
 #include "drivers/xinput/XInputDriver.h"
 
+#include "configmanager.h"
+#include "storagemanager.h"
 #include "usbhostmanager.h"
+#include "system.h"
+
+#include <algorithm>
+#include <new>
+#include <utility>
+
+// Every driver is constructed in place here, nothing is left on the heap when the mode changes
+template <typename... Drivers>
+struct DriverPool {
+    static constexpr size_t size = std::max({sizeof(Drivers)...});
+    static constexpr size_t align = std::max({alignof(Drivers)...});
+};
+
+typedef DriverPool<NetDriver, AstroDriver, EgretDriver, HIDDriver, KeyboardDriver, MDMiniDriver, NeoGeoDriver,
+    PSClassicDriver, PCEngineDriver, PS4Driver, SwitchDriver, XBOneDriver, XboxOriginalDriver, XInputDriver> Pool;
+
+alignas(Pool::align) static uint8_t driverStorage[Pool::size];
+
+template <typename T, typename... Args>
+static GPDriver * constructDriver(Args&&... args) {
+    static_assert(sizeof(T) <= sizeof(driverStorage), "driver does not fit the driver pool, add it to Pool");
+    static_assert(alignof(T) <= Pool::align, "driver is over-aligned for the driver pool, add it to Pool");
+    return new (driverStorage) T(std::forward<Args>(args)...);
+}
 
 void DriverManager::setup(InputMode mode) {
+    if (!createDriver(mode))
+        return;
+
+    // Initialize our chosen driver
+    driver->initialize();
+    inputMode = mode;
+
+    // Start the TinyUSB Device functionality
+    tud_init(TUD_OPT_RHPORT);
+    System::markBootEvent(System::BootEvent::DEVICE_START);
+}
+
+bool DriverManager::createDriver(InputMode mode) {
     switch (mode) {
         case INPUT_MODE_CONFIG:
-            driver = new NetDriver();
+            driver = constructDriver<NetDriver>();
             break;
         case INPUT_MODE_ASTRO:
-            driver = new AstroDriver();
+            driver = constructDriver<AstroDriver>();
             break;
         case INPUT_MODE_EGRET:
-            driver = new EgretDriver();
+            driver = constructDriver<EgretDriver>();
             break;
         case INPUT_MODE_HID:
-            driver = new HIDDriver();
+            driver = constructDriver<HIDDriver>();
             break;
         case INPUT_MODE_KEYBOARD:
-            driver = new KeyboardDriver();
+            driver = constructDriver<KeyboardDriver>();
             break;
         case INPUT_MODE_MDMINI:
-            driver = new MDMiniDriver();
+            driver = constructDriver<MDMiniDriver>();
             break;
         case INPUT_MODE_NEOGEO:
-            driver = new NeoGeoDriver();
+            driver = constructDriver<NeoGeoDriver>();
             break;
         case INPUT_MODE_PSCLASSIC:
-            driver = new PSClassicDriver();
+            driver = constructDriver<PSClassicDriver>();
             break;
         case INPUT_MODE_PCEMINI:
-            driver = new PCEngineDriver();
+            driver = constructDriver<PCEngineDriver>();
             break;
         case INPUT_MODE_PS4:
-            driver = new PS4Driver(PS4_CONTROLLER);
+            driver = constructDriver<PS4Driver>(PS4_CONTROLLER);
             break;
         case INPUT_MODE_PS5:
-            driver = new PS4Driver(PS4_ARCADESTICK);
+            driver = constructDriver<PS4Driver>(PS4_ARCADESTICK);
             break;
         case INPUT_MODE_SWITCH:
-            driver = new SwitchDriver();
+            driver = constructDriver<SwitchDriver>();
             break;
         case INPUT_MODE_XBONE:
-            driver = new XBOneDriver();
+            driver = constructDriver<XBOneDriver>();
             break;
         case INPUT_MODE_XBOXORIGINAL:
-            driver = new XboxOriginalDriver();
+            driver = constructDriver<XboxOriginalDriver>();
             break;
         case INPUT_MODE_XINPUT:
-            driver = new XInputDriver();
+            driver = constructDriver<XInputDriver>();
             break;
         default:
-            return;
+            return false;
+    }
+    return true;
+}
+
+void DriverManager::destroyDriver() {
+    if (driver == nullptr)
+        return;
+    driver->~GPDriver();
+    driver = nullptr;
+}
+
+bool DriverManager::enterAux() {
+    auxBusy.store(true);
+    if (swapping.load()) {
+        auxBusy.store(false);
+        return false;
     }
+    return true;
+}
 
-    // Initialize our chosen driver
+/**
+ * @brief Replace the running driver and make the host enumerate the new one.
+ *
+ * TinyUSB has no deinit and keeps the class driver pointer it got from usbd_app_driver_get_cb() in tud_init().
+ * Every driver is built in the same pool storage, so that pointer (and the ones GP2040 and GP2040Aux keep)
+ * stays valid: the device drops off the bus, the new class driver is initialized in place and the host
+ * enumerates it after the reconnect.
+ *
+ * The old driver's auth listener leaves the USB host before its destructor frees it, core1 then runs
+ * initializeAux() for the new driver and registers its listener while core0 waits here. Web config brings up
+ * the network stack and the webserver the first time it is entered, they have no teardown and stay idle
+ * until the next visit.
+ *
+ * Called from core0.
+ */
+bool DriverManager::switchMode(InputMode mode) {
+    if (driver == nullptr)
+        return false;
+    if (mode == inputMode)
+        return true;
+
+    // core1 has to be done with initializeAux() of the running driver before it can go
+    while (auxGeneration.load() != generation.load())
+        tight_loop_contents();
+
+    // Pull-up off, then let TinyUSB hand its queued events to the driver they belong to
+    tud_disconnect();
+    tud_task();
+
+    // Wait for core1 to leave the driver and the USB host, it skips both until swapping is cleared
+    swapping.store(true);
+    while (auxBusy.load())
+        tight_loop_contents();
+
+    USBListener * listener = driver->get_usb_auth_listener();
+    if (listener != nullptr)
+        USBHostManager::getInstance().removeListener(listener);
+
+    const InputMode previousMode = inputMode;
+    destroyDriver();
+    if (!createDriver(mode)) { // no driver for that mode, bring the old one back
+        mode = previousMode;
+        createDriver(mode);
+    }
     driver->initialize();
+    driver->get_class_driver()->init();
     inputMode = mode;
 
-    // Start the TinyUSB Device functionality
-    tud_init(TUD_OPT_RHPORT);
+    Storage::getInstance().SetConfigMode(mode == INPUT_MODE_CONFIG);
+    if (mode == INPUT_MODE_CONFIG)
+        ConfigManager::getInstance().setup(CONFIG_TYPE_WEB);
+
+    // Hand the new driver to core1 and wait until its aux side is up
+    const uint32_t gen = generation.load() + 1;
+    generation.store(gen);
+    swapping.store(false);
+    while (auxGeneration.load() != gen)
+        tight_loop_contents();
+
+    // The host sees a new device: bus reset, then enumeration against the new driver's descriptors
+    tud_connect();
+    return mode != previousMode;
 }
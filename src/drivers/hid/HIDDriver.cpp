@@ -6,6 +6,33 @@
 #include "drivers/hid/HIDDriver.h"
 #include "drivers/hid/HIDDescriptors.h"
 #include "drivers/shared/driverhelper.h"
+#include "drivers/shared/reportencoder.h"
+
+// button bitfield (14 bits + 2 padding) followed by the direction byte
+static constexpr ReportBit hidButtonBits[] = {
+	{ GAMEPAD_MASK_B3, 1U << 0 },   // square
+	{ GAMEPAD_MASK_B1, 1U << 1 },   // cross
+	{ GAMEPAD_MASK_B2, 1U << 2 },   // circle
+	{ GAMEPAD_MASK_B4, 1U << 3 },   // triangle
+	{ GAMEPAD_MASK_L1, 1U << 4 },
+	{ GAMEPAD_MASK_R1, 1U << 5 },
+	{ GAMEPAD_MASK_L2, 1U << 6 },
+	{ GAMEPAD_MASK_R2, 1U << 7 },
+	{ GAMEPAD_MASK_S1, 1U << 8 },   // select
+	{ GAMEPAD_MASK_S2, 1U << 9 },   // start
+	{ GAMEPAD_MASK_L3, 1U << 10 },
+	{ GAMEPAD_MASK_R3, 1U << 11 },
+	{ GAMEPAD_MASK_A1, 1U << 12 },  // ps
+	{ GAMEPAD_MASK_A2, 1U << 13 },  // touchpad
+};
+
+static constexpr ReportHat hidHat = {
+	HID_HAT_UP, HID_HAT_UPRIGHT, HID_HAT_RIGHT, HID_HAT_DOWNRIGHT,
+	HID_HAT_DOWN, HID_HAT_DOWNLEFT, HID_HAT_LEFT, HID_HAT_UPLEFT,
+	HID_HAT_NOTHING, 16
+};
+
+static constexpr ReportEncoder<uint32_t> hidEncoder(hidButtonBits, hidHat);
 
 // Magic byte sequence to enable PS button on PS3
 static const uint8_t ps3_magic_init_bytes[8] = {0x21, 0x26, 0x01, 0x07, 0x00, 0x00, 0x00, 0x00};
@@ -35,6 +62,8 @@ void HIDDriver::initialize() {
 		.triangle_axis = 0x00, .circle_axis = 0x00, .cross_axis = 0x00, .square_axis = 0x00,
 		.l1_axis = 0x00, .r1_axis = 0x00, .l2_axis = 0x00, .r2_axis = 0x00
 	};
+	lastState = unbuiltGamepadState();
+	reportCommitted = false;
 
 	class_driver = {
 	#if CFG_TUSB_DEBUG >= 2
@@ -51,71 +80,47 @@ void HIDDriver::initialize() {
 
 // Generate HID report from gamepad and send to TUSB Device
 void HIDDriver::process(Gamepad * gamepad, uint8_t * outBuffer) {
-	switch (gamepad->state.dpad & GAMEPAD_MASK_DPAD)
-	{
-		case GAMEPAD_MASK_UP:                        hidReport.direction = HID_HAT_UP;        break;
-		case GAMEPAD_MASK_UP | GAMEPAD_MASK_RIGHT:   hidReport.direction = HID_HAT_UPRIGHT;   break;
-		case GAMEPAD_MASK_RIGHT:                     hidReport.direction = HID_HAT_RIGHT;     break;
-		case GAMEPAD_MASK_DOWN | GAMEPAD_MASK_RIGHT: hidReport.direction = HID_HAT_DOWNRIGHT; break;
-		case GAMEPAD_MASK_DOWN:                      hidReport.direction = HID_HAT_DOWN;      break;
-		case GAMEPAD_MASK_DOWN | GAMEPAD_MASK_LEFT:  hidReport.direction = HID_HAT_DOWNLEFT;  break;
-		case GAMEPAD_MASK_LEFT:                      hidReport.direction = HID_HAT_LEFT;      break;
-		case GAMEPAD_MASK_UP | GAMEPAD_MASK_LEFT:    hidReport.direction = HID_HAT_UPLEFT;    break;
-		default:                                     hidReport.direction = HID_HAT_NOTHING;   break;
-	}
+	if (!sameGamepadState(gamepad->state, lastState)) {
+		lastState = gamepad->state;
+
+		storeReportBits(reinterpret_cast<uint8_t *>(&hidReport), hidEncoder.encode(gamepad->state), 24);
+
+		hidReport.l_x_axis = static_cast<uint8_t>(gamepad->state.lx >> 8);
+		hidReport.l_y_axis = static_cast<uint8_t>(gamepad->state.ly >> 8);
+		hidReport.r_x_axis = static_cast<uint8_t>(gamepad->state.rx >> 8);
+		hidReport.r_y_axis = static_cast<uint8_t>(gamepad->state.ry >> 8);
+
+		if (gamepad->hasAnalogTriggers)
+		{
+			hidReport.l2_axis = gamepad->state.lt;
+			hidReport.r2_axis = gamepad->state.rt;
+		} else {
+			hidReport.l2_axis = gamepad->pressedL2() ? 0xFF : 0;
+			hidReport.r2_axis = gamepad->pressedR2() ? 0xFF : 0;
+		}
 
-	hidReport.cross_btn    = gamepad->pressedB1();
-	hidReport.circle_btn   = gamepad->pressedB2();
-	hidReport.square_btn   = gamepad->pressedB3();
-	hidReport.triangle_btn = gamepad->pressedB4();
-	hidReport.l1_btn       = gamepad->pressedL1();
-	hidReport.r1_btn       = gamepad->pressedR1();
-	hidReport.l2_btn       = gamepad->pressedL2();
-	hidReport.r2_btn       = gamepad->pressedR2();
-	hidReport.select_btn   = gamepad->pressedS1();
-	hidReport.start_btn    = gamepad->pressedS2();
-	hidReport.l3_btn       = gamepad->pressedL3();
-	hidReport.r3_btn       = gamepad->pressedR3();
-	hidReport.ps_btn       = gamepad->pressedA1();
-	hidReport.tp_btn       = gamepad->pressedA2();
-
-	hidReport.l_x_axis = static_cast<uint8_t>(gamepad->state.lx >> 8);
-	hidReport.l_y_axis = static_cast<uint8_t>(gamepad->state.ly >> 8);
-	hidReport.r_x_axis = static_cast<uint8_t>(gamepad->state.rx >> 8);
-	hidReport.r_y_axis = static_cast<uint8_t>(gamepad->state.ry >> 8);
-
-	if (gamepad->hasAnalogTriggers)
-	{
-		hidReport.l2_axis = gamepad->state.lt;
-		hidReport.r2_axis = gamepad->state.rt;
-	} else {
-		hidReport.l2_axis = gamepad->pressedL2() ? 0xFF : 0;
-		hidReport.r2_axis = gamepad->pressedR2() ? 0xFF : 0;
+		hidReport.triangle_axis =	gamepad->pressedB4() ? 0xFF : 0;
+		hidReport.circle_axis =		gamepad->pressedB2() ? 0xFF : 0;
+		hidReport.cross_axis =		gamepad->pressedB1() ? 0xFF : 0;
+		hidReport.square_axis =		gamepad->pressedB3() ? 0xFF : 0;
+		hidReport.l1_axis =		gamepad->pressedL1() ? 0xFF : 0;
+		hidReport.r1_axis =		gamepad->pressedR1() ? 0xFF : 0;
+		hidReport.right_axis =		gamepad->state.dpad & GAMEPAD_MASK_RIGHT ? 0xFF : 0;
+		hidReport.left_axis =		gamepad->state.dpad & GAMEPAD_MASK_LEFT ? 0xFF : 0;
+		hidReport.up_axis =		gamepad->state.dpad & GAMEPAD_MASK_UP ? 0xFF : 0;
+		hidReport.down_axis =		gamepad->state.dpad & GAMEPAD_MASK_DOWN ? 0xFF : 0;
+
+		reportCommitted = memcmp(last_report, &hidReport, sizeof(hidReport)) == 0;
 	}
 
-	hidReport.triangle_axis =	gamepad->pressedB4() ? 0xFF : 0;
-	hidReport.circle_axis =		gamepad->pressedB2() ? 0xFF : 0;
-	hidReport.cross_axis =		gamepad->pressedB1() ? 0xFF : 0;
-	hidReport.square_axis =		gamepad->pressedB3() ? 0xFF : 0;
-	hidReport.l1_axis =		gamepad->pressedL1() ? 0xFF : 0;
-	hidReport.r1_axis =		gamepad->pressedR1() ? 0xFF : 0;
-	hidReport.right_axis =		gamepad->state.dpad & GAMEPAD_MASK_RIGHT ? 0xFF : 0;
-	hidReport.left_axis =		gamepad->state.dpad & GAMEPAD_MASK_LEFT ? 0xFF : 0;
-	hidReport.up_axis =		gamepad->state.dpad & GAMEPAD_MASK_UP ? 0xFF : 0;
-	hidReport.down_axis =		gamepad->state.dpad & GAMEPAD_MASK_DOWN ? 0xFF : 0;
-
 	// Wake up TinyUSB device
 	if (tud_suspended())
 		tud_remote_wakeup();
 
-	void * report = &hidReport;
-	uint16_t report_size = sizeof(hidReport);
-	if (memcmp(last_report, report, report_size) != 0)
-	{
-		// HID ready + report sent, copy previous report
-		if (tud_hid_ready() && tud_hid_report(0, report, report_size) == true ) {
-			memcpy(last_report, report, report_size);
-		}
+	// HID ready + report sent, copy previous report
+	if (!reportCommitted && tud_hid_ready() && tud_hid_report(0, &hidReport, sizeof(hidReport)) == true ) {
+		memcpy(last_report, &hidReport, sizeof(hidReport));
+		reportCommitted = true;
 	}
 }
 
@@ -10,6 +10,8 @@
 
 #include "enums.pb.h"
 
+#include "hardware/timer.h"
+
 #include "mbedtls/error.h"
 #include "mbedtls/rsa.h"
 #include "mbedtls/sha256.h"
@@ -49,6 +51,8 @@ void PS4Auth::initialize() {
         DELETE_CONFIG_MPI(E)
         DELETE_CONFIG_MPI(P)
         DELETE_CONFIG_MPI(Q)
+        valid_signer = valid_rsa && setupSigner();
+        signer_reset = false;
         ps4_keys_signature_ready = false;
         listener = nullptr;
 
@@ -85,44 +89,56 @@ void PS4Auth::process(PS4State pState, uint8_t pNonceId, uint8_t * pNonceBuffer)
             return;
         }
 
+        // A reset from core0 or a new nonce abandons any signature in progress
+        if ( signer_reset || pState != PS4State::nonce_ready ) {
+            signer_reset = false;
+            signer.reset();
+        }
+
         // Check to see if the PS4 Authentication needs work
         if ( pState == PS4State::nonce_ready && ps4_keys_signature_ready == false ) {
-            const PS4Options& options = Storage::getInstance().getAddonOptions().ps4Options;
-            int rss_error = 0;
-
-            uint8_t hashed_nonce[32];
-
-            // Sign the nonce now that we got it!
-            //
-            if ( mbedtls_sha256_ret(pNonceBuffer, 256, hashed_nonce, 0) < 0 ) {
-                return;
-            }
-
-            rss_error = mbedtls_rsa_rsassa_pss_sign(&rsa_context, rng, nullptr,
-                    MBEDTLS_RSA_PRIVATE, MBEDTLS_MD_SHA256,
-                    32, hashed_nonce,
-                    ps4_auth_buffer);
-
-            if ( rss_error < 0 ) {
-                return;
+            if ( valid_signer ) {
+                // Sign the nonce in slices so core1 keeps servicing everything else
+                if ( signer.getState() == PS4SignerState::signer_idle ) {
+                    uint8_t hashed_nonce[32];
+                    if ( mbedtls_sha256_ret(pNonceBuffer, 256, hashed_nonce, 0) < 0 ) {
+                        return;
+                    }
+                    signer.start(hashed_nonce);
+                    return;
+                }
+
+                uint32_t sliceStart = time_us_32();
+                bool done = false;
+                while ( !done && (time_us_32() - sliceStart) < PS4_KEYS_SLICE_US ) {
+                    done = signer.step();
+                }
+                if ( !done ) {
+                    return;
+                }
+                signer.getSignature(ps4_auth_buffer);
+                signer.reset();
+            } else {
+                int rss_error = 0;
+                uint8_t hashed_nonce[32];
+
+                // Sign the nonce now that we got it!
+                //
+                if ( mbedtls_sha256_ret(pNonceBuffer, 256, hashed_nonce, 0) < 0 ) {
+                    return;
+                }
+
+                rss_error = mbedtls_rsa_rsassa_pss_sign(&rsa_context, rng, nullptr,
+                        MBEDTLS_RSA_PRIVATE, MBEDTLS_MD_SHA256,
+                        32, hashed_nonce,
+                        ps4_auth_buffer);
+
+                if ( rss_error < 0 ) {
+                    return;
+                }
             }
-            // copy the parts into our authentication buffer
-            size_t offset = 256;
-            memcpy(&ps4_auth_buffer[offset], options.serial.bytes, 16);
-            offset += 16;
-            mbedtls_rsa_export_raw(
-                &rsa_context,
-                &ps4_auth_buffer[offset], 256,
-                nullptr, 0,
-                nullptr, 0,
-                nullptr, 0,
-                &ps4_auth_buffer[offset+256], 256
-            );
-            offset += 512;
-            memcpy(&ps4_auth_buffer[offset], options.signature.bytes, 256);
-            offset += 256;
-            memset(&ps4_auth_buffer[offset], 0, 24);
 
+            finishAuthBuffer();
             ps4_keys_signature_ready = true; // auth buffer is ready
         }
     } else if (authType == InputModeAuthType::INPUT_MODE_AUTH_TYPE_USB ) {
@@ -130,6 +146,72 @@ void PS4Auth::process(PS4State pState, uint8_t pNonceId, uint8_t * pNonceBuffer)
     }
 }
 
+// Hand the CRT parameters to the resumable signer, falls back to mbedtls if the key does not fit it
+// or the signer disagrees with mbedtls
+bool PS4Auth::setupSigner() {
+    uint8_t p[PS4_RSA_PRIME_SIZE], q[PS4_RSA_PRIME_SIZE];
+    uint8_t dp[PS4_RSA_PRIME_SIZE], dq[PS4_RSA_PRIME_SIZE], qp[PS4_RSA_PRIME_SIZE];
+    mbedtls_mpi DP, DQ, QP;
+    bool result = false;
+
+    mbedtls_mpi_init(&DP);
+    mbedtls_mpi_init(&DQ);
+    mbedtls_mpi_init(&QP);
+    if ( mbedtls_rsa_get_len(&rsa_context) == PS4_RSA_SIGNATURE_SIZE &&
+            mbedtls_rsa_export_raw(&rsa_context, nullptr, 0, p, sizeof(p), q, sizeof(q), nullptr, 0, nullptr, 0) == 0 &&
+            mbedtls_rsa_export_crt(&rsa_context, &DP, &DQ, &QP) == 0 &&
+            mbedtls_mpi_write_binary(&DP, dp, sizeof(dp)) == 0 &&
+            mbedtls_mpi_write_binary(&DQ, dq, sizeof(dq)) == 0 &&
+            mbedtls_mpi_write_binary(&QP, qp, sizeof(qp)) == 0 ) {
+        result = signer.setKey(p, q, dp, dq, qp);
+    }
+    mbedtls_mpi_free(&DP);
+    mbedtls_mpi_free(&DQ);
+    mbedtls_mpi_free(&QP);
+
+    // Known-answer check: the signer only replaces mbedtls once both give the same
+    // private key result for a fixed message, the auth buffer is free scratch space here
+    if ( result ) {
+        uint8_t * message = &ps4_auth_buffer[0];
+        uint8_t * expected = &ps4_auth_buffer[PS4_RSA_SIGNATURE_SIZE];
+        uint8_t * actual = &ps4_auth_buffer[PS4_RSA_SIGNATURE_SIZE * 2];
+        for (uint16_t i = 0; i < PS4_RSA_SIGNATURE_SIZE; i++) {
+            message[i] = i; // leading zero keeps it below N
+        }
+        result = signer.startRaw(message);
+        while ( result && !signer.step() );
+        signer.getSignature(actual);
+        signer.reset();
+        result = result &&
+            mbedtls_rsa_private(&rsa_context, rng, nullptr, message, expected) == 0 &&
+            memcmp(expected, actual, PS4_RSA_SIGNATURE_SIZE) == 0;
+        memset(ps4_auth_buffer, 0, sizeof(ps4_auth_buffer));
+    }
+    return result;
+}
+
+// Everything after the nonce signature is fixed per key
+void PS4Auth::finishAuthBuffer() {
+    const PS4Options& options = Storage::getInstance().getAddonOptions().ps4Options;
+
+    // copy the parts into our authentication buffer
+    size_t offset = 256;
+    memcpy(&ps4_auth_buffer[offset], options.serial.bytes, 16);
+    offset += 16;
+    mbedtls_rsa_export_raw(
+        &rsa_context,
+        &ps4_auth_buffer[offset], 256,
+        nullptr, 0,
+        nullptr, 0,
+        nullptr, 0,
+        &ps4_auth_buffer[offset+256], 256
+    );
+    offset += 512;
+    memcpy(&ps4_auth_buffer[offset], options.signature.bytes, 256);
+    offset += 256;
+    memset(&ps4_auth_buffer[offset], 0, 24);
+}
+
 bool PS4Auth::getAuthReady() {
     if (authType == InputModeAuthType::INPUT_MODE_AUTH_TYPE_KEYS ) {
         return ps4_keys_signature_ready;
@@ -141,6 +223,7 @@ bool PS4Auth::getAuthReady() {
 
 void PS4Auth::resetAuth() {
     if (authType == InputModeAuthType::INPUT_MODE_AUTH_TYPE_KEYS ) {
+        signer_reset = true;
         ps4_keys_signature_ready = false;
     } else if (authType == InputModeAuthType::INPUT_MODE_AUTH_TYPE_USB ) {
         ((PS4AuthUSBListener*)listener)->resetHostAuth();
@@ -0,0 +1,359 @@
+#include "drivers/ps4/PS4AuthSigner.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "mbedtls/sha256.h"
+
+#define PS4_PSS_HASH_SIZE 32
+#define PS4_PSS_SALT_SIZE 32
+
+static void bytesToLimbs(const uint8_t * bytes, uint32_t * limbs, size_t limbCount) {
+    size_t byteCount = limbCount * sizeof(uint32_t);
+    for (size_t i = 0; i < limbCount; i++) {
+        const uint8_t * b = &bytes[byteCount - (i + 1) * sizeof(uint32_t)];
+        limbs[i] = ((uint32_t)b[0] << 24) | ((uint32_t)b[1] << 16) | ((uint32_t)b[2] << 8) | b[3];
+    }
+}
+
+static void limbsToBytes(const uint32_t * limbs, uint8_t * bytes, size_t limbCount) {
+    size_t byteCount = limbCount * sizeof(uint32_t);
+    for (size_t i = 0; i < limbCount; i++) {
+        uint8_t * b = &bytes[byteCount - (i + 1) * sizeof(uint32_t)];
+        b[0] = limbs[i] >> 24;
+        b[1] = limbs[i] >> 16;
+        b[2] = limbs[i] >> 8;
+        b[3] = limbs[i];
+    }
+}
+
+static int compareLimbs(const uint32_t * a, const uint32_t * b) {
+    for (int i = PS4_RSA_PRIME_LIMBS - 1; i >= 0; i--) {
+        if (a[i] != b[i])
+            return (a[i] > b[i]) ? 1 : -1;
+    }
+    return 0;
+}
+
+// r = a - b, returns the borrow
+static uint32_t subLimbs(uint32_t * r, const uint32_t * a, const uint32_t * b) {
+    uint32_t borrow = 0;
+    for (size_t i = 0; i < PS4_RSA_PRIME_LIMBS; i++) {
+        uint64_t diff = (uint64_t)a[i] - b[i] - borrow;
+        r[i] = (uint32_t)diff;
+        borrow = (diff >> 32) ? 1 : 0;
+    }
+    return borrow;
+}
+
+// r = a + b, returns the carry
+static uint32_t addLimbs(uint32_t * r, const uint32_t * a, const uint32_t * b) {
+    uint32_t carry = 0;
+    for (size_t i = 0; i < PS4_RSA_PRIME_LIMBS; i++) {
+        uint64_t sum = (uint64_t)a[i] + b[i] + carry;
+        r[i] = (uint32_t)sum;
+        carry = sum >> 32;
+    }
+    return carry;
+}
+
+// Reduce a value below 2^1024 by a 1024-bit modulus (top bit set), one subtraction is enough
+static void reduceOnce(uint32_t * a, const uint32_t * mod) {
+    if (compareLimbs(a, mod) >= 0)
+        subLimbs(a, a, mod);
+}
+
+// One outer pass of CIOS Montgomery multiplication, t = (t + a * bi) * 2^-32 mod p
+static void montRow(uint32_t * t, const uint32_t * a, uint32_t bi, const ps4_rsa_prime_t * prime) {
+    uint64_t carry = 0;
+    for (size_t j = 0; j < PS4_RSA_PRIME_LIMBS; j++) {
+        uint64_t sum = (uint64_t)a[j] * bi + t[j] + carry;
+        t[j] = (uint32_t)sum;
+        carry = sum >> 32;
+    }
+    uint64_t sum = (uint64_t)t[PS4_RSA_PRIME_LIMBS] + carry;
+    t[PS4_RSA_PRIME_LIMBS] = (uint32_t)sum;
+    t[PS4_RSA_PRIME_LIMBS + 1] = sum >> 32;
+
+    uint32_t m = t[0] * prime->n0inv;
+    carry = ((uint64_t)m * prime->mod[0] + t[0]) >> 32;
+    for (size_t j = 1; j < PS4_RSA_PRIME_LIMBS; j++) {
+        sum = (uint64_t)m * prime->mod[j] + t[j] + carry;
+        t[j - 1] = (uint32_t)sum;
+        carry = sum >> 32;
+    }
+    sum = (uint64_t)t[PS4_RSA_PRIME_LIMBS] + carry;
+    t[PS4_RSA_PRIME_LIMBS - 1] = (uint32_t)sum;
+    t[PS4_RSA_PRIME_LIMBS] = t[PS4_RSA_PRIME_LIMBS + 1] + (uint32_t)(sum >> 32);
+}
+
+static void montFinish(uint32_t * r, uint32_t * t, const ps4_rsa_prime_t * prime) {
+    if (t[PS4_RSA_PRIME_LIMBS] != 0 || compareLimbs(t, prime->mod) >= 0)
+        subLimbs(t, t, prime->mod);
+    memcpy(r, t, PS4_RSA_PRIME_SIZE);
+}
+
+// r = a * b * R^-1 mod p in one go, only used while setting up the key
+static void montMul(uint32_t * r, const uint32_t * a, const uint32_t * b, const ps4_rsa_prime_t * prime) {
+    uint32_t t[PS4_RSA_PRIME_LIMBS + 2] = { };
+    for (size_t i = 0; i < PS4_RSA_PRIME_LIMBS; i++)
+        montRow(t, a, b[i], prime);
+    montFinish(r, t, prime);
+}
+
+static const uint32_t montOne[PS4_RSA_PRIME_LIMBS] = { 1 };
+
+static bool setupPrime(ps4_rsa_prime_t * prime, const uint8_t * mod, const uint8_t * exp) {
+    bytesToLimbs(mod, prime->mod, PS4_RSA_PRIME_LIMBS);
+    bytesToLimbs(exp, prime->exp, PS4_RSA_PRIME_LIMBS);
+
+    // Single-subtraction reductions rely on a full 1024-bit odd modulus
+    if ((prime->mod[PS4_RSA_PRIME_LIMBS - 1] & 0x80000000) == 0 || (prime->mod[0] & 1) == 0)
+        return false;
+
+    // -p^-1 mod 2^32 by Newton iteration
+    uint32_t inv = prime->mod[0];
+    for (uint8_t i = 0; i < 5; i++)
+        inv *= 2 - prime->mod[0] * inv;
+    prime->n0inv = 0 - inv;
+
+    // R mod p = 2^1024 - p, doubled 1024 times gives R^2 mod p
+    uint32_t zero[PS4_RSA_PRIME_LIMBS] = { };
+    subLimbs(prime->rr, zero, prime->mod);
+    for (uint16_t i = 0; i < PS4_RSA_PRIME_SIZE * 8; i++) {
+        uint32_t carry = addLimbs(prime->rr, prime->rr, prime->rr);
+        if (carry || compareLimbs(prime->rr, prime->mod) >= 0)
+            subLimbs(prime->rr, prime->rr, prime->mod);
+    }
+
+    prime->expBits = 0;
+    for (int i = PS4_RSA_PRIME_LIMBS - 1; i >= 0 && prime->expBits == 0; i--) {
+        for (int bit = 31; bit >= 0; bit--) {
+            if (prime->exp[i] & (1u << bit)) {
+                prime->expBits = i * 32 + bit + 1;
+                break;
+            }
+        }
+    }
+    return prime->expBits > 0;
+}
+
+bool PS4AuthSigner::setKey(const uint8_t * p, const uint8_t * q, const uint8_t * dp, const uint8_t * dq, const uint8_t * qp) {
+    keyValid = false;
+    state = PS4SignerState::signer_idle;
+
+    if (!setupPrime(&primeP, p, dp) || !setupPrime(&primeQ, q, dq))
+        return false;
+
+    // qInv * R mod p lets the CRT recombination use a single Montgomery step
+    bytesToLimbs(qp, qInvR, PS4_RSA_PRIME_LIMBS);
+    reduceOnce(qInvR, primeP.mod);
+    montMul(qInvR, qInvR, primeP.rr, &primeP);
+
+    // the encoded message keeps the top bit clear when N is a full 2048 bits
+    uint32_t n[PS4_RSA_PRIME_LIMBS * 2] = { };
+    for (size_t i = 0; i < PS4_RSA_PRIME_LIMBS; i++) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < PS4_RSA_PRIME_LIMBS; j++) {
+            uint64_t sum = (uint64_t)primeP.mod[j] * primeQ.mod[i] + n[i + j] + carry;
+            n[i + j] = (uint32_t)sum;
+            carry = sum >> 32;
+        }
+        n[i + PS4_RSA_PRIME_LIMBS] = (uint32_t)carry;
+    }
+    emTopMask = (n[PS4_RSA_PRIME_LIMBS * 2 - 1] & 0x80000000) ? 0x7F : 0x3F;
+
+    keyValid = true;
+    return true;
+}
+
+void PS4AuthSigner::encodePSS(const uint8_t * hash, uint8_t * out) {
+    const size_t dbLength = PS4_RSA_SIGNATURE_SIZE - PS4_PSS_HASH_SIZE - 1;
+    uint8_t salt[PS4_PSS_SALT_SIZE];
+    uint8_t block[8 + PS4_PSS_HASH_SIZE + PS4_PSS_SALT_SIZE];
+
+    for (size_t i = 0; i < sizeof(salt); i++)
+        salt[i] = rand();
+
+    // DB = PS || 0x01 || salt
+    memset(out, 0, PS4_RSA_SIGNATURE_SIZE);
+    out[dbLength - PS4_PSS_SALT_SIZE - 1] = 0x01;
+    memcpy(&out[dbLength - PS4_PSS_SALT_SIZE], salt, PS4_PSS_SALT_SIZE);
+
+    // H = SHA-256(0x00 * 8 || mHash || salt)
+    memset(block, 0, 8);
+    memcpy(&block[8], hash, PS4_PSS_HASH_SIZE);
+    memcpy(&block[8 + PS4_PSS_HASH_SIZE], salt, PS4_PSS_SALT_SIZE);
+    mbedtls_sha256_ret(block, sizeof(block), &out[dbLength], 0);
+
+    // maskedDB = DB ^ MGF1(H)
+    uint8_t mask[PS4_PSS_HASH_SIZE];
+    memcpy(block, &out[dbLength], PS4_PSS_HASH_SIZE);
+    for (uint32_t counter = 0; counter * PS4_PSS_HASH_SIZE < dbLength; counter++) {
+        block[PS4_PSS_HASH_SIZE] = counter >> 24;
+        block[PS4_PSS_HASH_SIZE + 1] = counter >> 16;
+        block[PS4_PSS_HASH_SIZE + 2] = counter >> 8;
+        block[PS4_PSS_HASH_SIZE + 3] = counter;
+        mbedtls_sha256_ret(block, PS4_PSS_HASH_SIZE + 4, mask, 0);
+        for (size_t i = 0; i < PS4_PSS_HASH_SIZE && (counter * PS4_PSS_HASH_SIZE + i) < dbLength; i++)
+            out[counter * PS4_PSS_HASH_SIZE + i] ^= mask[i];
+    }
+
+    // clear the top bits so the encoded message stays below N
+    out[0] &= emTopMask;
+    out[PS4_RSA_SIGNATURE_SIZE - 1] = 0xBC;
+}
+
+void PS4AuthSigner::startMul(uint32_t * r, const uint32_t * a, const uint32_t * b, const ps4_rsa_prime_t * prime) {
+    memset(mulT, 0, sizeof(mulT));
+    mulR = r;
+    mulA = a;
+    mulB = b;
+    mulPrime = prime;
+    mulRow = 0;
+    mulPending = true;
+}
+
+void PS4AuthSigner::stepMul() {
+    montRow(mulT, mulA, mulB[mulRow], mulPrime);
+    if (++mulRow == PS4_RSA_PRIME_LIMBS) {
+        montFinish(mulR, mulT, mulPrime);
+        mulPending = false;
+    }
+}
+
+// Schedules the next multiplication of m^d mod p, returns true once result holds it
+bool PS4AuthSigner::stepPrime(ps4_rsa_prime_t * prime, uint32_t * result) {
+    switch (phase) {
+        case PS4SignerPhase::phase_reduce:
+            // message mod p = (high * R + low) mod p
+            memcpy(low, em, PS4_RSA_PRIME_SIZE);
+            memcpy(high, &em[PS4_RSA_PRIME_LIMBS], PS4_RSA_PRIME_SIZE);
+            reduceOnce(low, prime->mod);
+            reduceOnce(high, prime->mod);
+            startMul(high, high, prime->rr, prime);
+            phase = PS4SignerPhase::phase_base;
+            break;
+        case PS4SignerPhase::phase_base:
+            if (addLimbs(base, high, low) || compareLimbs(base, prime->mod) >= 0)
+                subLimbs(base, base, prime->mod);
+            startMul(base, base, prime->rr, prime);
+            phase = PS4SignerPhase::phase_one;
+            break;
+        case PS4SignerPhase::phase_one:
+            startMul(acc, prime->rr, montOne, prime);
+            bitIndex = prime->expBits - 1;
+            phase = PS4SignerPhase::phase_square;
+            break;
+        case PS4SignerPhase::phase_square:
+            startMul(acc, acc, acc, prime);
+            phase = PS4SignerPhase::phase_multiply;
+            break;
+        case PS4SignerPhase::phase_multiply:
+            if (prime->exp[bitIndex / 32] & (1u << (bitIndex % 32)))
+                startMul(acc, acc, base, prime);
+            phase = (--bitIndex >= 0) ? PS4SignerPhase::phase_square : PS4SignerPhase::phase_result;
+            break;
+        case PS4SignerPhase::phase_result:
+            startMul(result, acc, montOne, prime);
+            phase = PS4SignerPhase::phase_prime_done;
+            break;
+        default:
+            return true;
+    }
+    return false;
+}
+
+// CRT recombination, returns true once the signature is complete
+bool PS4AuthSigner::stepCombine() {
+    switch (phase) {
+        case PS4SignerPhase::phase_diff:
+            // h = qInv * (m1 - m2) mod p
+            memcpy(diff, m2, PS4_RSA_PRIME_SIZE);
+            reduceOnce(diff, primeP.mod);
+            if (subLimbs(diff, m1, diff))
+                addLimbs(diff, diff, primeP.mod);
+            startMul(diff, diff, qInvR, &primeP);
+            memset(signature, 0, sizeof(signature));
+            productRow = 0;
+            phase = PS4SignerPhase::phase_product;
+            break;
+        case PS4SignerPhase::phase_product: {
+            uint64_t carry = 0;
+            for (size_t j = 0; j < PS4_RSA_PRIME_LIMBS; j++) {
+                uint64_t sum = (uint64_t)diff[j] * primeQ.mod[productRow] + signature[productRow + j] + carry;
+                signature[productRow + j] = (uint32_t)sum;
+                carry = sum >> 32;
+            }
+            signature[productRow + PS4_RSA_PRIME_LIMBS] = (uint32_t)carry;
+            if (++productRow == PS4_RSA_PRIME_LIMBS)
+                phase = PS4SignerPhase::phase_add;
+            break;
+        }
+        case PS4SignerPhase::phase_add: {
+            uint64_t carry = 0;
+            for (size_t i = 0; i < PS4_RSA_PRIME_LIMBS * 2; i++) {
+                uint64_t sum = (uint64_t)signature[i] + (i < PS4_RSA_PRIME_LIMBS ? m2[i] : 0) + carry;
+                signature[i] = (uint32_t)sum;
+                carry = sum >> 32;
+            }
+            return true;
+        }
+        default:
+            break;
+    }
+    return false;
+}
+
+bool PS4AuthSigner::start(const uint8_t * hash) {
+    if (!keyValid)
+        return false;
+
+    uint8_t encoded[PS4_RSA_SIGNATURE_SIZE];
+    encodePSS(hash, encoded);
+    return startRaw(encoded);
+}
+
+bool PS4AuthSigner::startRaw(const uint8_t * message) {
+    if (!keyValid)
+        return false;
+
+    bytesToLimbs(message, em, PS4_RSA_PRIME_LIMBS * 2);
+    mulPending = false;
+    phase = PS4SignerPhase::phase_reduce;
+    state = PS4SignerState::signer_exp_p;
+    return true;
+}
+
+// Each call does at most one cheap phase change and one limb pass of a multiplication
+bool PS4AuthSigner::step() {
+    if (!mulPending) {
+        switch (state) {
+            case PS4SignerState::signer_exp_p:
+                if (stepPrime(&primeP, m1)) {
+                    phase = PS4SignerPhase::phase_reduce;
+                    state = PS4SignerState::signer_exp_q;
+                }
+                break;
+            case PS4SignerState::signer_exp_q:
+                if (stepPrime(&primeQ, m2)) {
+                    phase = PS4SignerPhase::phase_diff;
+                    state = PS4SignerState::signer_combine;
+                }
+                break;
+            case PS4SignerState::signer_combine:
+                if (stepCombine())
+                    state = PS4SignerState::signer_done;
+                break;
+            default:
+                break;
+        }
+    }
+    if (mulPending)
+        stepMul();
+    return state == PS4SignerState::signer_done;
+}
+
+void PS4AuthSigner::getSignature(uint8_t * out) {
+    limbsToBytes(signature, out, PS4_RSA_PRIME_LIMBS * 2);
+}
@@ -1,5 +1,6 @@
 #include "drivers/ps4/PS4Driver.h"
 #include "drivers/shared/driverhelper.h"
+#include "drivers/shared/reportencoder.h"
 #include "storagemanager.h"
 #include "CRC32.h"
 #include "mbedtls/error.h"
@@ -16,11 +17,45 @@
 // force a report to be sent every X ms
 #define PS4_KEEPALIVE_TIMER 5
 
+// 4-bit hat in the low bits, buttons from bit 4
+#define PS4_REPORT_BUTTONS(select, touchpad) { \
+    { GAMEPAD_MASK_B3, 1U << 4 },   /* west */ \
+    { GAMEPAD_MASK_B1, 1U << 5 },   /* south */ \
+    { GAMEPAD_MASK_B2, 1U << 6 },   /* east */ \
+    { GAMEPAD_MASK_B4, 1U << 7 },   /* north */ \
+    { GAMEPAD_MASK_L1, 1U << 8 }, \
+    { GAMEPAD_MASK_R1, 1U << 9 }, \
+    { GAMEPAD_MASK_L2, 1U << 10 }, \
+    { GAMEPAD_MASK_R2, 1U << 11 }, \
+    { select,          1U << 12 }, \
+    { GAMEPAD_MASK_S2, 1U << 13 },  /* start */ \
+    { GAMEPAD_MASK_L3, 1U << 14 }, \
+    { GAMEPAD_MASK_R3, 1U << 15 }, \
+    { GAMEPAD_MASK_A1, 1U << 16 },  /* home */ \
+    { touchpad,        1U << 17 }, \
+}
+
+static constexpr ReportBit ps4ButtonBits[] = PS4_REPORT_BUTTONS(GAMEPAD_MASK_S1, GAMEPAD_MASK_A2);
+static constexpr ReportBit ps4ButtonBitsSwapShare[] = PS4_REPORT_BUTTONS(GAMEPAD_MASK_A2, GAMEPAD_MASK_S1);
+
+static constexpr ReportHat ps4Hat = {
+    PS4_HAT_UP, PS4_HAT_UPRIGHT, PS4_HAT_RIGHT, PS4_HAT_DOWNRIGHT,
+    PS4_HAT_DOWN, PS4_HAT_DOWNLEFT, PS4_HAT_LEFT, PS4_HAT_UPLEFT,
+    PS4_HAT_NOTHING, 0
+};
+
+static constexpr ReportEncoder<uint32_t> ps4Encoder(ps4ButtonBits, ps4Hat);
+static constexpr ReportEncoder<uint32_t> ps4EncoderSwapShare(ps4ButtonBitsSwapShare, ps4Hat);
+
+PS4Driver::~PS4Driver() {
+    delete authDriver;
+}
+
 void PS4Driver::initialize() {
-    //touchpadData = {
-    //	.p1 = 0x00,
-    //	.p2 = 0x00
-    //};
+    // set touchpad to nothing, it never changes after this
+    touchpadData = { };
+    touchpadData.p1.unpressed = 1;
+    touchpadData.p2.unpressed = 1;
 
     ps4Report = {
         .report_id = 0x01,
@@ -37,6 +72,8 @@ void PS4Driver::initialize() {
         .touchpad_data = touchpadData,
         .mystery_2 = { }
     };
+    lastState = unbuiltGamepadState();
+    reportCommitted = false;
 
     class_driver = {
     #if CFG_TUSB_DEBUG >= 2
@@ -78,66 +115,42 @@ void PS4Driver::initializeAux() {
 }
 
 void PS4Driver::process(Gamepad * gamepad, uint8_t * outBuffer) {
-    const GamepadOptions & options = gamepad->getOptions();
-    switch (gamepad->state.dpad & GAMEPAD_MASK_DPAD)
-    {
-        case GAMEPAD_MASK_UP:                        ps4Report.dpad = PS4_HAT_UP;        break;
-        case GAMEPAD_MASK_UP | GAMEPAD_MASK_RIGHT:   ps4Report.dpad = PS4_HAT_UPRIGHT;   break;
-        case GAMEPAD_MASK_RIGHT:                     ps4Report.dpad = PS4_HAT_RIGHT;     break;
-        case GAMEPAD_MASK_DOWN | GAMEPAD_MASK_RIGHT: ps4Report.dpad = PS4_HAT_DOWNRIGHT; break;
-        case GAMEPAD_MASK_DOWN:                      ps4Report.dpad = PS4_HAT_DOWN;      break;
-        case GAMEPAD_MASK_DOWN | GAMEPAD_MASK_LEFT:  ps4Report.dpad = PS4_HAT_DOWNLEFT;  break;
-        case GAMEPAD_MASK_LEFT:                      ps4Report.dpad = PS4_HAT_LEFT;      break;
-        case GAMEPAD_MASK_UP | GAMEPAD_MASK_LEFT:    ps4Report.dpad = PS4_HAT_UPLEFT;    break;
-        default:                                     ps4Report.dpad = PS4_HAT_NOTHING;   break;
-    }
+    if (!sameGamepadState(gamepad->state, lastState)) {
+        const GamepadOptions & options = gamepad->getOptions();
+        lastState = gamepad->state;
+
+        // dpad + 14 buttons, the report counter that follows is left alone
+        const ReportEncoder<uint32_t> & encoder = options.switchTpShareForDs4 ? ps4EncoderSwapShare : ps4Encoder;
+        storeReportBits(reinterpret_cast<uint8_t *>(&ps4Report.right_stick_y) + 1, encoder.encode(gamepad->state), 18);
+
+        ps4Report.left_stick_x = static_cast<uint8_t>(gamepad->state.lx >> 8);
+        ps4Report.left_stick_y = static_cast<uint8_t>(gamepad->state.ly >> 8);
+        ps4Report.right_stick_x = static_cast<uint8_t>(gamepad->state.rx >> 8);
+        ps4Report.right_stick_y = static_cast<uint8_t>(gamepad->state.ry >> 8);
+
+        if (gamepad->hasAnalogTriggers)
+        {
+            ps4Report.left_trigger = gamepad->state.lt;
+            ps4Report.right_trigger = gamepad->state.rt;
+        } else {
+            ps4Report.left_trigger = gamepad->pressedL2() ? 0xFF : 0;
+            ps4Report.right_trigger = gamepad->pressedR2() ? 0xFF : 0;
+        }
 
-    ps4Report.button_south    = gamepad->pressedB1();
-    ps4Report.button_east     = gamepad->pressedB2();
-    ps4Report.button_west     = gamepad->pressedB3();
-    ps4Report.button_north    = gamepad->pressedB4();
-    ps4Report.button_l1       = gamepad->pressedL1();
-    ps4Report.button_r1       = gamepad->pressedR1();
-    ps4Report.button_l2       = gamepad->pressedL2();
-    ps4Report.button_r2       = gamepad->pressedR2();
-    ps4Report.button_select   = options.switchTpShareForDs4 ? gamepad->pressedA2() : gamepad->pressedS1();
-    ps4Report.button_start    = gamepad->pressedS2();
-    ps4Report.button_l3       = gamepad->pressedL3();
-    ps4Report.button_r3       = gamepad->pressedR3();
-    ps4Report.button_home     = gamepad->pressedA1();
-    ps4Report.button_touchpad = options.switchTpShareForDs4 ? gamepad->pressedS1() : gamepad->pressedA2();
-
-    ps4Report.left_stick_x = static_cast<uint8_t>(gamepad->state.lx >> 8);
-    ps4Report.left_stick_y = static_cast<uint8_t>(gamepad->state.ly >> 8);
-    ps4Report.right_stick_x = static_cast<uint8_t>(gamepad->state.rx >> 8);
-    ps4Report.right_stick_y = static_cast<uint8_t>(gamepad->state.ry >> 8);
-
-    if (gamepad->hasAnalogTriggers)
-    {
-        ps4Report.left_trigger = gamepad->state.lt;
-        ps4Report.right_trigger = gamepad->state.rt;
-    } else {
-        ps4Report.left_trigger = gamepad->pressedL2() ? 0xFF : 0;
-        ps4Report.right_trigger = gamepad->pressedR2() ? 0xFF : 0;
+        reportCommitted = memcmp(last_report, &ps4Report, sizeof(ps4Report)) == 0;
     }
 
-    // set touchpad to nothing
-    touchpadData.p1.unpressed = 1;
-    touchpadData.p2.unpressed = 1;
-    ps4Report.touchpad_data = touchpadData;
-
     // Wake up TinyUSB device
     if (tud_suspended())
         tud_remote_wakeup();
 
     uint32_t now = to_ms_since_boot(get_absolute_time());
-    void * report = &ps4Report;
-    uint16_t report_size = sizeof(ps4Report);
-    if (memcmp(last_report, report, report_size) != 0)
+    if (!reportCommitted)
     {
         // HID ready + report sent, copy previous report
-        if (tud_hid_ready() && tud_hid_report(0, report, report_size) == true ) {
-            memcpy(last_report, report, report_size);
+        if (tud_hid_ready() && tud_hid_report(0, &ps4Report, sizeof(ps4Report)) == true ) {
+            memcpy(last_report, &ps4Report, sizeof(ps4Report));
+            reportCommitted = true;
         }
         // keep track of our last successful report, for keepalive purposes
         last_report_timer = now;
@@ -153,11 +166,12 @@ void PS4Driver::process(Gamepad * gamepad, uint8_t * outBuffer) {
             ps4Report.report_counter = last_report_counter;		// report counter is 6 bits
             ps4Report.axis_timing = now;		 		// axis counter is 16 bits
             // the *next* process() will be a forced report (or real user input)
+            reportCommitted = false;
         }
     }
 }
 
-// Called by Core1, PS4 key signing will lock the CPU
+// Called by Core1, PS4 key signing runs in short slices across calls
 void PS4Driver::processAux() {
     // If authentication driver is set AND auth driver can load (usb enabled, i2c enabled, keys loaded, etc.)
     if ( authDriver != nullptr && authDriver->available() ) {
@@ -0,0 +1,394 @@
+#include "drivers/shared/reportdecoder.h"
+
+// Descriptor depth the parser follows, deeper push/pop and collections are still walked but not tracked
+#define DECODER_GLOBAL_STACK 4
+#define DECODER_USAGE_LIST 16
+#define DECODER_REPORT_IDS 8
+
+#define HID_PAGE_DESKTOP     0x01
+#define HID_PAGE_SIMULATION  0x02
+#define HID_PAGE_BUTTON      0x09
+
+#define HID_USAGE_JOYSTICK   0x04
+#define HID_USAGE_GAMEPAD    0x05
+#define HID_USAGE_MULTI_AXIS 0x08
+#define HID_USAGE_X          0x30
+#define HID_USAGE_Y          0x31
+#define HID_USAGE_Z          0x32
+#define HID_USAGE_RX         0x33
+#define HID_USAGE_RY         0x34
+#define HID_USAGE_RZ         0x35
+#define HID_USAGE_HAT        0x39
+#define HID_USAGE_ACCEL      0xC4
+#define HID_USAGE_BRAKE      0xC5
+
+#define BUTTON_RUN_MAX 24
+
+// DirectInput button n+1 -> GamepadState button, the inverse of HIDDriver's report
+static const uint16_t dinputButtons[32] = {
+	GAMEPAD_MASK_B3, GAMEPAD_MASK_B1, GAMEPAD_MASK_B2, GAMEPAD_MASK_B4,
+	GAMEPAD_MASK_L1, GAMEPAD_MASK_R1, GAMEPAD_MASK_L2, GAMEPAD_MASK_R2,
+	GAMEPAD_MASK_S1, GAMEPAD_MASK_S2, GAMEPAD_MASK_L3, GAMEPAD_MASK_R3,
+	GAMEPAD_MASK_A1, GAMEPAD_MASK_A2,
+};
+
+// Hat value from north, clockwise
+static const uint8_t hatDpad[8] = {
+	GAMEPAD_MASK_UP,
+	GAMEPAD_MASK_UP | GAMEPAD_MASK_RIGHT,
+	GAMEPAD_MASK_RIGHT,
+	GAMEPAD_MASK_DOWN | GAMEPAD_MASK_RIGHT,
+	GAMEPAD_MASK_DOWN,
+	GAMEPAD_MASK_DOWN | GAMEPAD_MASK_LEFT,
+	GAMEPAD_MASK_LEFT,
+	GAMEPAD_MASK_UP | GAMEPAD_MASK_LEFT,
+};
+
+// Axis usages while parsing, resolved to a ReportAxis once the whole descriptor is known
+typedef enum : uint8_t {
+	USAGE_X, USAGE_Y, USAGE_Z, USAGE_RX, USAGE_RY, USAGE_RZ, USAGE_ACCEL, USAGE_BRAKE,
+} AxisUsage;
+
+struct DecoderGlobals {
+	uint16_t usagePage;
+	int32_t logicalMin;
+	int32_t logicalMax;
+	uint32_t logicalMaxRaw;
+	uint8_t logicalMaxBytes;
+	uint32_t reportSize;
+	uint32_t reportCount;
+	uint8_t reportId;
+};
+
+static uint32_t itemUnsigned(const uint8_t * data, uint8_t size) {
+	uint32_t value = 0;
+	for (uint8_t i = 0; i < size; i++)
+		value |= (uint32_t)data[i] << (8 * i);
+	return value;
+}
+
+static int32_t itemSigned(const uint8_t * data, uint8_t size) {
+	uint32_t value = itemUnsigned(data, size);
+	if (size == 0 || size == 4)
+		return (int32_t)value;
+	uint8_t unused = 32 - 8 * size;
+	return (int32_t)(value << unused) >> unused;
+}
+
+bool ReportDecoder::compile(const uint8_t * desc, uint16_t len) {
+	fieldCount = 0;
+	reportId = 0;
+	reportBytes = 0;
+
+	DecoderGlobals globals = {};
+	DecoderGlobals globalStack[DECODER_GLOBAL_STACK];
+	uint8_t globalDepth = 0;
+
+	uint16_t usages[DECODER_USAGE_LIST];
+	uint8_t usageCount = 0;
+	uint16_t usageMin = 0, usageMax = 0;
+	bool usageRange = false;
+
+	uint8_t collectionDepth = 0;
+	uint8_t gamepadDepth = 0;   // collection depth of the gamepad application collection, 0 outside it
+
+	// bits used so far in each report
+	uint8_t idList[DECODER_REPORT_IDS] = {};
+	uint32_t idBits[DECODER_REPORT_IDS] = {};
+	uint8_t idCount = 1;        // report 0 is the unnumbered report
+	bool planned = false;       // fields were taken from reportId
+
+	uint16_t pos = 0;
+	while (pos < len) {
+		uint8_t prefix = desc[pos];
+		if (prefix == 0xFE) {
+			// long item, nothing we use
+			if (pos + 1 >= len)
+				break;
+			pos += 3 + desc[pos + 1];
+			continue;
+		}
+		uint8_t size = prefix & 0x03;
+		if (size == 3)
+			size = 4;
+		if (pos + 1 + size > len)
+			break;
+		const uint8_t * data = &desc[pos + 1];
+		uint8_t type = (prefix >> 2) & 0x03;
+		uint8_t tag = prefix >> 4;
+		pos += 1 + size;
+
+		if (type == 1) {
+			// global
+			switch (tag) {
+				case 0x0: globals.usagePage = itemUnsigned(data, size); break;
+				case 0x1: globals.logicalMin = itemSigned(data, size); break;
+				case 0x2:
+					globals.logicalMax = itemSigned(data, size);
+					globals.logicalMaxRaw = itemUnsigned(data, size);
+					globals.logicalMaxBytes = size;
+					break;
+				case 0x7: globals.reportSize = itemUnsigned(data, size); break;
+				case 0x8: globals.reportId = itemUnsigned(data, size); break;
+				case 0x9: globals.reportCount = itemUnsigned(data, size); break;
+				case 0xA:
+					if (globalDepth < DECODER_GLOBAL_STACK)
+						globalStack[globalDepth] = globals;
+					globalDepth++;
+					break;
+				case 0xB:
+					if (globalDepth > 0 && --globalDepth < DECODER_GLOBAL_STACK)
+						globals = globalStack[globalDepth];
+					break;
+				default: break;
+			}
+			continue;
+		}
+
+		if (type == 2) {
+			// local, a 4 byte usage carries its own page in the high half
+			uint32_t value = itemUnsigned(data, size);
+			if (size == 4 && (value >> 16) != globals.usagePage)
+				value = 0xFFFF; // usage from another page, never matched
+			switch (tag) {
+				case 0x0:
+					if (usageCount < DECODER_USAGE_LIST)
+						usages[usageCount++] = value;
+					break;
+				case 0x1: usageMin = value; usageRange = true; break;
+				case 0x2: usageMax = value; usageRange = true; break;
+				default: break;
+			}
+			continue;
+		}
+
+		if (type != 0)
+			continue;
+
+		// main item
+		if (tag == 0xA) {
+			collectionDepth++;
+			bool application = size > 0 && data[0] == 0x01;
+			uint16_t usage = usageCount > 0 ? usages[0] : usageMin;
+			if (gamepadDepth == 0 && application && globals.usagePage == HID_PAGE_DESKTOP &&
+				(usage == HID_USAGE_JOYSTICK || usage == HID_USAGE_GAMEPAD || usage == HID_USAGE_MULTI_AXIS))
+				gamepadDepth = collectionDepth;
+		} else if (tag == 0xC) {
+			if (collectionDepth == gamepadDepth)
+				gamepadDepth = 0;
+			if (collectionDepth > 0)
+				collectionDepth--;
+		} else if (tag == 0x8) {
+			// input
+			uint8_t slot = 0;
+			while (slot < idCount && idList[slot] != globals.reportId)
+				slot++;
+			if (slot == idCount) {
+				if (idCount == DECODER_REPORT_IDS)
+					return false;
+				idList[slot] = globals.reportId;
+				idCount++;
+			}
+
+			// no report of ours comes close, this only keeps the bit positions from wrapping
+			if (globals.reportSize > 0xFF || globals.reportCount > 0xFFFF ||
+				idBits[slot] + globals.reportSize * globals.reportCount > 0xFFFF * 8)
+				return false;
+
+			uint8_t flags = size > 0 ? data[0] : 0;
+			bool usable = gamepadDepth != 0 && !(flags & 0x01) && (flags & 0x02) &&
+				globals.reportSize > 0 && globals.reportSize <= 32 &&
+				(!planned || globals.reportId == reportId);
+
+			// a maximum that only fits unsigned (26 FF 00 is -1 as a 1 byte item) is read unsigned
+			int32_t logicalMax = globals.logicalMax;
+			if (globals.logicalMin >= 0 && logicalMax < globals.logicalMin && globals.logicalMaxBytes < 4)
+				logicalMax = globals.logicalMaxRaw;
+
+			for (uint32_t i = 0; usable && i < globals.reportCount; i++) {
+				uint16_t usage;
+				if (usageCount > 0)
+					usage = usages[i < usageCount ? i : usageCount - 1];
+				else if (usageRange && (uint32_t)usageMin + i <= usageMax)
+					usage = usageMin + i;
+				else
+					break;
+
+				uint32_t bit = idBits[slot] + i * globals.reportSize;
+				uint8_t shift = bit & 7;
+				if (shift + globals.reportSize > 32)
+					continue;
+
+				ReportField field = {};
+				field.byteOffset = bit >> 3;
+				field.shift = shift;
+				field.bytes = (shift + globals.reportSize + 7) >> 3;
+				field.mask = globals.reportSize == 32 ? 0xFFFFFFFF : (1UL << globals.reportSize) - 1;
+				field.signBits = globals.logicalMin < 0 ? 32 - globals.reportSize : 0;
+				field.min = globals.logicalMin;
+				field.range = (uint32_t)(logicalMax - globals.logicalMin);
+
+				if (globals.usagePage == HID_PAGE_BUTTON && globals.reportSize == 1) {
+					if (usage == 0 || usage > 32)
+						continue;
+					// extend the previous run when this is its next bit and its next button
+					if (fieldCount > 0) {
+						ReportField & last = fields[fieldCount - 1];
+						uint32_t lastBit = last.byteOffset * 8 + last.shift;
+						if (last.type == REPORT_FIELD_BUTTONS && last.count < BUTTON_RUN_MAX &&
+							lastBit + last.count == bit && last.target + last.count == usage - 1 &&
+							last.shift + last.count < 32) {
+							last.count++;
+							last.bytes = (last.shift + last.count + 7) >> 3;
+							last.mask = (1UL << last.count) - 1;
+							continue;
+						}
+					}
+					field.type = REPORT_FIELD_BUTTONS;
+					field.target = usage - 1;
+					field.count = 1;
+					field.signBits = 0;
+				} else if (globals.usagePage == HID_PAGE_DESKTOP && usage == HID_USAGE_HAT) {
+					if (field.range != 7 && field.range != 3)
+						continue;
+					field.type = REPORT_FIELD_HAT;
+					field.count = field.range == 7 ? 1 : 2;
+				} else if (globals.usagePage == HID_PAGE_DESKTOP && usage >= HID_USAGE_X && usage <= HID_USAGE_RZ) {
+					field.type = REPORT_FIELD_AXIS;
+					field.target = USAGE_X + (usage - HID_USAGE_X);
+				} else if (globals.usagePage == HID_PAGE_SIMULATION && (usage == HID_USAGE_ACCEL || usage == HID_USAGE_BRAKE)) {
+					field.type = REPORT_FIELD_AXIS;
+					field.target = usage == HID_USAGE_ACCEL ? USAGE_ACCEL : USAGE_BRAKE;
+				} else {
+					continue;
+				}
+				if (field.type != REPORT_FIELD_BUTTONS && (field.range == 0 || field.range > 0xFFFF || logicalMax < globals.logicalMin))
+					continue;
+				if (fieldCount == REPORT_DECODER_MAX_FIELDS)
+					break;
+				fields[fieldCount++] = field;
+				reportId = globals.reportId;
+				planned = true;
+			}
+			idBits[slot] += globals.reportSize * globals.reportCount;
+		}
+
+		// every main item ends the local state
+		usageCount = 0;
+		usageMin = usageMax = 0;
+		usageRange = false;
+	}
+
+	if (!planned)
+		return false;
+
+	for (uint8_t slot = 0; slot < idCount; slot++) {
+		if (idList[slot] == reportId)
+			reportBytes = (idBits[slot] + 7) >> 3;
+	}
+
+	// Sticks: Z/Rz is the right stick when Rz is there (DS4, DInput pads, arcade encoders), leaving Rx/Ry
+	// for the triggers, otherwise Rx/Ry is the right stick and a lone Z has nowhere to go
+	bool hasRz = false;
+	for (uint8_t i = 0; i < fieldCount; i++)
+		hasRz |= fields[i].type == REPORT_FIELD_AXIS && fields[i].target == USAGE_RZ;
+
+	// a repeated axis usage is padding up front and the real axis last (Astro City mini, DragonRise encoders)
+	int8_t axisField[REPORT_AXIS_NONE];
+	for (uint8_t axis = 0; axis < REPORT_AXIS_NONE; axis++)
+		axisField[axis] = -1;
+	uint8_t count = 0;
+	for (uint8_t i = 0; i < fieldCount; i++) {
+		ReportField field = fields[i];
+		uint8_t slot = count;
+		if (field.type == REPORT_FIELD_AXIS) {
+			uint8_t axis;
+			switch (field.target) {
+				case USAGE_X:     axis = REPORT_AXIS_LX; break;
+				case USAGE_Y:     axis = REPORT_AXIS_LY; break;
+				case USAGE_Z:     axis = hasRz ? REPORT_AXIS_RX : REPORT_AXIS_NONE; break;
+				case USAGE_RZ:    axis = REPORT_AXIS_RY; break;
+				case USAGE_RX:    axis = hasRz ? REPORT_AXIS_LT : REPORT_AXIS_RX; break;
+				case USAGE_RY:    axis = hasRz ? REPORT_AXIS_RT : REPORT_AXIS_RY; break;
+				case USAGE_ACCEL: axis = REPORT_AXIS_RT; break;
+				case USAGE_BRAKE: axis = REPORT_AXIS_LT; break;
+				default:          axis = REPORT_AXIS_NONE; break;
+			}
+			if (axis == REPORT_AXIS_NONE)
+				continue;
+			if (axisField[axis] >= 0)
+				slot = axisField[axis];
+			else
+				axisField[axis] = count;
+			field.target = axis;
+			uint32_t output = (axis == REPORT_AXIS_LT || axis == REPORT_AXIS_RT) ? GAMEPAD_TRIGGER_MAX : GAMEPAD_JOYSTICK_MAX;
+			// rounded up so the logical maximum reaches the output maximum, range is at most 16 bits
+			field.scale = ((output << 16) + field.range - 1) / field.range;
+		}
+		fields[slot] = field;
+		if (slot == count)
+			count++;
+	}
+	fieldCount = count;
+	return fieldCount > 0;
+}
+
+/**
+ * @brief Decode one report along the compiled plan.
+ *
+ * Every field is the same fixed extract: up to four bytes from its offset, shifted and masked, so the cost is
+ * linear in the plan (a DS4 is 8 fields) and independent of the descriptor. Axes are scaled with one 32 bit
+ * multiply, the largest product is output maximum << 16.
+ */
+bool ReportDecoder::decode(const uint8_t * report, uint16_t len, GamepadState & state) const {
+	if (fieldCount == 0)
+		return false;
+	if (reportId != 0) {
+		if (len == 0 || report[0] != reportId)
+			return false;
+		report++;
+		len--;
+	}
+	if (len < reportBytes)
+		return false;
+
+	GamepadState decoded;
+	uint16_t * axes[] = { &decoded.lx, &decoded.ly, &decoded.rx, &decoded.ry };
+	for (uint8_t i = 0; i < fieldCount; i++) {
+		const ReportField & field = fields[i];
+		const uint8_t * bytes = &report[field.byteOffset];
+		uint32_t raw = bytes[0];
+		for (uint8_t b = 1; b < field.bytes; b++)
+			raw |= (uint32_t)bytes[b] << (8 * b);
+		raw = (raw >> field.shift) & field.mask;
+
+		if (field.type == REPORT_FIELD_BUTTONS) {
+			const uint16_t * map = &dinputButtons[field.target];
+			for (; raw != 0; raw >>= 1, map++) {
+				if (raw & 1)
+					decoded.buttons |= *map;
+			}
+		} else {
+			int32_t value = field.signBits ? (int32_t)(raw << field.signBits) >> field.signBits : (int32_t)raw;
+			uint32_t offset = (uint32_t)(value - field.min);
+			if (field.type == REPORT_FIELD_HAT) {
+				// anything outside the logical range is the null state
+				decoded.dpad = offset <= field.range ? hatDpad[offset * field.count] : 0;
+			} else {
+				if (value < field.min)
+					offset = 0;
+				else if (offset > field.range)
+					offset = field.range;
+				uint32_t scaled = (offset * field.scale) >> 16;
+				if (field.target == REPORT_AXIS_LT)
+					decoded.lt = scaled;
+				else if (field.target == REPORT_AXIS_RT)
+					decoded.rt = scaled;
+				else
+					*axes[field.target] = scaled;
+			}
+		}
+	}
+	state = decoded;
+	return true;
+}
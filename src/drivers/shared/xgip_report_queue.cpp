@@ -0,0 +1,41 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: Copyright (c) 2024 OpenStickCommunity (gp2040-ce.info)
+ */
+
+#include <string.h>
+
+#include "drivers/shared/xgip_report_queue.h"
+
+bool XGIPReportQueue::push(const void * report, uint16_t len) {
+    if ( full() || len > XBONE_ENDPOINT_SIZE ) {
+        dropped++;
+        return false;
+    }
+
+    xgip_report_t * item = &reports[(head + count) % XGIP_REPORT_QUEUE_SIZE];
+    memcpy(item->report, report, len);
+    item->len = len;
+    count++;
+    return true;
+}
+
+const xgip_report_t * XGIPReportQueue::front() {
+    if ( empty() )
+        return nullptr;
+    return &reports[head];
+}
+
+void XGIPReportQueue::pop() {
+    if ( empty() )
+        return;
+    head = (head + 1) % XGIP_REPORT_QUEUE_SIZE;
+    count--;
+}
+
+// Drop anything pending, the dropped count is kept for diagnostics
+void XGIPReportQueue::clear() {
+    head = 0;
+    count = 0;
+    nextSend = 0;
+}
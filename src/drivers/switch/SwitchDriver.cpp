@@ -1,5 +1,32 @@
 #include "drivers/switch/SwitchDriver.h"
 #include "drivers/shared/driverhelper.h"
+#include "drivers/shared/reportencoder.h"
+
+// buttons (16 bits) followed by the hat byte
+static constexpr ReportBit switchButtonBits[] = {
+	{ GAMEPAD_MASK_B1, SWITCH_MASK_B },
+	{ GAMEPAD_MASK_B2, SWITCH_MASK_A },
+	{ GAMEPAD_MASK_B3, SWITCH_MASK_Y },
+	{ GAMEPAD_MASK_B4, SWITCH_MASK_X },
+	{ GAMEPAD_MASK_L1, SWITCH_MASK_L },
+	{ GAMEPAD_MASK_R1, SWITCH_MASK_R },
+	{ GAMEPAD_MASK_L2, SWITCH_MASK_ZL },
+	{ GAMEPAD_MASK_R2, SWITCH_MASK_ZR },
+	{ GAMEPAD_MASK_S1, SWITCH_MASK_MINUS },
+	{ GAMEPAD_MASK_S2, SWITCH_MASK_PLUS },
+	{ GAMEPAD_MASK_L3, SWITCH_MASK_L3 },
+	{ GAMEPAD_MASK_R3, SWITCH_MASK_R3 },
+	{ GAMEPAD_MASK_A1, SWITCH_MASK_HOME },
+	{ GAMEPAD_MASK_A2, SWITCH_MASK_CAPTURE },
+};
+
+static constexpr ReportHat switchHat = {
+	SWITCH_HAT_UP, SWITCH_HAT_UPRIGHT, SWITCH_HAT_RIGHT, SWITCH_HAT_DOWNRIGHT,
+	SWITCH_HAT_DOWN, SWITCH_HAT_DOWNLEFT, SWITCH_HAT_LEFT, SWITCH_HAT_UPLEFT,
+	SWITCH_HAT_NOTHING, 16
+};
+
+static constexpr ReportEncoder<uint32_t> switchEncoder(switchButtonBits, switchHat);
 
 void SwitchDriver::initialize() {
 	switchReport = {
@@ -11,6 +38,8 @@ void SwitchDriver::initialize() {
 		.ry = SWITCH_JOYSTICK_MID,
 		.vendor = 0,
 	};
+	lastState = unbuiltGamepadState();
+	reportCommitted = false;
 
 	class_driver = {
 	#if CFG_TUSB_DEBUG >= 2
@@ -26,52 +55,26 @@ void SwitchDriver::initialize() {
 }
 
 void SwitchDriver::process(Gamepad * gamepad, uint8_t * outBuffer) {
-	switch (gamepad->state.dpad & GAMEPAD_MASK_DPAD)
-	{
-		case GAMEPAD_MASK_UP:                        switchReport.hat = SWITCH_HAT_UP;        break;
-		case GAMEPAD_MASK_UP | GAMEPAD_MASK_RIGHT:   switchReport.hat = SWITCH_HAT_UPRIGHT;   break;
-		case GAMEPAD_MASK_RIGHT:                     switchReport.hat = SWITCH_HAT_RIGHT;     break;
-		case GAMEPAD_MASK_DOWN | GAMEPAD_MASK_RIGHT: switchReport.hat = SWITCH_HAT_DOWNRIGHT; break;
-		case GAMEPAD_MASK_DOWN:                      switchReport.hat = SWITCH_HAT_DOWN;      break;
-		case GAMEPAD_MASK_DOWN | GAMEPAD_MASK_LEFT:  switchReport.hat = SWITCH_HAT_DOWNLEFT;  break;
-		case GAMEPAD_MASK_LEFT:                      switchReport.hat = SWITCH_HAT_LEFT;      break;
-		case GAMEPAD_MASK_UP | GAMEPAD_MASK_LEFT:    switchReport.hat = SWITCH_HAT_UPLEFT;    break;
-		default:                                     switchReport.hat = SWITCH_HAT_NOTHING;   break;
-	}
+	if (!sameGamepadState(gamepad->state, lastState)) {
+		lastState = gamepad->state;
+
+		storeReportBits(reinterpret_cast<uint8_t *>(&switchReport), switchEncoder.encode(gamepad->state), 24);
+		switchReport.lx = static_cast<uint8_t>(gamepad->state.lx >> 8);
+		switchReport.ly = static_cast<uint8_t>(gamepad->state.ly >> 8);
+		switchReport.rx = static_cast<uint8_t>(gamepad->state.rx >> 8);
+		switchReport.ry = static_cast<uint8_t>(gamepad->state.ry >> 8);
 
-	switchReport.buttons = 0
-		| (gamepad->pressedB1() ? SWITCH_MASK_B       : 0)
-		| (gamepad->pressedB2() ? SWITCH_MASK_A       : 0)
-		| (gamepad->pressedB3() ? SWITCH_MASK_Y       : 0)
-		| (gamepad->pressedB4() ? SWITCH_MASK_X       : 0)
-		| (gamepad->pressedL1() ? SWITCH_MASK_L       : 0)
-		| (gamepad->pressedR1() ? SWITCH_MASK_R       : 0)
-		| (gamepad->pressedL2() ? SWITCH_MASK_ZL      : 0)
-		| (gamepad->pressedR2() ? SWITCH_MASK_ZR      : 0)
-		| (gamepad->pressedS1() ? SWITCH_MASK_MINUS   : 0)
-		| (gamepad->pressedS2() ? SWITCH_MASK_PLUS    : 0)
-		| (gamepad->pressedL3() ? SWITCH_MASK_L3      : 0)
-		| (gamepad->pressedR3() ? SWITCH_MASK_R3      : 0)
-		| (gamepad->pressedA1() ? SWITCH_MASK_HOME    : 0)
-		| (gamepad->pressedA2() ? SWITCH_MASK_CAPTURE : 0)
-	;
-
-	switchReport.lx = static_cast<uint8_t>(gamepad->state.lx >> 8);
-	switchReport.ly = static_cast<uint8_t>(gamepad->state.ly >> 8);
-	switchReport.rx = static_cast<uint8_t>(gamepad->state.rx >> 8);
-	switchReport.ry = static_cast<uint8_t>(gamepad->state.ry >> 8);
+		reportCommitted = memcmp(last_report, &switchReport, sizeof(switchReport)) == 0;
+	}
 
 	// Wake up TinyUSB device
 	if (tud_suspended())
 		tud_remote_wakeup();
 
-	void * report = &switchReport;
-	uint16_t report_size = sizeof(switchReport);
-	if (memcmp(last_report, report, report_size) != 0) {
-		// HID ready + report sent, copy previous report
-		if (tud_hid_ready() && tud_hid_report(0, report, report_size) == true ) {
-			memcpy(last_report, report, report_size);
-		}
+	// HID ready + report sent, copy previous report
+	if (!reportCommitted && tud_hid_ready() && tud_hid_report(0, &switchReport, sizeof(switchReport)) == true ) {
+		memcpy(last_report, &switchReport, sizeof(switchReport));
+		reportCommitted = true;
 	}
 }
 
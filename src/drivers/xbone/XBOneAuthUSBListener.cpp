@@ -8,6 +8,7 @@
 
 #include "drivers/xbone/XBOneDescriptors.h"
 #include "drivers/shared/xgip_protocol.h"
+#include "drivers/shared/xgip_report_queue.h"
 #include "drivers/shared/xinput_host.h"
 
 // power-on states and rumble-on with everything disabled
@@ -17,18 +18,17 @@ static uint8_t xb1_power_on_single[] = {0x00};
 static uint8_t xb1_rumble_on[] = {0x00, 0x0f, 0x00, 0x00, 0x00, 0x00, 0xff, 0x00, 0xeb};
 
 // Report Queue for big report sizes from dongle
-#include <queue>
-typedef struct {
-	uint8_t report[XBONE_ENDPOINT_SIZE];
-	uint16_t len;
-} report_queue_t;
-
-static std::queue<report_queue_t> report_queue;
-static uint32_t lastReportQueue = 0;
 #define REPORT_QUEUE_INTERVAL 15
+static XGIPReportQueue report_queue(REPORT_QUEUE_INTERVAL);
+
+// Time given to a dongle that sent an invalid first packet to finish booting
+#define DONGLE_BOOT_WAIT 50
 
 void XBOneAuthUSBListener::setup() {
     xboxOneAuthData = nullptr;
+    mounted = false;
+    authToDongle = false;
+    dongleToConsoleRetry.pending = false;
 }
 
 void XBOneAuthUSBListener::setAuthData(XboxOneAuthData * authData ) {
@@ -37,27 +37,47 @@ void XBOneAuthUSBListener::setAuthData(XboxOneAuthData * authData ) {
 }
 
 void XBOneAuthUSBListener::process() {
-    // Do nothing if auth data or dongle are not ready 
-    if ( mounted == false || xboxOneAuthData == nullptr) // do nothing if we have not mounted an xbox one dongle
+    if ( xboxOneAuthData == nullptr )
         return;
 
-    // Received a packet from the console (or Windows) to dongle
-    if ( xboxOneAuthData->xboneState == XboxOneState::send_auth_console_to_dongle ) {
-        uint8_t isChunked = ( xboxOneAuthData->consoleBuffer.length > GIP_MAX_CHUNK_SIZE );
-        uint8_t needsAck = ( xboxOneAuthData->consoleBuffer.length > 2 );
+    // The console driver restarted the handshake: drop everything in flight both ways, it waits on this
+    if ( xboxOneAuthData->dongleRestart ) {
+        xboxOneAuthData->consoleToDongle.clear();
+        xboxOneAuthData->dongleToConsole.clear();
+        dongleToConsoleRetry.pending = false;
+        report_queue.clear();
+        incomingXGIP.reset();
         outgoingXGIP.reset();
-        outgoingXGIP.setAttributes(xboxOneAuthData->consoleBuffer.type,
-            xboxOneAuthData->consoleBuffer.sequence, 1, isChunked, needsAck);
-        outgoingXGIP.setData(xboxOneAuthData->consoleBuffer.data, xboxOneAuthData->consoleBuffer.length);
-        xboxOneAuthData->consoleBuffer.reset();
-        xboxOneAuthData->xboneState = XboxOneState::wait_auth_console_to_dongle;
+        authToDongle = false;
+        xboxOneAuthData->dongleRestart = false;
+    }
+
+    // Do nothing if the dongle is not ready
+    if ( mounted == false ) // do nothing if we have not mounted an xbox one dongle
+        return;
+
+    // A dongle message that found the queue full
+    retryAuthPacket(xboxOneAuthData->dongleToConsole, dongleToConsoleRetry);
+
+    // Received a packet from the console (or Windows) to dongle
+    if ( !authToDongle ) {
+        const XBOneAuthPacket * packet = xboxOneAuthData->consoleToDongle.front();
+        if ( packet != nullptr ) {
+            uint8_t isChunked = ( packet->length > GIP_MAX_CHUNK_SIZE );
+            uint8_t needsAck = ( packet->length > 2 );
+            outgoingXGIP.reset();
+            outgoingXGIP.setAttributes(packet->type, packet->sequence, 1, isChunked, needsAck);
+            outgoingXGIP.setData(packet->data, packet->length);
+            xboxOneAuthData->consoleToDongle.pop();
+            authToDongle = true;
+        }
     }
 
-    // Process waiting (always on first frame)
-    if ( xboxOneAuthData->xboneState == XboxOneState::wait_auth_console_to_dongle) {
+    // Process waiting (always on first frame), chunks wait while the queue is full
+    if ( authToDongle && !report_queue.full() ) {
         queue_host_report(outgoingXGIP.generatePacket(), outgoingXGIP.getPacketLength());
         if ( outgoingXGIP.getChunked() == false || outgoingXGIP.endOfChunk() == true) {
-            xboxOneAuthData->xboneState = XboxOneState::auth_idle_state;
+            authToDongle = false;
         }
     }
 
@@ -72,6 +92,7 @@ void XBOneAuthUSBListener::xmount(uint8_t dev_addr, uint8_t instance, uint8_t co
         xbone_instance = instance;
         incomingXGIP.reset();
         outgoingXGIP.reset();
+        authToDongle = false;
         mounted = true;
     }
 }
@@ -80,9 +101,10 @@ void XBOneAuthUSBListener::unmount(uint8_t dev_addr) {
     if ( dev_addr == xbone_dev_addr ) {
         // Do not reset dongle_ready on unmount (Magic-X will remount but still be ready)
         mounted = false;
-        while (!report_queue.empty()) report_queue.pop();
+        report_queue.clear();
         incomingXGIP.reset();
         outgoingXGIP.reset();
+        authToDongle = false;
         xboxOneAuthData->dongle_ready = false; // not ready for auth if we unmounted
     }
 }
@@ -94,7 +116,8 @@ void XBOneAuthUSBListener::report_received(uint8_t dev_addr, uint8_t instance, u
 
     incomingXGIP.parse(report, len);
     if ( incomingXGIP.validate() == false ) {
-        sleep_ms(50); // First packet is invalid, drop and wait for dongle to boot
+        // First packet is invalid, drop and hold the queue while the dongle boots
+        report_queue.defer(to_ms_since_boot(get_absolute_time()), DONGLE_BOOT_WAIT);
         incomingXGIP.reset();
         return;
     }
@@ -135,9 +158,11 @@ void XBOneAuthUSBListener::report_received(uint8_t dev_addr, uint8_t instance, u
         case GIP_FINAL_AUTH:
             if ( incomingXGIP.getChunked() == false || 
                 (incomingXGIP.getChunked() == true && incomingXGIP.endOfChunk() == true )) {
-                xboxOneAuthData->dongleBuffer.setBuffer(incomingXGIP.getData(), incomingXGIP.getDataLength(),
-                    incomingXGIP.getSequence(), incomingXGIP.getCommand());
-                xboxOneAuthData->xboneState = XboxOneState::send_auth_dongle_to_console;
+                if ( !queueAuthPacket(xboxOneAuthData->dongleToConsole, dongleToConsoleRetry, incomingXGIP.getData(),
+                        incomingXGIP.getDataLength(), incomingXGIP.getSequence(), incomingXGIP.getCommand()) ) {
+                    dongleToConsoleRetry.pending = false;
+                    xboxOneAuthData->authRestart = true;
+                }
                 incomingXGIP.reset();
             }
             break;
@@ -148,20 +173,18 @@ void XBOneAuthUSBListener::report_received(uint8_t dev_addr, uint8_t instance, u
 }
 
 void XBOneAuthUSBListener::queue_host_report(void* report, uint16_t len) {
-    report_queue_t new_queue;
-    memcpy(new_queue.report, report, len);
-    new_queue.len = len;
-    report_queue.push(new_queue);
+    report_queue.push(report, len); // counted as dropped if the queue is full
 }
 
 void XBOneAuthUSBListener::process_report_queue() {
     uint32_t now = to_ms_since_boot(get_absolute_time());
-    if ( mounted == true && !report_queue.empty() && (now - lastReportQueue) > REPORT_QUEUE_INTERVAL  ) {
-        if ( tuh_xinput_send_report(xbone_dev_addr, xbone_instance, report_queue.front().report, report_queue.front().len) ) {
-			report_queue.pop();
-            lastReportQueue = now; // last time we checked report queue
+    if ( mounted == true && report_queue.ready(now) ) {
+        const xgip_report_t * item = report_queue.front();
+        if ( tuh_xinput_send_report(xbone_dev_addr, xbone_instance, item->report, item->len) ) {
+            report_queue.pop();
+            report_queue.sent(now); // last time we sent from the report queue
         } else {
-            sleep_ms(REPORT_QUEUE_INTERVAL);
+            report_queue.defer(now, REPORT_QUEUE_INTERVAL);
         }
-	}
+    }
 }
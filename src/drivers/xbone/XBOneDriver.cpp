@@ -1,5 +1,6 @@
 #include "drivers/xbone/XBOneDriver.h"
 #include "drivers/shared/driverhelper.h"
+#include "drivers/shared/xgip_report_queue.h"
 
 #include "drivers/xbone/XBOneAuth.h"
 #include "peripheralmanager.h"
@@ -21,8 +22,7 @@
 #define DESC_EXTENDED_PROPERTIES_DESCRIPTOR 0x0005
 #define REQ_GET_XGIP_HEADER 0x90
 
-// Check report queue every 35 milliseconds
-static uint32_t lastReportQueue = 0;
+// Send a queued report at most every 35 milliseconds
 #define REPORT_QUEUE_INTERVAL 35
 
 typedef enum {
@@ -89,13 +89,7 @@ static uint32_t timer_wait_for_announce;
 static bool xbox_one_powered_on;
 
 // Report Queue for big report sizes from dongle
-#include <queue>
-typedef struct {
-    uint8_t report[XBONE_ENDPOINT_SIZE];
-    uint16_t len;
-} report_queue_t;
-
-static std::queue<report_queue_t> report_queue;
+static XGIPReportQueue report_queue(REPORT_QUEUE_INTERVAL);
 
 #define XGIP_ACK_WAIT_TIMEOUT 2000
 
@@ -116,6 +110,8 @@ CFG_TUSB_MEM_SECTION static xboned_interface_t _xboned_itf[CFG_TUD_XBONE];
 static XGIPProtocol * outgoingXGIP = nullptr;
 static XGIPProtocol * incomingXGIP = nullptr;
 static XboxOneAuthData * xboxOneAuthData = nullptr;
+static bool authToConsole = false; // a dongle message is being sent to the console in outgoingXGIP
+static XBOneAuthRetry consoleToDongleRetry = {};
 
 // Windows requires a Descriptor Single for Xbox One
 typedef struct {
@@ -147,8 +143,7 @@ static void xbone_reset(uint8_t rhport) {
     (void)rhport;
     timer_wait_for_announce = to_ms_since_boot(get_absolute_time());
     xbox_one_powered_on = false;
-    while(!report_queue.empty())
-        report_queue.pop();
+    report_queue.clear();
 
     // close any endpoints that are open
     tu_memclr(&_xboned_itf, sizeof(_xboned_itf));
@@ -208,10 +203,7 @@ static uint16_t xbone_open(uint8_t rhport, tusb_desc_interface_t const *itf_desc
 }
 
 static void queue_xbone_report(void *report, uint16_t report_size) {
-    report_queue_t item;
-    memcpy(item.report, report, report_size);
-    item.len = report_size;
-    report_queue.push(item);
+    report_queue.push(report, report_size); // counted as dropped if the queue is full
 }
 
 // DevCompatIDsOne sends back XGIP10 data when requested by Windows
@@ -280,9 +272,11 @@ bool xbone_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result,
             }
             if ( (incomingXGIP->getChunked() == true && incomingXGIP->endOfChunk() == true) ||
                     (incomingXGIP->getChunked() == false )) {
-                xboxOneAuthData->consoleBuffer.setBuffer(incomingXGIP->getData(), incomingXGIP->getDataLength(),
-                    incomingXGIP->getSequence(), incomingXGIP->getCommand());
-                xboxOneAuthData->xboneState = XboxOneState::send_auth_console_to_dongle;
+                if ( !queueAuthPacket(xboxOneAuthData->consoleToDongle, consoleToDongleRetry, incomingXGIP->getData(),
+                        incomingXGIP->getDataLength(), incomingXGIP->getSequence(), incomingXGIP->getCommand()) ) {
+                    consoleToDongleRetry.pending = false;
+                    xboxOneAuthData->authRestart = true;
+                }
                 incomingXGIP->reset();
             }
         }
@@ -295,6 +289,20 @@ bool xbone_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result,
     return true;
 }
 
+// The file statics outlive the driver, leave them as a fresh boot would for the next XBOneDriver
+XBOneDriver::~XBOneDriver() {
+    delete authDriver;
+    delete incomingXGIP;
+    delete outgoingXGIP;
+    incomingXGIP = nullptr;
+    outgoingXGIP = nullptr;
+    xboxOneAuthData = nullptr;
+    xboneDriverState = READY_ANNOUNCE;
+    waiting_ack = false;
+    authToConsole = false;
+    consoleToDongleRetry.pending = false;
+}
+
 void XBOneDriver::initialize() {
     xboneReport = {
         .sync = 0,
@@ -358,7 +366,7 @@ void XBOneDriver::initializeAux() {
 }
 
 USBListener * XBOneDriver::get_usb_auth_listener() {
-    if ( authDriver->available() ) {
+    if ( authDriver != nullptr && authDriver->available() ) {
         return authDriver->getListener();
     }
     return nullptr;
@@ -370,21 +378,31 @@ void XBOneDriver::process(Gamepad * gamepad, uint8_t * outBuffer) {
         return;
     }
 
-    uint16_t xboneReportSize = 0;
+    uint32_t now = to_ms_since_boot(get_absolute_time());
 
     // Perform update
     this->update();
 
-    // No input until auth is ready
+    // No input until auth is ready, GIP traffic goes first so the handshake can progress
     if ( xboxOneAuthData->authCompleted == false ) {
+        process_report_queue(now);
         GIP_HEADER((&xboneReport), GIP_INPUT_REPORT, false, last_report_counter);
         memcpy((void*)&((uint8_t*)&xboneReport)[4], xboneIdle, sizeof(xboneIdle));
-        xboneReportSize = sizeof(XboxOneGamepad_Data_t);
-        send_xbone_usb((uint8_t*)&xboneReport, xboneReportSize);
+        send_xbone_usb((uint8_t*)&xboneReport, sizeof(XboxOneGamepad_Data_t));
         return;
     }
 
-    uint32_t now = to_ms_since_boot(get_absolute_time());
+    // Input reports have priority, queued GIP traffic only gets the endpoint
+    // on frames where there is no new input to send
+    if ( send_input_report(gamepad, now) == false ) {
+        process_report_queue(now);
+    }
+}
+
+// Returns true if a report was handed to the IN endpoint
+bool XBOneDriver::send_input_report(Gamepad * gamepad, uint32_t now) {
+    uint16_t xboneReportSize = 0;
+
     // Send Keep-Alive every 15 seconds (keep_alive_timer updates if send is successful)
     if ( (now - keep_alive_timer) > XBONE_KEEPALIVE_TIMER) {
         memset(&xboneReport.Header, 0, sizeof(GipHeader_t));
@@ -399,8 +417,9 @@ void XBOneDriver::process(Gamepad * gamepad, uint8_t * outBuffer) {
             keep_alive_sequence++; // will rollover
             if ( keep_alive_sequence == 0 )
                 keep_alive_sequence = 1;
+            return true;
         }
-        return;
+        return false;
     }
     
     // Virtual Keycode for Guide Button
@@ -430,8 +449,9 @@ void XBOneDriver::process(Gamepad * gamepad, uint8_t * outBuffer) {
             // On success, update our guide pressed state and virtual key code state
             virtual_keycode_sequence = new_sequence;
             xb1_guide_pressed = !xb1_guide_pressed;
+            return true;
         }
-        return;
+        return false;
     }
 
     // Only change xbox one input report if we have different inputs!
@@ -490,8 +510,10 @@ void XBOneDriver::process(Gamepad * gamepad, uint8_t * outBuffer) {
                     last_report_counter = 1;
                 memcpy(last_report, &xboneReport, xboneReportSize);
             }
+            return true;
         }
     }
+    return false;
 }
 
 void XBOneDriver::processAux() {
@@ -589,8 +611,27 @@ void XBOneDriver::set_ack_wait() {
 void XBOneDriver::update() {
     uint32_t now = to_ms_since_boot(get_absolute_time());
 
-    // Process our report queue
-    process_report_queue(now);
+    // An auth message was dropped on either side, start over from the announce
+    if ( xboxOneAuthData->authRestart.exchange(false) ) {
+        xboxOneAuthData->authCompleted = false;
+        xboxOneAuthData->dongleRestart = true;
+        consoleToDongleRetry.pending = false;
+        authToConsole = false;
+        waiting_ack = false;
+        incomingXGIP->reset();
+        outgoingXGIP->reset();
+        timer_wait_for_announce = now;
+        xboneDriverState = READY_ANNOUNCE;
+        return;
+    }
+
+    // The dongle side is still dropping the old handshake, both queues are its to clear
+    if ( xboxOneAuthData->dongleRestart ) {
+        return;
+    }
+
+    // A console message that found the queue full
+    retryAuthPacket(xboxOneAuthData->consoleToDongle, consoleToDongleRetry);
 
     // Do not add logic until our ACK returns
     if ( waiting_ack == true ) {
@@ -613,6 +654,8 @@ void XBOneDriver::update() {
             }
             break;
         case SEND_DESCRIPTOR:
+            if ( report_queue.full() ) // wait for room, the descriptor is sent in order
+                break;
             queue_xbone_report(outgoingXGIP->generatePacket(), outgoingXGIP->getPacketLength());
             if ( outgoingXGIP->endOfChunk() == true ) {
                 xboneDriverState = SETUP_AUTH;
@@ -623,24 +666,23 @@ void XBOneDriver::update() {
             break;
         case SETUP_AUTH:
             // Received packet from dongle to console / PC
-            if ( xboxOneAuthData->xboneState == XboxOneState::send_auth_dongle_to_console ) {
-                uint16_t len = xboxOneAuthData->dongleBuffer.length;
-                uint8_t type = xboxOneAuthData->dongleBuffer.type;
-                uint8_t sequence = xboxOneAuthData->dongleBuffer.sequence;
-                uint8_t * buffer = xboxOneAuthData->dongleBuffer.data;
-                bool isChunked = (len > GIP_MAX_CHUNK_SIZE);
-                outgoingXGIP->reset();
-                outgoingXGIP->setAttributes(type, sequence, 1, isChunked, 1);
-                outgoingXGIP->setData(buffer, len);
-                xboxOneAuthData->xboneState = wait_auth_dongle_to_console;
-                xboxOneAuthData->dongleBuffer.reset();
+            if ( !authToConsole ) {
+                const XBOneAuthPacket * packet = xboxOneAuthData->dongleToConsole.front();
+                if ( packet != nullptr ) {
+                    bool isChunked = (packet->length > GIP_MAX_CHUNK_SIZE);
+                    outgoingXGIP->reset();
+                    outgoingXGIP->setAttributes(packet->type, packet->sequence, 1, isChunked, 1);
+                    outgoingXGIP->setData(packet->data, packet->length);
+                    xboxOneAuthData->dongleToConsole.pop();
+                    authToConsole = true;
+                }
             }
             
             // Process auth dongle to console
-            if ( xboxOneAuthData->xboneState == XboxOneState::wait_auth_dongle_to_console ) {
+            if ( authToConsole && !report_queue.full() ) {
                 queue_xbone_report(outgoingXGIP->generatePacket(), outgoingXGIP->getPacketLength());
                 if ( outgoingXGIP->getChunked() == false || outgoingXGIP->endOfChunk() == true ) {
-                    xboxOneAuthData->xboneState = XboxOneState::auth_idle_state;
+                    authToConsole = false;
                 }
                 if ( outgoingXGIP->getPacketAck() == 1 ) { // ACK can happen at different chunks
                     set_ack_wait();
@@ -654,18 +696,28 @@ void XBOneDriver::update() {
 }
 
 void XBOneDriver::process_report_queue(uint32_t now) {
-    if ( !report_queue.empty() && (now - lastReportQueue) > REPORT_QUEUE_INTERVAL ) {
-        if ( send_xbone_usb(report_queue.front().report, report_queue.front().len) ) {
-            memcpy(last_report, &report_queue.front().report, report_queue.front().len);
+    if ( report_queue.ready(now) ) {
+        const xgip_report_t * item = report_queue.front();
+        if ( send_xbone_usb(item->report, item->len) ) {
+            memcpy(last_report, item->report, item->len);
             report_queue.pop();
-            lastReportQueue = now;
+            report_queue.sent(now);
         } else {
             // THIS IS REQUIRED FOR TIMING ON PC / CONSOLE
-            sleep_ms(REPORT_QUEUE_INTERVAL); // sleep while we wait, never happens during input only auth
+            // back off for an interval instead of sleeping in the input path
+            report_queue.defer(now, REPORT_QUEUE_INTERVAL);
         }
     }
 }
 
+uint8_t XBOneDriver::getReportQueueDepth() {
+    return report_queue.depth();
+}
+
+uint32_t XBOneDriver::getReportQueueDropped() {
+    return report_queue.getDropped();
+}
+
 uint16_t XBOneDriver::GetJoystickMidValue() {
     return GAMEPAD_JOYSTICK_MID;
 }
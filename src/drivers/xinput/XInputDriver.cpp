@@ -6,6 +6,7 @@
 #include "drivers/xinput/XInputDriver.h"
 #include "drivers/xinput/XInputAuth.h"
 #include "drivers/shared/driverhelper.h"
+#include "drivers/shared/reportencoder.h"
 #include "storagemanager.h"
 
 #define USB_SETUP_DEVICE_TO_HOST 0x80
@@ -18,6 +19,27 @@
 #define USB_SETUP_RECIPIENT_ENDPOINT    0x02
 #define USB_SETUP_RECIPIENT_OTHER       0x03
 
+// buttons1 in the low byte, buttons2 in the high byte
+static constexpr ReportBit xinputButtonBits[] = {
+	{ GAMEPAD_MASK_DU, XBOX_MASK_UP },
+	{ GAMEPAD_MASK_DD, XBOX_MASK_DOWN },
+	{ GAMEPAD_MASK_DL, XBOX_MASK_LEFT },
+	{ GAMEPAD_MASK_DR, XBOX_MASK_RIGHT },
+	{ GAMEPAD_MASK_S2, XBOX_MASK_START },
+	{ GAMEPAD_MASK_S1, XBOX_MASK_BACK },
+	{ GAMEPAD_MASK_L3, XBOX_MASK_LS },
+	{ GAMEPAD_MASK_R3, XBOX_MASK_RS },
+	{ GAMEPAD_MASK_L1, XBOX_MASK_LB << 8 },
+	{ GAMEPAD_MASK_R1, XBOX_MASK_RB << 8 },
+	{ GAMEPAD_MASK_A1, XBOX_MASK_HOME << 8 },
+	{ GAMEPAD_MASK_B1, XBOX_MASK_A << 8 },
+	{ GAMEPAD_MASK_B2, XBOX_MASK_B << 8 },
+	{ GAMEPAD_MASK_B3, XBOX_MASK_X << 8 },
+	{ GAMEPAD_MASK_B4, XBOX_MASK_Y << 8 },
+};
+
+static constexpr ReportEncoder<uint16_t> xinputEncoder(xinputButtonBits);
+
 #define REQ_GET_OS_FEATURE_DESCRIPTOR 0x20
 #define DESC_EXTENDED_COMPATIBLE_ID_DESCRIPTOR 0x0004
 #define DESC_EXTENDED_PROPERTIES_DESCRIPTOR 0x0005
@@ -119,6 +141,11 @@ static bool xinput_xfer_callback(uint8_t rhport, uint8_t ep_addr, xfer_result_t
 	return true;
 }
 
+XInputDriver::~XInputDriver() {
+	delete authDriver;
+	authDriverPresent = false;
+}
+
 void XInputDriver::initialize() {
 	xinputReport = {
 		.report_id = 0,
@@ -127,12 +154,14 @@ void XInputDriver::initialize() {
 		.buttons2 = 0,
 		.lt = 0,
 		.rt = 0,
-		.lx = GAMEPAD_JOYSTICK_MID,
-		.ly = GAMEPAD_JOYSTICK_MID,
-		.rx = GAMEPAD_JOYSTICK_MID,
-		.ry = GAMEPAD_JOYSTICK_MID,
+		.lx = static_cast<int16_t>(static_cast<int16_t>(GAMEPAD_JOYSTICK_MID) + INT16_MIN), // centred, encoded like process() does
+		.ly = static_cast<int16_t>(static_cast<int16_t>(~GAMEPAD_JOYSTICK_MID) + INT16_MIN),
+		.rx = static_cast<int16_t>(static_cast<int16_t>(GAMEPAD_JOYSTICK_MID) + INT16_MIN),
+		.ry = static_cast<int16_t>(static_cast<int16_t>(~GAMEPAD_JOYSTICK_MID) + INT16_MIN),
 		._reserved = { },
 	};
+	lastState = unbuiltGamepadState();
+	reportCommitted = false;
 
 	class_driver = {
 	#if CFG_TUSB_DEBUG >= 2
@@ -172,53 +201,40 @@ USBListener * XInputDriver::get_usb_auth_listener() {
 }
 
 void XInputDriver::process(Gamepad * gamepad, uint8_t * outBuffer) {
-	xinputReport.buttons1 = 0
-		| (gamepad->pressedUp()    ? XBOX_MASK_UP    : 0)
-		| (gamepad->pressedDown()  ? XBOX_MASK_DOWN  : 0)
-		| (gamepad->pressedLeft()  ? XBOX_MASK_LEFT  : 0)
-		| (gamepad->pressedRight() ? XBOX_MASK_RIGHT : 0)
-		| (gamepad->pressedS2()    ? XBOX_MASK_START : 0)
-		| (gamepad->pressedS1()    ? XBOX_MASK_BACK  : 0)
-		| (gamepad->pressedL3()    ? XBOX_MASK_LS    : 0)
-		| (gamepad->pressedR3()    ? XBOX_MASK_RS    : 0)
-	;
-
-	xinputReport.buttons2 = 0
-		| (gamepad->pressedL1() ? XBOX_MASK_LB   : 0)
-		| (gamepad->pressedR1() ? XBOX_MASK_RB   : 0)
-		| (gamepad->pressedA1() ? XBOX_MASK_HOME : 0)
-		| (gamepad->pressedB1() ? XBOX_MASK_A    : 0)
-		| (gamepad->pressedB2() ? XBOX_MASK_B    : 0)
-		| (gamepad->pressedB3() ? XBOX_MASK_X    : 0)
-		| (gamepad->pressedB4() ? XBOX_MASK_Y    : 0)
-	;
-
-	xinputReport.lx = static_cast<int16_t>(gamepad->state.lx) + INT16_MIN;
-	xinputReport.ly = static_cast<int16_t>(~gamepad->state.ly) + INT16_MIN;
-	xinputReport.rx = static_cast<int16_t>(gamepad->state.rx) + INT16_MIN;
-	xinputReport.ry = static_cast<int16_t>(~gamepad->state.ry) + INT16_MIN;
-
-	if (gamepad->hasAnalogTriggers)
-	{
-		xinputReport.lt = gamepad->pressedL2() ? 0xFF : gamepad->state.lt;
-		xinputReport.rt = gamepad->pressedR2() ? 0xFF : gamepad->state.rt;
-	}
-	else
-	{
-		xinputReport.lt = gamepad->pressedL2() ? 0xFF : 0;
-		xinputReport.rt = gamepad->pressedR2() ? 0xFF : 0;
-	}
+	if (!sameGamepadState(gamepad->state, lastState)) {
+		lastState = gamepad->state;
+
+		storeReportBits(&xinputReport.buttons1, xinputEncoder.encode(gamepad->state), 16);
 
-	// compare against previous report and send new
-	if ( memcmp(last_report, &xinputReport, sizeof(XInputReport)) != 0) {
-		if ( tud_ready() &&											// Is the device ready?
-			(endpoint_in != 0) && (!usbd_edpt_busy(0, endpoint_in)) ) // Is the IN endpoint available?
+		xinputReport.lx = static_cast<int16_t>(gamepad->state.lx) + INT16_MIN;
+		xinputReport.ly = static_cast<int16_t>(~gamepad->state.ly) + INT16_MIN;
+		xinputReport.rx = static_cast<int16_t>(gamepad->state.rx) + INT16_MIN;
+		xinputReport.ry = static_cast<int16_t>(~gamepad->state.ry) + INT16_MIN;
+
+		if (gamepad->hasAnalogTriggers)
+		{
+			xinputReport.lt = gamepad->pressedL2() ? 0xFF : gamepad->state.lt;
+			xinputReport.rt = gamepad->pressedR2() ? 0xFF : gamepad->state.rt;
+		}
+		else
 		{
-			usbd_edpt_claim(0, endpoint_in);								// Take control of IN endpoint
-			usbd_edpt_xfer(0, endpoint_in, (uint8_t *)&xinputReport, sizeof(XInputReport)); // Send report buffer
-			usbd_edpt_release(0, endpoint_in);								// Release control of IN endpoint
-			memcpy(last_report, &xinputReport, sizeof(XInputReport)); // save if we sent it
+			xinputReport.lt = gamepad->pressedL2() ? 0xFF : 0;
+			xinputReport.rt = gamepad->pressedR2() ? 0xFF : 0;
 		}
+
+		// compare against previous report
+		reportCommitted = memcmp(last_report, &xinputReport, sizeof(XInputReport)) == 0;
+	}
+
+	// send new report
+	if ( !reportCommitted && tud_ready() &&						// Is the device ready?
+		(endpoint_in != 0) && (!usbd_edpt_busy(0, endpoint_in)) ) // Is the IN endpoint available?
+	{
+		usbd_edpt_claim(0, endpoint_in);								// Take control of IN endpoint
+		usbd_edpt_xfer(0, endpoint_in, (uint8_t *)&xinputReport, sizeof(XInputReport)); // Send report buffer
+		usbd_edpt_release(0, endpoint_in);								// Release control of IN endpoint
+		memcpy(last_report, &xinputReport, sizeof(XInputReport)); // save if we sent it
+		reportCommitted = true;
 	}
 
 	// check for player LEDs
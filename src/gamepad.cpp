@@ -81,6 +81,7 @@ void Gamepad::setup()
 		}
 	}
 
+	compileHotkeys();
 }
 
 /**
@@ -144,11 +145,12 @@ void Gamepad::process()
 	}
 
 	// 4-way before SOCD, might have better history without losing any coherent functionality
+	dpadPressOrder.update(state.dpad);
 	if (options.fourWayMode) {
-		state.dpad = filterToFourWayMode(state.dpad);
+		state.dpad = filterToFourWayMode(dpadPressOrder, state.dpad);
 	}
 
-	state.dpad = runSOCDCleaner(resolveSOCDMode(options), state.dpad);
+	state.dpad = runSOCDCleaner(dpadPressOrder, resolveSOCDMode(options), state.dpad);
 
 	switch (options.dpadMode)
 	{
@@ -235,31 +237,88 @@ void Gamepad::save()
 	Storage::getInstance().save();
 }
 
+static inline uint64_t hotkeyMask(uint8_t dpad, uint16_t buttons, uint16_t aux)
+{
+	return dpad | ((uint64_t)buttons << 8) | ((uint64_t)aux << 24);
+}
+
+// Button hotkeys press their button for as long as they are held, everything else fires once per press
+static bool isRepeatingHotkey(GamepadHotkey action)
+{
+	switch (action) {
+		case HOTKEY_HOME_BUTTON:
+		case HOTKEY_CAPTURE_BUTTON:
+		case HOTKEY_TOUCHPAD_BUTTON:
+		case HOTKEY_L3_BUTTON:
+		case HOTKEY_R3_BUTTON:
+		case HOTKEY_B1_BUTTON:
+		case HOTKEY_B2_BUTTON:
+		case HOTKEY_B3_BUTTON:
+		case HOTKEY_B4_BUTTON:
+		case HOTKEY_L1_BUTTON:
+		case HOTKEY_R1_BUTTON:
+		case HOTKEY_L2_BUTTON:
+		case HOTKEY_R2_BUTTON:
+		case HOTKEY_S1_BUTTON:
+		case HOTKEY_S2_BUTTON:
+		case HOTKEY_A1_BUTTON:
+		case HOTKEY_A2_BUTTON:
+		case HOTKEY_REBOOT_DEFAULT:
+			return true;
+		default:
+			return false;
+	}
+}
+
+/**
+ * @brief Build the hotkey match table from the configured hotkeys, keeping their slot order as priority.
+ */
+void Gamepad::compileHotkeys()
+{
+	const HotkeyEntry * entries[GAMEPAD_HOTKEY_COUNT] = {
+		&hotkeyOptions.hotkey01, &hotkeyOptions.hotkey02, &hotkeyOptions.hotkey03, &hotkeyOptions.hotkey04,
+		&hotkeyOptions.hotkey05, &hotkeyOptions.hotkey06, &hotkeyOptions.hotkey07, &hotkeyOptions.hotkey08,
+		&hotkeyOptions.hotkey09, &hotkeyOptions.hotkey10, &hotkeyOptions.hotkey11, &hotkeyOptions.hotkey12,
+		&hotkeyOptions.hotkey13, &hotkeyOptions.hotkey14, &hotkeyOptions.hotkey15, &hotkeyOptions.hotkey16,
+	};
+
+	hotkeyMatchCount = 0;
+	hotkeyCommonMask = UINT64_MAX; // nothing can match an empty table
+	for (const HotkeyEntry * entry : entries) {
+		if (entry->action == HOTKEY_NONE)
+			continue;
+
+		GamepadHotkeyMatch & match = hotkeyMatches[hotkeyMatchCount++];
+		match.mask = hotkeyMask(entry->dpadMask, entry->buttonsMask, entry->auxMask);
+		match.action = entry->action;
+		match.repeat = isRepeatingHotkey(entry->action);
+		hotkeyCommonMask &= match.mask;
+	}
+}
+
 void Gamepad::hotkey()
 {
 	if (options.lockHotkeys)
 		return;
-	
+
 	GamepadHotkey action = HOTKEY_NONE;
-	if (pressedHotkey(hotkeyOptions.hotkey01))	    action = selectHotkey(hotkeyOptions.hotkey01);
-	else if (pressedHotkey(hotkeyOptions.hotkey02))	action = selectHotkey(hotkeyOptions.hotkey02);
-	else if (pressedHotkey(hotkeyOptions.hotkey03))	action = selectHotkey(hotkeyOptions.hotkey03);
-	else if (pressedHotkey(hotkeyOptions.hotkey04))	action = selectHotkey(hotkeyOptions.hotkey04);
-	else if (pressedHotkey(hotkeyOptions.hotkey05))	action = selectHotkey(hotkeyOptions.hotkey05);
-	else if (pressedHotkey(hotkeyOptions.hotkey06))	action = selectHotkey(hotkeyOptions.hotkey06);
-	else if (pressedHotkey(hotkeyOptions.hotkey07))	action = selectHotkey(hotkeyOptions.hotkey07);
-	else if (pressedHotkey(hotkeyOptions.hotkey08))	action = selectHotkey(hotkeyOptions.hotkey08);
-	else if (pressedHotkey(hotkeyOptions.hotkey09))	action = selectHotkey(hotkeyOptions.hotkey09);
-	else if (pressedHotkey(hotkeyOptions.hotkey10))	action = selectHotkey(hotkeyOptions.hotkey10);
-	else if (pressedHotkey(hotkeyOptions.hotkey11))	action = selectHotkey(hotkeyOptions.hotkey11);
-	else if (pressedHotkey(hotkeyOptions.hotkey12))	action = selectHotkey(hotkeyOptions.hotkey12);
-	else if (pressedHotkey(hotkeyOptions.hotkey13))	action = selectHotkey(hotkeyOptions.hotkey13);
-	else if (pressedHotkey(hotkeyOptions.hotkey14))	action = selectHotkey(hotkeyOptions.hotkey14);
-	else if (pressedHotkey(hotkeyOptions.hotkey15))	action = selectHotkey(hotkeyOptions.hotkey15);
-	else if (pressedHotkey(hotkeyOptions.hotkey16))	action = selectHotkey(hotkeyOptions.hotkey16);
-	if ( action != HOTKEY_NONE ) {
-		// processHotkeyAction checks lastAction to determine if the action is repeatable or not
-		processHotkeyAction(action);
+	const uint64_t held = hotkeyMask(state.dpad, state.buttons, state.aux);
+
+	// Every hotkey shares its modifiers (Fn, S1 + S2...), without them none can match
+	if ((held & hotkeyCommonMask) == hotkeyCommonMask) {
+		for (uint8_t i = 0; i < hotkeyMatchCount; i++) {
+			const GamepadHotkeyMatch & match = hotkeyMatches[i];
+			if ((held & match.mask) != match.mask)
+				continue;
+
+			// Remove the hotkey bits from the state
+			state.dpad &= ~(uint8_t)match.mask;
+			state.buttons &= ~(uint16_t)(match.mask >> 8);
+			action = match.action;
+			if (match.repeat || action != lastAction)
+				processHotkeyAction(action);
+			break;
+		}
 	}
 	lastAction = action;
 }
@@ -277,28 +336,24 @@ void Gamepad::clearState() {
 }
 
 /**
- * @brief Take a hotkey action if it hasn't already been taken, modifying state/options appropriately.
+ * @brief Take a hotkey action, modifying state/options appropriately.
+ *
+ * Only called on the press of a hotkey, or on every frame for repeating (button) hotkeys.
  */
 void Gamepad::processHotkeyAction(GamepadHotkey action) {
 	bool reqSave = false;
 	switch (action) {
 		case HOTKEY_DPAD_DIGITAL:
-			if (action != lastAction) {
-				options.dpadMode = DPAD_MODE_DIGITAL;
-				reqSave = true;
-			}
+			options.dpadMode = DPAD_MODE_DIGITAL;
+			reqSave = true;
 			break;
 		case HOTKEY_DPAD_LEFT_ANALOG:
-			if (action != lastAction) {
-				options.dpadMode = DPAD_MODE_LEFT_ANALOG;
-				reqSave = true;
-			}
+			options.dpadMode = DPAD_MODE_LEFT_ANALOG;
+			reqSave = true;
 			break;
 		case HOTKEY_DPAD_RIGHT_ANALOG:
-			if (action != lastAction) {
-				options.dpadMode = DPAD_MODE_RIGHT_ANALOG;
-				reqSave = true;
-			}
+			options.dpadMode = DPAD_MODE_RIGHT_ANALOG;
+			reqSave = true;
 			break;
 		case HOTKEY_HOME_BUTTON:
 			state.buttons |= GAMEPAD_MASK_A1;
@@ -346,34 +401,24 @@ void Gamepad::processHotkeyAction(GamepadHotkey action) {
 			state.buttons |= GAMEPAD_MASK_A2;
 			break;
 		case HOTKEY_SOCD_UP_PRIORITY:
-			if (action != lastAction) {
-				options.socdMode = SOCD_MODE_UP_PRIORITY;
-				reqSave = true;
-			}
+			options.socdMode = SOCD_MODE_UP_PRIORITY;
+			reqSave = true;
 			break;
 		case HOTKEY_SOCD_NEUTRAL:
-			if (action != lastAction) {
-				options.socdMode = SOCD_MODE_NEUTRAL;
-				reqSave = true;
-			}
+			options.socdMode = SOCD_MODE_NEUTRAL;
+			reqSave = true;
 			break;
 		case HOTKEY_SOCD_LAST_INPUT:
-			if (action != lastAction) {
-				options.socdMode = SOCD_MODE_SECOND_INPUT_PRIORITY;
-				reqSave = true;
-			}
+			options.socdMode = SOCD_MODE_SECOND_INPUT_PRIORITY;
+			reqSave = true;
 			break;
 		case HOTKEY_SOCD_FIRST_INPUT:
-			if (action != lastAction) {
-				options.socdMode = SOCD_MODE_FIRST_INPUT_PRIORITY;
-				reqSave = true;
-			}
+			options.socdMode = SOCD_MODE_FIRST_INPUT_PRIORITY;
+			reqSave = true;
 			break;
 		case HOTKEY_SOCD_BYPASS:
-			if (action != lastAction) {
-				options.socdMode = SOCD_MODE_BYPASS;
-				reqSave = true;
-			}
+			options.socdMode = SOCD_MODE_BYPASS;
+			reqSave = true;
 			break;
 		case HOTKEY_REBOOT_DEFAULT:
 			System::reboot(System::BootMode::DEFAULT);
@@ -385,71 +430,54 @@ void Gamepad::processHotkeyAction(GamepadHotkey action) {
 			state.buttons |= GAMEPAD_MASK_A2;
 			break;				
 		case HOTKEY_INVERT_X_AXIS:
-			if (action != lastAction) {
-				options.invertXAxis = !options.invertXAxis;
-				reqSave = true;
-			}
+			options.invertXAxis = !options.invertXAxis;
+			reqSave = true;
 			break;
 		case HOTKEY_INVERT_Y_AXIS:
-			if (action != lastAction) {
-				options.invertYAxis = !options.invertYAxis;
-				reqSave = true;
-			}
+			options.invertYAxis = !options.invertYAxis;
+			reqSave = true;
 			break;
 		case HOTKEY_TOGGLE_4_WAY_MODE:
-			if (action != lastAction) {
-				options.fourWayMode = !options.fourWayMode;
-				reqSave = true;
-			}
+			options.fourWayMode = !options.fourWayMode;
+			reqSave = true;
 			break;
-		case HOTKEY_TOGGLE_DDI_4_WAY_MODE:
-			if (action != lastAction) {
-				DualDirectionalOptions& ddiOpt = Storage::getInstance().getAddonOptions().dualDirectionalOptions;
-				ddiOpt.fourWayMode = !ddiOpt.fourWayMode;
-				reqSave = true;
-			}
+		case HOTKEY_TOGGLE_DDI_4_WAY_MODE: {
+			DualDirectionalOptions& ddiOpt = Storage::getInstance().getAddonOptions().dualDirectionalOptions;
+			ddiOpt.fourWayMode = !ddiOpt.fourWayMode;
+			reqSave = true;
 			break;
+		}
 		case HOTKEY_LOAD_PROFILE_1:
-			if (action != lastAction) {
-				Storage::getInstance().setProfile(1);
-				userRequestedReinit = true;
-				reqSave = true;
-			}
+			Storage::getInstance().setProfile(1);
+			userRequestedReinit = true;
+			reqSave = true;
 			break;
 		case HOTKEY_LOAD_PROFILE_2:
-			if (action != lastAction) {
-				Storage::getInstance().setProfile(2);
-				userRequestedReinit = true;
-				reqSave = true;
-			}
+			Storage::getInstance().setProfile(2);
+			userRequestedReinit = true;
+			reqSave = true;
 			break;
 		case HOTKEY_LOAD_PROFILE_3:
-			if (action != lastAction) {
-				Storage::getInstance().setProfile(3);
-				userRequestedReinit = true;
-				reqSave = true;
-			}
+			Storage::getInstance().setProfile(3);
+			userRequestedReinit = true;
+			reqSave = true;
 			break;
 		case HOTKEY_LOAD_PROFILE_4:
-			if (action != lastAction) {
-				Storage::getInstance().setProfile(4);
-				userRequestedReinit = true;
-				reqSave = true;
-			}
+			Storage::getInstance().setProfile(4);
+			userRequestedReinit = true;
+			reqSave = true;
 			break;
 		case HOTKEY_NEXT_PROFILE:
-			if (action != lastAction) {
-				Storage::getInstance().nextProfile();
-				userRequestedReinit = true;
-				reqSave = true;
-			}
+			Storage::getInstance().nextProfile();
+			userRequestedReinit = true;
+			reqSave = true;
 			break;
 		default: // Unknown action
 			return;
 	}
 
-	// only save if requested
+	// only save if requested, the flash write is coalesced by Storage::performEnqueuedSaves()
 	if (reqSave) {
-		save();
+		Storage::getInstance().enqueueSave(STORAGE_SECTION_GAMEPAD);
 	}
 }
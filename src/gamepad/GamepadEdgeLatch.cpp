@@ -0,0 +1,85 @@
+#include "gamepad/GamepadEdgeLatch.h"
+#include "gamepad.h"
+
+GamepadEdgeLatch::GamepadEdgeLatch() {
+    for (uint8_t i = 0; i < GAMEPAD_EDGE_LATCH_BITS; i++) {
+        holdTime[i] = 0;
+    }
+    holdMask = 0;
+    preservedEdges = 0;
+    mergedEdges = 0;
+    reset();
+}
+
+void GamepadEdgeLatch::setMinHold(uint32_t mask, uint32_t holdUs) {
+    for (uint8_t i = 0; i < GAMEPAD_EDGE_LATCH_BITS; i++) {
+        if (mask & (1UL << i)) {
+            holdTime[i] = holdUs;
+            if (holdUs > 0)
+                holdMask |= (1UL << i);
+            else
+                holdMask &= ~(1UL << i);
+        }
+    }
+}
+
+void GamepadEdgeLatch::reset() {
+    previous = 0;
+    output = 0;
+    committed = 0;
+    pendingPress = 0;
+    pendingRelease = 0;
+    for (uint8_t i = 0; i < GAMEPAD_EDGE_LATCH_BITS; i++) {
+        changedAt[i] = 0;
+    }
+}
+
+uint32_t GamepadEdgeLatch::getHeldMask(uint32_t now) {
+    uint32_t held = 0;
+    for (uint8_t i = 0; i < GAMEPAD_EDGE_LATCH_BITS; i++) {
+        if ((holdMask & (1UL << i)) && (now - changedAt[i]) < holdTime[i])
+            held |= (1UL << i);
+    }
+    return held;
+}
+
+void GamepadEdgeLatch::process(Gamepad * gamepad, uint32_t now) {
+    uint32_t raw = gamepad->state.buttons;
+    uint32_t rising = raw & ~previous;
+    uint32_t falling = ~raw & previous;
+    previous = raw;
+
+    // a second edge on a bit that is already pending can not be shown separately
+    mergedEdges += __builtin_popcount(rising & pendingPress) + __builtin_popcount(falling & pendingRelease);
+    pendingPress |= rising & (~committed | pendingRelease);
+    pendingRelease |= falling & (committed | pendingPress);
+
+    // with both edges pending the host first gets the opposite of what it has
+    uint32_t both = pendingPress & pendingRelease;
+    output = (raw | pendingPress) & ~pendingRelease;
+    output = (output & ~both) | (~committed & both);
+    if (holdMask != 0) {
+        uint32_t held = getHeldMask(now);
+        output = (output & ~held) | (committed & held);
+    }
+
+    gamepad->state.buttons = output & GAMEPAD_EDGE_LATCH_ALL;
+}
+
+void GamepadEdgeLatch::commit(bool reportCommitted, uint32_t now) {
+    if (!reportCommitted)
+        return;
+
+    preservedEdges += __builtin_popcount((output ^ previous) & (pendingPress | pendingRelease));
+    pendingPress &= ~output;
+    pendingRelease &= output;
+
+    uint32_t changed = (output ^ committed) & holdMask;
+    committed = output;
+    for (uint8_t i = 0; changed != 0 && i < GAMEPAD_EDGE_LATCH_BITS; i++) {
+        if (changed & (1UL << i)) {
+            changedAt[i] = now;
+            changed &= ~(1UL << i);
+        }
+    }
+}
@@ -44,34 +44,48 @@ uint8_t getMaskFromDirection(DpadDirection direction)
 	return dpadMasks[direction-1];
 }
 
-uint8_t updateDpad(uint8_t dpad, DpadDirection direction)
+void DpadPressOrder::update(uint8_t dpad)
 {
-	static bool inList[] = {false, false, false, false, false}; // correspond to DpadDirection: none, up, down, left, right
-	static list<DpadDirection> dpadList;
+	uint8_t pressed = dpad & ~held & GAMEPAD_MASK_DPAD;
+	held = dpad & GAMEPAD_MASK_DPAD;
+	if (pressed == 0)
+		return;
 
-	if(dpad & getMaskFromDirection(direction))
+	clock++;
+	for (uint8_t i = 0; i < 4; i++)
 	{
-		if(!inList[direction])
-		{
-			dpadList.push_back(direction);
-			inList[direction] = true;
-		}
+		if (pressed & dpadMasks[i])
+			pressedAt[i] = clock;
 	}
-	else
+}
+
+void DpadPressOrder::reset()
+{
+	*this = DpadPressOrder();
+}
+
+uint8_t DpadPressOrder::latest(uint8_t mask) const
+{
+	uint8_t result = 0;
+	uint32_t resultAt = 0;
+	for (uint8_t i = 0; i < 4; i++)
 	{
-		if(inList[direction])
+		if ((held & mask & dpadMasks[i]) && pressedAt[i] >= resultAt)
 		{
-			dpadList.remove(direction);
-			inList[direction] = false;
+			result = dpadMasks[i];
+			resultAt = pressedAt[i];
 		}
 	}
+	return result;
+}
 
-	if(dpadList.empty()) {
+uint8_t DpadPressOrder::resolve(uint8_t a, uint8_t b, bool lastWins) const
+{
+	uint32_t aAt = pressedAt[__builtin_ctz(a)];
+	uint32_t bAt = pressedAt[__builtin_ctz(b)];
+	if (aAt == bAt)
 		return 0;
-	}
-	else {
-		return getMaskFromDirection(dpadList.back());
-	}
+	return ((aAt > bAt) == lastWins) ? a : b;
 }
 
 /**
@@ -79,90 +93,45 @@ uint8_t updateDpad(uint8_t dpad, DpadDirection direction)
  *
  * The most recent cardinal direction wins.
  *
+ * @param order The press order, already updated with this dpad value.
  * @param dpad The GameState.dpad value.
  * @return uint8_t The new dpad value.
  */
-uint8_t filterToFourWayMode(uint8_t dpad)
+uint8_t filterToFourWayMode(const DpadPressOrder & order, uint8_t dpad)
 {
-	updateDpad(dpad, DIRECTION_UP);
-	updateDpad(dpad, DIRECTION_DOWN);
-	updateDpad(dpad, DIRECTION_LEFT);
-	return updateDpad(dpad, DIRECTION_RIGHT);
+	return order.latest(dpad);
+}
+
+// Clean one axis: `a` and `b` are its two directions, `priority` what up-priority mode resolves them to
+static uint8_t cleanSOCDAxis(const DpadPressOrder & order, SOCDMode mode, uint8_t dpad, uint8_t a, uint8_t b, uint8_t priority)
+{
+	uint8_t axis = dpad & (a | b);
+	if (axis != (a | b))
+		return axis;
+
+	switch (mode)
+	{
+		case SOCD_MODE_UP_PRIORITY:           return priority;
+		case SOCD_MODE_SECOND_INPUT_PRIORITY: return order.resolve(a, b, true);
+		case SOCD_MODE_FIRST_INPUT_PRIORITY:  return order.resolve(a, b, false);
+		default:                              return 0;
+	}
 }
 
 /**
  * @brief Run SOCD cleaning against a D-pad value.
  *
+ * @param order The press order, already updated with the unfiltered dpad value.
  * @param mode The SOCD cleaning mode.
  * @param dpad The GamepadState.dpad value.
  * @return uint8_t The clean D-pad value.
  */
-uint8_t runSOCDCleaner(SOCDMode mode, uint8_t dpad)
+uint8_t runSOCDCleaner(const DpadPressOrder & order, SOCDMode mode, uint8_t dpad)
 {
 	if (mode == SOCD_MODE_BYPASS) {
 		return dpad;
 	}
 
-	static DpadDirection lastUD = DIRECTION_NONE;
-	static DpadDirection lastLR = DIRECTION_NONE;
-	uint8_t newDpad = 0;
-
-	switch (dpad & (GAMEPAD_MASK_UP | GAMEPAD_MASK_DOWN))
-	{
-		case (GAMEPAD_MASK_UP | GAMEPAD_MASK_DOWN):
-			if (mode == SOCD_MODE_UP_PRIORITY)
-			{
-				newDpad |= GAMEPAD_MASK_UP;
-				lastUD = DIRECTION_UP;
-			}
-			else if (mode == SOCD_MODE_SECOND_INPUT_PRIORITY && lastUD != DIRECTION_NONE)
-				newDpad |= (lastUD == DIRECTION_UP) ? GAMEPAD_MASK_DOWN : GAMEPAD_MASK_UP;
-			else if (mode == SOCD_MODE_FIRST_INPUT_PRIORITY && lastUD != DIRECTION_NONE)
-				newDpad |= (lastUD == DIRECTION_UP) ? GAMEPAD_MASK_UP : GAMEPAD_MASK_DOWN;
-			else
-				lastUD = DIRECTION_NONE;
-			break;
-
-		case GAMEPAD_MASK_UP:
-			newDpad |= GAMEPAD_MASK_UP;
-			lastUD = DIRECTION_UP;
-			break;
-
-		case GAMEPAD_MASK_DOWN:
-			newDpad |= GAMEPAD_MASK_DOWN;
-			lastUD = DIRECTION_DOWN;
-			break;
-
-		default:
-			lastUD = DIRECTION_NONE;
-			break;
-	}
-
-	switch (dpad & (GAMEPAD_MASK_LEFT | GAMEPAD_MASK_RIGHT))
-	{
-		case (GAMEPAD_MASK_LEFT | GAMEPAD_MASK_RIGHT):
-			if (mode == SOCD_MODE_SECOND_INPUT_PRIORITY && lastLR != DIRECTION_NONE)
-				newDpad |= (lastLR == DIRECTION_LEFT) ? GAMEPAD_MASK_RIGHT : GAMEPAD_MASK_LEFT;
-			else if (mode == SOCD_MODE_FIRST_INPUT_PRIORITY && lastLR != DIRECTION_NONE)
-				newDpad |= (lastLR == DIRECTION_LEFT) ? GAMEPAD_MASK_LEFT : GAMEPAD_MASK_RIGHT;
-			else
-				lastLR = DIRECTION_NONE;
-			break;
-
-		case GAMEPAD_MASK_LEFT:
-			newDpad |= GAMEPAD_MASK_LEFT;
-			lastLR = DIRECTION_LEFT;
-			break;
-
-		case GAMEPAD_MASK_RIGHT:
-			newDpad |= GAMEPAD_MASK_RIGHT;
-			lastLR = DIRECTION_RIGHT;
-			break;
-
-		default:
-			lastLR = DIRECTION_NONE;
-			break;
-	}
-
-	return newDpad;
+	return cleanSOCDAxis(order, mode, dpad, GAMEPAD_MASK_UP, GAMEPAD_MASK_DOWN, GAMEPAD_MASK_UP)
+		| cleanSOCDAxis(order, mode, dpad, GAMEPAD_MASK_LEFT, GAMEPAD_MASK_RIGHT, 0);
 }
@@ -0,0 +1,168 @@
+#include "gamepad/GpioEdgeCapture.h"
+
+#include "hardware/irq.h"
+#include "hardware/structs/iobank0.h"
+#include "hardware/timer.h"
+
+#define GPIO_EDGE_EVENTS (GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL)
+
+// The IRQ handler has no instance, it feeds this queue for the pins in edgePins
+static GpioEdgeQueue edgeQueue;
+static Mask_t edgePins = 0;
+
+// Called from the IRQ handler, so it has to stay out of flash as well
+bool __not_in_flash_func(GpioEdgeQueue::push)(const GpioEdgeEvent & event) {
+    uint16_t h = head.load(std::memory_order_relaxed);
+    if ((uint16_t)(h - tail.load(std::memory_order_acquire)) >= GPIO_EDGE_QUEUE_SIZE) {
+        overflow.store(true);
+        return false;
+    }
+    events[h & (GPIO_EDGE_QUEUE_SIZE - 1)] = event;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+}
+
+bool GpioEdgeQueue::peek(GpioEdgeEvent & event) const {
+    uint16_t t = tail.load(std::memory_order_relaxed);
+    if (head.load(std::memory_order_acquire) == t)
+        return false;
+    event = events[t & (GPIO_EDGE_QUEUE_SIZE - 1)];
+    return true;
+}
+
+void GpioEdgeQueue::pop() {
+    tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void GpioEdgeQueue::clear() {
+    tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+void __not_in_flash_func(GpioEdgeCapture::irqHandler)() {
+    uint32_t now = time_us_32();
+    for (uint8_t pin = 0; pin < NUM_BANK0_GPIOS; pin++) {
+        if (!(edgePins & (1UL << pin)))
+            continue;
+        uint32_t events = gpio_get_irq_event_mask(pin) & GPIO_EDGE_EVENTS;
+        if (events == 0)
+            continue;
+        io_bank0_hw->intr[pin / 8] = events << (4 * (pin % 8)); // gpio_acknowledge_irq() lives in flash
+
+        // buttons are pulled up, so a falling edge is a press
+        if (events == GPIO_EDGE_EVENTS) {
+            // both edges since the last interrupt: the order is lost, but the pin now sits at the second one
+            uint8_t pressed = !gpio_get(pin);
+            edgeQueue.push({now, pin, (uint8_t)!pressed});
+            edgeQueue.push({now, pin, pressed});
+        } else {
+            edgeQueue.push({now, pin, (uint8_t)(events == GPIO_IRQ_EDGE_FALL)});
+        }
+    }
+}
+
+void GpioEdgeCapture::setup(Mask_t pins) {
+    pinMask = pins;
+    for (uint8_t pin = 0; pin < NUM_BANK0_GPIOS; pin++) {
+        changedAt[pin] = 0;
+        levelAt[pin] = 0;
+    }
+    if (pins == 0)
+        return;
+
+    // nothing is producing until the pin interrupts are enabled below
+    edgeQueue.clear();
+    edgeQueue.takeOverflow();
+    edgePins = pins;
+    levels = ~gpio_get_all() & pins;
+    gpio_add_raw_irq_handler_masked(pins, irqHandler);
+
+    for (uint8_t pin = 0; pin < NUM_BANK0_GPIOS; pin++) {
+        if (pins & (1UL << pin)) {
+            gpio_acknowledge_irq(pin, GPIO_EDGE_EVENTS);
+            gpio_set_irq_enabled(pin, GPIO_EDGE_EVENTS, true);
+        }
+    }
+    irq_set_enabled(IO_IRQ_BANK0, true);
+}
+
+void GpioEdgeCapture::teardown() {
+    if (pinMask == 0)
+        return;
+
+    for (uint8_t pin = 0; pin < NUM_BANK0_GPIOS; pin++) {
+        if (pinMask & (1UL << pin))
+            gpio_set_irq_enabled(pin, GPIO_EDGE_EVENTS, false);
+    }
+    gpio_remove_raw_irq_handler_masked(pinMask, irqHandler);
+    edgePins = 0;
+    pinMask = 0;
+}
+
+/**
+ * @brief Apply the queued edges to the debounced state.
+ *
+ * This replays the polling debouncer on the IRQ timestamps: a change is taken as soon as it happens, later
+ * edges within the debounce delay are ignored, and a pin that ends that window at the other level settles
+ * there when it runs out, dated from the edge that took it there. A pin changes at most once per call, a
+ * second change stays queued so the caller gets to read the first one.
+ */
+Mask_t GpioEdgeCapture::process(Mask_t debounced, uint32_t debounceDelayUs) {
+    if (edgeQueue.takeOverflow()) {
+        // edges were dropped, start over from the pin levels
+        overflows++;
+        edgeQueue.clear();
+        Mask_t raw = ~gpio_get_all() & pinMask;
+        uint32_t now = time_us_32();
+        for (uint8_t pin = 0; pin < NUM_BANK0_GPIOS; pin++) {
+            if ((raw ^ levels) & (1UL << pin))
+                levelAt[pin] = now;
+        }
+        levels = raw;
+    }
+
+    Mask_t changed = 0;
+    GpioEdgeEvent event;
+    while (edgeQueue.peek(event)) {
+        Mask_t mask = 1UL << event.pin;
+        uint32_t & at = changedAt[event.pin];
+
+        // the debounce window of the last change ran out before this edge, with the pin at the other level
+        if (((levels ^ debounced) & mask) && (event.timeUs - at) > debounceDelayUs) {
+            if (changed & mask)
+                return debounced;
+            debounced ^= mask;
+            at = levelAt[event.pin];
+            changed |= mask;
+        }
+
+        Mask_t newLevels = event.pressed ? (levels | mask) : (levels & ~mask);
+        if (((newLevels ^ debounced) & mask) && (debounceDelayUs == 0 || (event.timeUs - at) > debounceDelayUs)) {
+            if (changed & mask)
+                return debounced; // show this state first, the rest of the queue waits for the next read
+            debounced ^= mask;
+            at = event.timeUs;
+            changed |= mask;
+        }
+        if ((newLevels ^ levels) & mask)
+            levelAt[event.pin] = event.timeUs;
+        levels = newLevels;
+        edgeQueue.pop();
+    }
+
+    // settle pins whose window ran out after their last queued edge
+    Mask_t settle = (levels ^ debounced) & pinMask & ~changed;
+    if (settle != 0) {
+        uint32_t now = time_us_32();
+        for (uint8_t pin = 0; settle != 0 && pin < NUM_BANK0_GPIOS; pin++) {
+            Mask_t mask = 1UL << pin;
+            if (!(settle & mask))
+                continue;
+            settle &= ~mask;
+            if ((now - changedAt[pin]) > debounceDelayUs) {
+                debounced ^= mask;
+                changedAt[pin] = levelAt[pin];
+            }
+        }
+    }
+    return debounced;
+}
@@ -19,6 +19,7 @@
 #include "addons/dualdirectional.h"
 #include "addons/tilt.h"
 #include "addons/keyboard_host.h"
+#include "addons/gamepad_usb_host.h"
 #include "addons/i2canalog1219.h"
 #include "addons/jslider.h"
 #include "addons/playernum.h"
@@ -42,6 +43,7 @@
 
 // USB Input Class Drivers
 #include "drivermanager.h"
+#include "usbdriver.h"
 
 static const uint32_t REBOOT_HOTKEY_ACTIVATION_TIME_MS = 50;
 static const uint32_t REBOOT_HOTKEY_HOLD_TIME_MS = 4000;
@@ -68,6 +70,7 @@ void GP2040::setup() {
 
 	// Setup Gamepad
 	gamepad->setup();
+	edgeLatch.setMinHold(GAMEPAD_EDGE_LATCH_ALL, GAMEPAD_MIN_HOLD_US);
 	
 	// now we can load the latest configured profile, which will map the
 	// new set of GPIOs to use...
@@ -91,6 +94,7 @@ void GP2040::setup() {
 
 	// Setup Add-ons
 	addons.LoadUSBAddon(new KeyboardHostAddon(), CORE0_INPUT);
+	addons.LoadUSBAddon(new GamepadUSBHostAddon(), CORE0_INPUT);
 	addons.LoadAddon(new AnalogInput(), CORE0_INPUT);
 	addons.LoadAddon(new BootselButtonAddon(), CORE0_INPUT);
 	addons.LoadAddon(new DualDirectionalInput(), CORE0_INPUT);
@@ -197,12 +201,24 @@ void GP2040::initializeStandardGpio() {
 			buttonGpios |= 1 << pin;    // mark this pin as mattering for GPIO debouncing
 		}
 	}
+#if GPIO_EDGE_CAPTURE_ENABLED
+	edgeCapture.setup(buttonGpios);
+#endif
+#if LOOP_GOVERNOR_ENABLED
+	governor.setWakePins(buttonGpios);
+#endif
 }
 
 /**
  * @brief Deinitialize standard input button GPIOs that are present in the currently loaded profile.
  */
 void GP2040::deinitializeStandardGpio() {
+#if LOOP_GOVERNOR_ENABLED
+	governor.setWakePins(0);
+#endif
+#if GPIO_EDGE_CAPTURE_ENABLED
+	edgeCapture.teardown();
+#endif
 	GpioAction* pinMappings = Storage::getInstance().getProfilePinMappings();
 	for (Pin_t pin = 0; pin < (Pin_t)NUM_BANK0_GPIOS; pin++)
 	{
@@ -223,10 +239,17 @@ void GP2040::deinitializeStandardGpio() {
  * For ease of use this provides the mask bitwise NOTed so that callers don't have to. To avoid misuse
  * and to simplify this method, non-button GPIO IS NOT PRESENT in this result. Use gpio_get_all directly
  * instead, if you don't want debounced data.
+ *
+ * With GPIO_EDGE_CAPTURE_ENABLED the levels come from the edge interrupts instead, so presses shorter
+ * than a loop iteration are not lost while the loop is held up by flash, I2C or display work.
  */
 void GP2040::debounceGpioGetAll() {
-	Mask_t raw_gpio = ~gpio_get_all();
 	Gamepad* gamepad = Storage::getInstance().GetGamepad();
+#if GPIO_EDGE_CAPTURE_ENABLED
+	gamepad->debouncedGpio = edgeCapture.process(gamepad->debouncedGpio,
+		Storage::getInstance().getGamepadOptions().debounceDelay * 1000);
+#else
+	Mask_t raw_gpio = ~gpio_get_all();
 	// return if state isn't different than the actual
 	if (gamepad->debouncedGpio == (raw_gpio & buttonGpios)) return;
 
@@ -250,16 +273,33 @@ void GP2040::debounceGpioGetAll() {
 			}
 		}
 	}
+#endif
 }
 
 void GP2040::run() {
-	GPDriver * inputDriver = DriverManager::getInstance().getDriver();
+	// switchMode builds every driver at the same address, inputDriver stays valid across mode changes
+	DriverManager& driverManager = DriverManager::getInstance();
+	GPDriver * inputDriver = driverManager.getDriver();
 	Gamepad * gamepad = Storage::getInstance().GetGamepad();
 	Gamepad * processedGamepad = Storage::getInstance().GetProcessedGamepad();
 	bool configMode = Storage::getInstance().GetConfigMode();
 	uint8_t * featureData = Storage::getInstance().GetFeatureData();
 	memset(featureData, 0, 32); // X-Input is the only feature data currently supported
+	bool firstReportSent = false;
+	uint32_t driverGeneration = driverManager.getGeneration();
+#if LOOP_GOVERNOR_ENABLED
+	governor.setup(LoopGovernor::getPollIntervalUs(inputDriver->get_descriptor_configuration_cb(0)));
+#endif
 	while (1) { // LOOP
+		// Pick up a mode change made by the reboot hotkeys
+		if (driverGeneration != driverManager.getGeneration()) {
+			driverGeneration = driverManager.getGeneration();
+			configMode = Storage::getInstance().GetConfigMode();
+#if LOOP_GOVERNOR_ENABLED
+			governor.setup(LoopGovernor::getPollIntervalUs(inputDriver->get_descriptor_configuration_cb(0)));
+#endif
+		}
+
 		this->getReinitGamepad(gamepad);
 
 		// Do any queued saves in StorageManager
@@ -278,8 +318,10 @@ void GP2040::run() {
 			continue;
 		}
 
+#if !USB_HOST_ON_CORE1
 		// Process USB Host on Core0
 		USBHostManager::getInstance().process();
+#endif
 
 		// Pre-Process add-ons for MPGS
 		addons.PreprocessAddons(ADDON_PROCESS::CORE0_INPUT);
@@ -293,15 +335,43 @@ void GP2040::run() {
 		addons.ProcessAddons(ADDON_PROCESS::CORE0_INPUT);
 
 		// Copy Processed Gamepad for Core1 (race condition otherwise)
+#if LOOP_GOVERNOR_ENABLED
+		const bool stateChanged = memcmp(&processedGamepad->state, &gamepad->state, sizeof(GamepadState)) != 0;
+#endif
 		memcpy(&processedGamepad->state, &gamepad->state, sizeof(GamepadState));
+#if LOOP_GOVERNOR_ENABLED
+		if (stateChanged) {
+			// wake core1 for the new state. SEV sets our own event register as well, the WFE takes it
+			// straight back so governor.idle() below still sleeps
+			__sev();
+			__wfe();
+		}
+#endif
 
-		// Process Input Driver
+		// Latch button edges the host has not seen yet, then process Input Driver
+		uint32_t now = time_us_32();
+		edgeLatch.process(gamepad, now);
 		inputDriver->process(gamepad, featureData);
+		edgeLatch.commit(inputDriver->isReportCommitted(), now);
+		if (!firstReportSent && get_usb_mounted() && inputDriver->isReportCommitted()) {
+			System::markBootEvent(System::BootEvent::FIRST_REPORT);
+			firstReportSent = true;
+		}
 		
 		// Process USB Report Addons
 		addons.ProcessAddons(ADDON_PROCESS::CORE0_USBREPORT);
 		
 		tud_task(); // TinyUSB Task update
+
+#if LOOP_GOVERNOR_ENABLED
+		// Sleep until the next interrupt unless something is still in flight: a report the host has
+		// not taken, a button inside its debounce window, USB host polling or a continuous add-on
+		governor.idle(!inputDriver->isReportCommitted() || edgeLatch.isPending() ||
+			((~gpio_get_all() ^ gamepad->debouncedGpio) & buttonGpios) != 0 ||
+			(!USB_HOST_ON_CORE1 && USBHostManager::getInstance().isReady()) ||
+			addons.NeedsContinuousLoop(ADDON_PROCESS::CORE0_INPUT) ||
+			addons.NeedsContinuousLoop(ADDON_PROCESS::CORE0_USBREPORT));
+#endif
 	}
 }
 
@@ -447,8 +517,12 @@ void GP2040::RebootHotkeys::process(Gamepad* gamepad, bool configMode) {
 
 			if (time_reached(rebootHotkeysHoldTimeout)) {
 				if (gamepad->state.buttons == webConfigHotkeyMask) {
-					// If we are in webconfig mode we go to gamepad mode and vice versa
-					System::reboot(configMode ? System::BootMode::GAMEPAD : System::BootMode::WEBCONFIG);
+					// Web config comes up in place. Leaving it still reboots, saved settings only load at boot
+					if (configMode || !DriverManager::getInstance().switchMode(INPUT_MODE_CONFIG))
+						System::reboot(configMode ? System::BootMode::GAMEPAD : System::BootMode::WEBCONFIG);
+					active = false;
+					noButtonsPressedTimeout = nil_time;
+					rebootHotkeysHoldTimeout = nil_time;
 				} else if (gamepad->state.buttons == bootselHotkeyMask) {
 					System::reboot(System::BootMode::USB);
 				}
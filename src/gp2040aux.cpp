@@ -14,7 +14,7 @@
 
 #include <iterator>
 
-GP2040Aux::GP2040Aux() : inputDriver(nullptr) {
+GP2040Aux::GP2040Aux() : inputDriver(nullptr), driverGeneration(0) {
 }
 
 GP2040Aux::~GP2040Aux() {
@@ -34,8 +34,15 @@ void GP2040Aux::setup() {
 	addons.LoadAddon(new BoardLedAddon(), CORE1_LOOP);
 	addons.LoadAddon(new BuzzerSpeakerAddon(), CORE1_LOOP);
 
-	// Initialize our input driver's auxilliary functions
-	inputDriver = DriverManager::getInstance().getDriver();
+	// Initialize our input driver's auxilliary functions and our USB manager
+	initializeDriverAux();
+}
+
+// core0 waits in DriverManager::switchMode until this has run for the new driver
+void GP2040Aux::initializeDriverAux() {
+	DriverManager& driverManager = DriverManager::getInstance();
+	driverGeneration = driverManager.getGeneration();
+	inputDriver = driverManager.getDriver();
 	if ( inputDriver != nullptr ) {
 		inputDriver->initializeAux();
 		
@@ -44,19 +51,46 @@ void GP2040Aux::setup() {
 		if (listener != nullptr) {
 			USBHostManager::getInstance().pushListener(listener);
 		}
+#if LOOP_GOVERNOR_ENABLED
+		governor.setup(LoopGovernor::getPollIntervalUs(inputDriver->get_descriptor_configuration_cb(0)));
+#endif
 	}
 
-	// Initialize our USB manager
+	// Does nothing once the host port is running
 	USBHostManager::getInstance().start();
+	driverManager.ackAux(driverGeneration);
 }
 
 void GP2040Aux::run() {
+	DriverManager& driverManager = DriverManager::getInstance();
 	while (1) {
-		addons.ProcessAddons(CORE1_LOOP);
-		
-		// Run auxiliary functions for input driver on Core1
-		if ( inputDriver != nullptr ) {
-			inputDriver->processAux();
+		// Bring the USB host stack up on this core once the port shows a device
+		USBHostManager::getInstance().processStart();
+
+		// The USB host, the add-ons and the driver's aux side all stay out of the way while switchMode replaces the driver
+		if ( driverManager.enterAux() ) {
+			if ( driverGeneration != driverManager.getGeneration() )
+				initializeDriverAux();
+
+#if USB_HOST_ON_CORE1
+			// Process USB Host on Core1 (not in web config, same as core0), listeners hand their state to core0 through mailboxes
+			if ( !Storage::getInstance().GetConfigMode() )
+				USBHostManager::getInstance().process();
+#endif
+
+			addons.ProcessAddons(CORE1_LOOP);
+
+			// Run auxiliary functions for input driver on Core1
+			if ( inputDriver != nullptr ) {
+				inputDriver->processAux();
+			}
+			driverManager.exitAux();
 		}
+
+#if LOOP_GOVERNOR_ENABLED
+		// core0 raises an event for every new gamepad state
+		governor.idle(addons.NeedsContinuousLoop(CORE1_LOOP) ||
+			(USB_HOST_ON_CORE1 && USBHostManager::getInstance().isReady()));
+#endif
 	}
 }
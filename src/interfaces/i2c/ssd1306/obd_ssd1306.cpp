@@ -46,7 +46,7 @@ void GPGFX_OBD_SSD1306::drawPixel(uint8_t x, uint8_t y, uint32_t color) {
 	obdSetPixel(&obd, x, y, color, 1);
 }
 
-void GPGFX_OBD_SSD1306::drawText(uint8_t x, uint8_t y, std::string text, uint8_t invert) {
+void GPGFX_OBD_SSD1306::drawText(uint8_t x, uint8_t y, const std::string& text, uint8_t invert) {
     obdWriteString(&obd, 0, x, y, (char*)text.c_str(), FONT_6x8, 0, 1);
 }
 
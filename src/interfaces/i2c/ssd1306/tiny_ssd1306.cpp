@@ -138,7 +138,7 @@ void GPGFX_TinySSD1306::drawPixel(uint8_t x, uint8_t y, uint32_t color) {
 	}
 }
 
-void GPGFX_TinySSD1306::drawText(uint8_t x, uint8_t y, std::string text, uint8_t invert) {
+void GPGFX_TinySSD1306::drawText(uint8_t x, uint8_t y, const std::string& text, uint8_t invert) {
 	uint8_t spriteX, spriteY;
 	uint8_t spriteByte;
 	uint8_t spriteBit;
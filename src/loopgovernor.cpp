@@ -0,0 +1,86 @@
+#include "loopgovernor.h"
+#include "gamepad/GpioEdgeCapture.h"
+
+#include "pico/time.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+
+#define USB_DESC_CONFIGURATION 0x02
+#define USB_DESC_ENDPOINT 0x05
+#define USB_ENDPOINT_IN 0x80
+#define USB_XFER_INTERRUPT 0x03
+
+void LoopGovernor::setup(uint32_t pollIntervalUs) {
+    sleepUs = pollIntervalUs / 2;
+    if (sleepUs < LOOP_GOVERNOR_MIN_SLEEP_US)
+        sleepUs = LOOP_GOVERNOR_MIN_SLEEP_US;
+    else if (sleepUs > LOOP_GOVERNOR_MAX_SLEEP_US)
+        sleepUs = LOOP_GOVERNOR_MAX_SLEEP_US;
+}
+
+#if !GPIO_EDGE_CAPTURE_ENABLED
+// Without edge capture nothing else listens to the button GPIO, the interrupt only has to wake the core
+static Mask_t wakePins = 0;
+
+static void __not_in_flash_func(wakeIrqHandler)() {
+    for (uint8_t pin = 0; pin < NUM_BANK0_GPIOS; pin++) {
+        if (!(wakePins & (1UL << pin)))
+            continue;
+        uint32_t events = gpio_get_irq_event_mask(pin) & (GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL);
+        if (events != 0)
+            gpio_acknowledge_irq(pin, events);
+    }
+}
+#endif
+
+void LoopGovernor::setWakePins(Mask_t pins) {
+#if !GPIO_EDGE_CAPTURE_ENABLED
+    if (wakePins != 0) {
+        for (uint8_t pin = 0; pin < NUM_BANK0_GPIOS; pin++) {
+            if (wakePins & (1UL << pin))
+                gpio_set_irq_enabled(pin, GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL, false);
+        }
+        gpio_remove_raw_irq_handler_masked(wakePins, wakeIrqHandler);
+    }
+
+    wakePins = pins;
+    if (pins == 0)
+        return;
+
+    gpio_add_raw_irq_handler_masked(pins, wakeIrqHandler);
+    for (uint8_t pin = 0; pin < NUM_BANK0_GPIOS; pin++) {
+        if (pins & (1UL << pin)) {
+            gpio_acknowledge_irq(pin, GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL);
+            gpio_set_irq_enabled(pin, GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL, true);
+        }
+    }
+    irq_set_enabled(IO_IRQ_BANK0, true);
+#else
+    (void)pins; // GpioEdgeCapture already has an interrupt on every button edge
+#endif
+}
+
+void LoopGovernor::idle(bool busy) {
+    if (busy || sleepUs == 0)
+        return;
+
+    // one __wfe(), backed by an alarm in case no interrupt comes
+    best_effort_wfe_or_timeout(make_timeout_time_us(sleepUs));
+}
+
+uint32_t LoopGovernor::getPollIntervalUs(const uint8_t * configDescriptor) {
+    uint32_t intervalMs = 0;
+    if (configDescriptor != nullptr && configDescriptor[1] == USB_DESC_CONFIGURATION) {
+        uint16_t totalLength = configDescriptor[2] | (configDescriptor[3] << 8);
+        for (uint16_t offset = 0; offset + 1 < totalLength && configDescriptor[offset] != 0; offset += configDescriptor[offset]) {
+            const uint8_t * desc = &configDescriptor[offset];
+            // bLength, bDescriptorType, bEndpointAddress, bmAttributes, wMaxPacketSize, bInterval
+            if (desc[1] == USB_DESC_ENDPOINT && desc[0] >= 7 && (desc[2] & USB_ENDPOINT_IN) &&
+                (desc[3] & 0x03) == USB_XFER_INTERRUPT && desc[6] != 0) {
+                if (intervalMs == 0 || desc[6] < intervalMs)
+                    intervalMs = desc[6]; // full speed: frames of 1 ms
+            }
+        }
+    }
+    return (intervalMs != 0 ? intervalMs : 1) * 1000;
+}
@@ -83,16 +83,80 @@ static void updateAnimationOptionsProto(const AnimationOptions& options)
 	optionsProto.buttonPressColorCooldownTimeInMs = options.buttonPressColorCooldownTimeInMs;	
 }
 
+void Storage::enqueueSave(uint32_t sections)
+{
+	dirtySections.fetch_or(sections);
+	saveRequests.fetch_add(1);
+}
+
+/**
+ * @brief Write the config for the sections marked dirty, at most as often as flash should be erased.
+ *
+ * Every enqueue restarts the quiet period, so mashing a profile hotkey ends in one write of the last profile
+ * rather than one per press. A burst that never goes quiet is written after STORAGE_SAVE_MAX_DELAY_MS. Writes
+ * then spend a token each, once the bucket is empty a pending save waits for the next refill. Nothing is lost
+ * while waiting, the in-memory config is what gets written when the save does run.
+ */
 void Storage::performEnqueuedSaves()
 {
-	if (animationOptionsSavePending.load())
+	const uint32_t now = getMillis();
+
+	// refill the bucket for the time that passed
+	if (saveTokens >= STORAGE_SAVE_BURST) {
+		tokenRefillMs = now;
+	} else {
+		while (saveTokens < STORAGE_SAVE_BURST && (now - tokenRefillMs) >= STORAGE_SAVE_REFILL_MS) {
+			saveTokens++;
+			tokenRefillMs += STORAGE_SAVE_REFILL_MS;
+		}
+	}
+
+	const uint32_t requests = saveRequests.load();
+	if (requests != seenSaveRequests) {
+		if (!saveBurstPending) {
+			firstChangeMs = now;
+			saveBurstPending = true;
+		}
+		lastChangeMs = now;
+		seenSaveRequests = requests;
+	}
+
+	if (dirtySections.load() == 0) {
+		saveBurstPending = false; // already written by an earlier commit
+		return;
+	}
+	if (saveTokens == 0)
+		return;
+	if ((now - lastChangeMs) < STORAGE_SAVE_QUIET_MS && (now - firstChangeMs) < STORAGE_SAVE_MAX_DELAY_MS)
+		return;
+
+	saveTokens--;
+	commitEnqueuedSaves();
+}
+
+void Storage::flushSaves()
+{
+	if (dirtySections.load() != 0)
+		commitEnqueuedSaves();
+}
+
+void Storage::commitEnqueuedSaves()
+{
+	// sections marked after this point stay dirty for the next save
+	const uint32_t sections = dirtySections.exchange(0);
+	saveBurstPending = false;
+
+	if (sections & STORAGE_SECTION_ANIMATION)
 	{
 		critical_section_enter_blocking(&animationOptionsCs);
 		updateAnimationOptionsProto(animationOptionsToSave);
 		save();
-		animationOptionsSavePending.store(false);
 		critical_section_exit(&animationOptionsCs);
 	}
+	else
+	{
+		save();
+	}
 }
 
 void Storage::enqueueAnimationOptionsSave(const AnimationOptions& animationOptions)
@@ -103,7 +167,7 @@ void Storage::enqueueAnimationOptionsSave(const AnimationOptions& animationOptio
 	{
 		animationOptionsToSave = animationOptions;
 		animationOptionsCrc = crc;
-		animationOptionsSavePending.store(true);
+		enqueueSave(STORAGE_SECTION_ANIMATION);
 	}
 	critical_section_exit(&animationOptionsCs);
 }
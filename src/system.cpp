@@ -1,9 +1,11 @@
 #include "system.h"
 
 #include "usbhostmanager.h"
+#include "storagemanager.h"
 
 #include <hardware/flash.h>
 #include <hardware/sync.h>
+#include <hardware/timer.h>
 #include <hardware/watchdog.h>
 #include <pico/multicore.h>
 
@@ -15,6 +17,36 @@ extern char __bss_end__;
 extern char __StackLimit;
 extern char __StackTop;
 
+// Boot timing survives a software reboot in watchdog scratch 0-2: two events per register in 16-bit
+// milliseconds, then a marker. scratch 4-7 are taken by the bootrom and the boot mode.
+#define BOOT_TIMING_MAGIC 0xb0071e00
+
+static_assert(static_cast<uint8_t>(System::BootEvent::COUNT) == 4, "boot timing packs four events into scratch 0-1");
+
+static uint32_t bootEventsUs[static_cast<uint8_t>(System::BootEvent::COUNT)] = {};
+static uint16_t previousBootEventsMs[static_cast<uint8_t>(System::BootEvent::COUNT)] = {};
+
+static void saveBootTiming() {
+    uint16_t eventsMs[static_cast<uint8_t>(System::BootEvent::COUNT)];
+    for (uint8_t i = 0; i < static_cast<uint8_t>(System::BootEvent::COUNT); i++) {
+        uint32_t ms = (bootEventsUs[i] + 999) / 1000;
+        eventsMs[i] = ms > 0xffff ? 0xffff : ms;
+    }
+    watchdog_hw->scratch[0] = eventsMs[0] | (eventsMs[1] << 16);
+    watchdog_hw->scratch[1] = eventsMs[2] | (eventsMs[3] << 16);
+    watchdog_hw->scratch[2] = BOOT_TIMING_MAGIC;
+}
+
+static void takeBootTiming() {
+    if (watchdog_hw->scratch[2] != BOOT_TIMING_MAGIC)
+        return;
+    previousBootEventsMs[0] = watchdog_hw->scratch[0] & 0xffff;
+    previousBootEventsMs[1] = watchdog_hw->scratch[0] >> 16;
+    previousBootEventsMs[2] = watchdog_hw->scratch[1] & 0xffff;
+    previousBootEventsMs[3] = watchdog_hw->scratch[1] >> 16;
+    watchdog_hw->scratch[2] = 0;
+}
+
 uint32_t System::getTotalFlash() {
 #if defined(PICO_FLASH_SIZE_BYTES)
     return PICO_FLASH_SIZE_BYTES;
@@ -43,6 +75,10 @@ uint32_t System::getUsedHeap() {
 }
 
 void System::reboot(BootMode bootMode) {
+    // Write changes still waiting out their quiet period, flash can only be written from core0
+    if (get_core_num() == 0)
+        Storage::getInstance().flushSaves();
+
     // Halt all running USB instances
     USBHostManager::getInstance().shutdown();
 
@@ -51,6 +87,7 @@ void System::reboot(BootMode bootMode) {
 	multicore_lockout_start_timeout_us(0xfffffffffffffff);
 
 	watchdog_hw->scratch[5] = static_cast<uint32_t>(bootMode);
+	saveBootTiming();
 
     // This is based on MicroPythons machine.reset()
 	watchdog_reboot(0, 0, 0);
@@ -65,6 +102,8 @@ System::BootMode System::takeBootMode() {
         return BootMode::DEFAULT;
     }
 
+    takeBootTiming();
+
     BootMode bootMode = static_cast<BootMode>(watchdog_hw->scratch[5]);
     if (bootMode != BootMode::GAMEPAD && bootMode != BootMode::WEBCONFIG && bootMode != BootMode::USB) {
         bootMode = BootMode::DEFAULT;
@@ -76,3 +115,19 @@ System::BootMode System::takeBootMode() {
 
     return bootMode;
 }
+
+void System::markBootEvent(BootEvent event) {
+    uint32_t & at = bootEventsUs[static_cast<uint8_t>(event)];
+    if (at == 0) {
+        uint32_t now = time_us_32();
+        at = now != 0 ? now : 1;
+    }
+}
+
+uint32_t System::getBootEventUs(BootEvent event) {
+    return bootEventsUs[static_cast<uint8_t>(event)];
+}
+
+uint32_t System::getPreviousBootEventMs(BootEvent event) {
+    return previousBootEventsMs[static_cast<uint8_t>(event)];
+}
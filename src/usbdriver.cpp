@@ -8,6 +8,7 @@
 
 #include "tusb.h"
 #include "drivermanager.h"
+#include "system.h"
 
 static bool usb_mounted;
 static bool usb_suspended;
@@ -40,6 +41,7 @@ void tud_hid_set_report_cb(uint8_t itf, uint8_t report_id, hid_report_type_t rep
 void tud_mount_cb(void)
 {
 	usb_mounted = true;
+	System::markBootEvent(System::BootEvent::DEVICE_MOUNTED);
 }
 
 // Invoked when device is unmounted
@@ -1,6 +1,7 @@
 #include "usbhostmanager.h"
 #include "storagemanager.h"
 #include "peripheralmanager.h"
+#include "system.h"
 
 #include "pio_usb.h"
 #include "tusb.h"
@@ -10,35 +11,94 @@
 
 #include "drivers/shared/xinput_host.h"
 
+#include <algorithm>
+
 void USBHostManager::start() {
+    // A mode switch can bring the first listener, after that the port is already ours
+    if (state.load() != HostState::DISABLED) {
+        return;
+    }
+
     // This will happen after Gamepad has initialized
     if (PeripheralManager::getInstance().isUSBEnabled(0) && listeners.size() > 0) {
-        sleep_ms(1000); // TinyUSB HOST Start-Up Temporary Fix : TO-DO 06.11.2024
+        // Watch the port lines until something is plugged in, PIO-USB takes the pins over in processStart()
         pio_usb_configuration_t* pio_cfg = PeripheralManager::getInstance().getUSB(0)->getController();
-        tuh_configure(1, TUH_CFGID_RPI_PIO_USB_CONFIGURATION, pio_cfg);
-        tuh_init(BOARD_TUH_RHPORT);
-        sleep_us(10); // ensure we are ready
-        tuh_ready = true;
+        dataPin = pio_cfg->pin_dp;
+        dmPin = (pio_cfg->pinout == PIO_USB_PINOUT_DPDM) ? dataPin + 1 : dataPin - 1;
+        gpio_init(dataPin);
+        gpio_set_dir(dataPin, GPIO_IN);
+        gpio_pull_down(dataPin);
+        gpio_init(dmPin);
+        gpio_set_dir(dmPin, GPIO_IN);
+        gpio_pull_down(dmPin);
+        state.store(HostState::WAIT_DEVICE);
     } else {
-        tuh_ready = false;
+        state.store(HostState::DISABLED);
     }
 }
 
 // Shut down the USB bus if we are running USB right now
 void USBHostManager::shutdown() {
-    if ( tuh_ready ) {
+    if ( state.load() == HostState::RUNNING ) {
         tuh_deinit(BOARD_TUH_RHPORT);
     }
 }
 
+// A device pulls D+ (full speed) or D- (low speed) up against the host pull-downs, SE0 is an empty port
+bool USBHostManager::lineAttached() {
+    return gpio_get(dataPin) || gpio_get(dmPin);
+}
+
+void USBHostManager::startHost() {
+    pio_usb_configuration_t* pio_cfg = PeripheralManager::getInstance().getUSB(0)->getController();
+    tuh_configure(1, TUH_CFGID_RPI_PIO_USB_CONFIGURATION, pio_cfg);
+    if ( tuh_init(BOARD_TUH_RHPORT) && tuh_inited() ) {
+        state.store(HostState::RUNNING);
+        System::markBootEvent(System::BootEvent::HOST_READY);
+    } else {
+        state.store(HostState::DISABLED);
+    }
+}
+
 void USBHostManager::pushListener(USBListener * usbListener) { // If anything needs to update in the gpconfig driver
     listeners.push_back(usbListener);
 }
 
-// Host manager should call tuh_task as fast as possible
+void USBHostManager::removeListener(USBListener * usbListener) {
+    listeners.erase(std::remove(listeners.begin(), listeners.end(), usbListener), listeners.end());
+}
+
+// Host manager should call tuh_task as fast as possible, until then it decides when the host stack comes up:
+// after the device side, and once the port has shown a device for USB_HOST_ATTACH_SETTLE_US (processStart() does it)
 void USBHostManager::process() {
-    if ( tuh_ready ){
-        tuh_task();
+    switch ( state.load() ) {
+        case HostState::RUNNING:
+            tuh_task();
+            break;
+        case HostState::WAIT_DEVICE:
+            if ( tud_inited() ) {
+                attachedSince = 0;
+                state.store(HostState::WAIT_ATTACH);
+            }
+            break;
+        case HostState::WAIT_ATTACH:
+            if ( !lineAttached() ) {
+                attachedSince = 0;
+            } else if ( attachedSince == 0 ) {
+                attachedSince = time_us_32() | 1;
+            } else if ( time_us_32() - attachedSince >= USB_HOST_ATTACH_SETTLE_US ) {
+                state.store(HostState::START);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// PIO-USB runs its frame alarm on the core that calls tuh_init(), keep that on core1 like the blocking start did
+void USBHostManager::processStart() {
+    if ( state.load() == HostState::START ) {
+        startHost();
     }
 }
 
@@ -0,0 +1,111 @@
+#include "usbhostslots.h"
+
+static bool stickMoved(uint16_t value) {
+	return value < GAMEPAD_JOYSTICK_MID - USB_HOST_STICK_DEADZONE || value > GAMEPAD_JOYSTICK_MID + USB_HOST_STICK_DEADZONE;
+}
+
+USBHostSlots::USBHostSlots() : prioritySlot(-1) {
+	for (uint8_t slot = 0; slot < USB_HOST_MAX_DEVICES; slot++)
+		release(slot);
+}
+
+int8_t USBHostSlots::claim(uint8_t dev_addr, uint8_t instance) {
+	int8_t slot = find(dev_addr, instance);
+	if (slot >= 0)
+		return slot;
+	for (slot = 0; slot < USB_HOST_MAX_DEVICES; slot++) {
+		if (devAddr[slot] == 0) {
+			devAddr[slot] = dev_addr;
+			instances[slot] = instance;
+			return slot;
+		}
+	}
+	return -1;
+}
+
+int8_t USBHostSlots::find(uint8_t dev_addr, uint8_t instance) const {
+	for (int8_t slot = 0; slot < USB_HOST_MAX_DEVICES; slot++) {
+		if (devAddr[slot] != 0 && devAddr[slot] == dev_addr && instances[slot] == instance)
+			return slot;
+	}
+	return -1;
+}
+
+void USBHostSlots::release(int8_t slot) {
+	states[slot].write(GamepadState());
+	devAddr[slot] = 0;
+	instances[slot] = 0;
+}
+
+void USBHostSlots::releaseDevice(uint8_t dev_addr) {
+	for (int8_t slot = 0; slot < USB_HOST_MAX_DEVICES; slot++) {
+		if (devAddr[slot] != 0 && devAddr[slot] == dev_addr)
+			release(slot);
+	}
+}
+
+bool USBHostSlots::hasInput(const GamepadState & state) {
+	return state.buttons != 0 || state.dpad != 0 || state.lt != 0 || state.rt != 0 ||
+		stickMoved(state.lx) || stickMoved(state.ly) || stickMoved(state.rx) || stickMoved(state.ry);
+}
+
+/**
+ * @brief Combine the slot states.
+ *
+ * HOST_MERGE_OR adds everything up: buttons and dpad are ORed, triggers take the deepest press and each stick
+ * comes from the lowest slot that has it out of the deadzone. HOST_MERGE_PRIORITY hands the whole state to the
+ * first slot seen with input and keeps it there until that slot goes idle, only then does the lowest slot with
+ * input take over. A released slot publishes neutral, so an unplugged owner lets go too. HOST_MERGE_PLAYER only
+ * passes playerSlot through, so a board on a shared hub can be one player of several.
+ */
+void USBHostSlots::merge(GamepadState & merged, HostMergeMode mode, uint8_t playerSlot) {
+	merged = GamepadState();
+
+	if (mode == HOST_MERGE_PRIORITY && prioritySlot >= 0) {
+		GamepadState state;
+		states[prioritySlot].read(state);
+		if (hasInput(state)) {
+			merged = state;
+			return;
+		}
+		prioritySlot = -1;
+	}
+
+	if (mode == HOST_MERGE_PLAYER) {
+		if (playerSlot < USB_HOST_MAX_DEVICES)
+			states[playerSlot].read(merged);
+		return;
+	}
+
+	bool leftTaken = false, rightTaken = false;
+	for (uint8_t slot = 0; slot < USB_HOST_MAX_DEVICES; slot++) {
+		GamepadState state;
+		states[slot].read(state);
+
+		if (mode == HOST_MERGE_PRIORITY) {
+			if (hasInput(state)) {
+				prioritySlot = slot;
+				merged = state;
+				return;
+			}
+			continue;
+		}
+
+		merged.dpad |= state.dpad;
+		merged.buttons |= state.buttons;
+		if (state.lt > merged.lt)
+			merged.lt = state.lt;
+		if (state.rt > merged.rt)
+			merged.rt = state.rt;
+		if (!leftTaken && (stickMoved(state.lx) || stickMoved(state.ly))) {
+			merged.lx = state.lx;
+			merged.ly = state.ly;
+			leftTaken = true;
+		}
+		if (!rightTaken && (stickMoved(state.rx) || stickMoved(state.ry))) {
+			merged.rx = state.rx;
+			merged.ry = state.ry;
+			rightTaken = true;
+		}
+	}
+}
@@ -466,6 +466,9 @@ app.get('/api/getAddonsOptions', (req, res) => {
 		I2CAnalog1219InputEnabled: 1,
 		JSliderInputEnabled: 1,
 		KeyboardHostAddonEnabled: 1,
+		GamepadUSBHostAddonEnabled: 1,
+		gamepadUSBHostMergeMode: 0,
+		gamepadUSBHostPlayerSlot: 0,
 		PlayerNumAddonEnabled: 1,
 		ReverseInputEnabled: 1,
 		SliderSOCDInputEnabled: 1,
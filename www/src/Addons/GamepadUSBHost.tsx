@@ -0,0 +1,120 @@
+import React, { useContext } from 'react';
+import { Trans, useTranslation } from 'react-i18next';
+import { FormCheck, Row, FormLabel } from 'react-bootstrap';
+import { NavLink } from 'react-router-dom';
+import * as yup from 'yup';
+
+import Section from '../Components/Section';
+import FormSelect from '../Components/FormSelect';
+import FormControl from '../Components/FormControl';
+import { AppContext } from '../Contexts/AppContext';
+
+const MERGE_MODES = [
+	{ label: 'gamepad-usb-host-merge-mode-or', value: 0 },
+	{ label: 'gamepad-usb-host-merge-mode-priority', value: 1 },
+	{ label: 'gamepad-usb-host-merge-mode-player', value: 2 },
+];
+
+const MAX_HOST_DEVICES = 4;
+
+export const gamepadUSBHostScheme = {
+	GamepadUSBHostAddonEnabled: yup
+		.number()
+		.required()
+		.label('Gamepad USB Host Add-On Enabled'),
+	gamepadUSBHostMergeMode: yup
+		.number()
+		.required()
+		.oneOf(MERGE_MODES.map((o) => o.value))
+		.label('Gamepad USB Host Merge Mode'),
+	gamepadUSBHostPlayerSlot: yup
+		.number()
+		.required()
+		.min(0)
+		.max(MAX_HOST_DEVICES - 1)
+		.label('Gamepad USB Host Player Slot'),
+};
+
+export const gamepadUSBHostState = {
+	GamepadUSBHostAddonEnabled: 0,
+	gamepadUSBHostMergeMode: 0,
+	gamepadUSBHostPlayerSlot: 0,
+};
+
+const GamepadUSBHost = ({ values, errors, handleChange, handleCheckbox }) => {
+	const { getAvailablePeripherals } = useContext(AppContext);
+	const { t } = useTranslation();
+
+	return (
+		<Section title={t('AddonsConfig:gamepad-usb-host-header-text')}>
+			<div
+				id="GamepadUSBHostAddonOptions"
+				hidden={
+					!(values.GamepadUSBHostAddonEnabled && getAvailablePeripherals('usb'))
+				}
+			>
+				<Row className="mb-3">
+					<p>{t('AddonsConfig:gamepad-usb-host-sub-header-text')}</p>
+					<FormSelect
+						label={t('AddonsConfig:gamepad-usb-host-merge-mode-label')}
+						name="gamepadUSBHostMergeMode"
+						className="form-select-sm"
+						groupClassName="col-sm-3 mb-3"
+						value={values.gamepadUSBHostMergeMode}
+						error={errors.gamepadUSBHostMergeMode}
+						isInvalid={errors.gamepadUSBHostMergeMode}
+						onChange={handleChange}
+					>
+						{MERGE_MODES.map((o, i) => (
+							<option key={`gamepadUSBHostMergeMode-option-${i}`} value={o.value}>
+								{t(`AddonsConfig:${o.label}`)}
+							</option>
+						))}
+					</FormSelect>
+					<FormControl
+						type="number"
+						label={t('AddonsConfig:gamepad-usb-host-player-slot-label')}
+						name="gamepadUSBHostPlayerSlot"
+						className="form-control-sm"
+						groupClassName="col-sm-3 mb-3"
+						value={values.gamepadUSBHostPlayerSlot}
+						error={errors.gamepadUSBHostPlayerSlot}
+						isInvalid={errors.gamepadUSBHostPlayerSlot}
+						onChange={handleChange}
+						hidden={Number(values.gamepadUSBHostMergeMode) !== 2}
+						min={0}
+						max={MAX_HOST_DEVICES - 1}
+					/>
+				</Row>
+			</div>
+			{getAvailablePeripherals('usb') ? (
+				<FormCheck
+					label={t('Common:switch-enabled')}
+					type="switch"
+					id="GamepadUSBHostAddonButton"
+					reverse
+					isInvalid={false}
+					checked={Boolean(values.GamepadUSBHostAddonEnabled)}
+					onChange={(e) => {
+						handleCheckbox('GamepadUSBHostAddonEnabled', values);
+						handleChange(e);
+					}}
+				/>
+			) : (
+				<FormLabel>
+					<Trans
+						ns="PeripheralMapping"
+						i18nKey="peripheral-toggle-unavailable"
+						values={{ name: 'USB' }}
+					>
+						<NavLink exact="true" to="/peripheral-mapping">
+							{t('PeripheralMapping:header-text')}
+						</NavLink>
+					</Trans>
+				</FormLabel>
+			)}
+		</Section>
+	);
+};
+
+export default GamepadUSBHost;
@@ -139,6 +139,14 @@ export default {
 	'keyboard-host-d-plus-label': 'D+',
 	'keyboard-host-d-minus-label': 'D-',
 	'keyboard-host-five-v-label': '5V Power (optional)',
+	'gamepad-usb-host-header-text': 'Gamepad Host Configuration',
+	'gamepad-usb-host-sub-header-text':
+		'HID controllers plugged into the USB host port (DInput pads, DualShock 4, Switch wired pads, arcade encoders) are read as additional inputs. Buttons follow the DirectInput order. Up to 4 controllers can share the port through a hub.',
+	'gamepad-usb-host-merge-mode-label': 'Multiple Controllers',
+	'gamepad-usb-host-merge-mode-or': 'Combine all',
+	'gamepad-usb-host-merge-mode-priority': 'Active controller, until it is released',
+	'gamepad-usb-host-merge-mode-player': 'One controller per board',
+	'gamepad-usb-host-player-slot-label': 'Controller Slot (0-3, in connection order)',
 	'pin-config-moved-to-core-text':
 		'Note: the pins for this add-on are now configured on the Pin Mapping page.',
 	'input-history-header-text': 'Input History',
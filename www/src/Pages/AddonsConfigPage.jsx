@@ -45,6 +45,10 @@ import FocusMode, {
 	focusModeState,
 } from '../Addons/FocusMode';
 import Keyboard, { keyboardScheme, keyboardState } from '../Addons/Keyboard';
+import GamepadUSBHost, {
+	gamepadUSBHostScheme,
+	gamepadUSBHostState,
+} from '../Addons/GamepadUSBHost';
 import InputHistory, {
 	inputHistoryScheme,
 	inputHistoryState,
@@ -69,6 +73,7 @@ const schema = yup.object().shape({
 	...wiiScheme,
 	...focusModeScheme,
 	...keyboardScheme,
+	...gamepadUSBHostScheme,
 	...inputHistoryScheme,
 	...rotaryScheme,
 	...pcf8575Scheme,
@@ -92,6 +97,7 @@ const defaultValues = {
 	...snesState,
 	...focusModeState,
 	...keyboardState,
+	...gamepadUSBHostState,
 	...inputHistoryState,
 	...rotaryState,
 	...pcf8575State,
@@ -115,6 +121,7 @@ const ADDONS = [
 	SNES,
 	FocusMode,
 	Keyboard,
+	GamepadUSBHost,
 	InputHistory,
 	Rotary,
 	PCF8575,